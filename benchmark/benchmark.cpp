@@ -0,0 +1,460 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// benchmark.cpp
+// Headless benchmark for the DonationTracker backend. For each requested scale it builds a
+// synthetic database in a temporary directory, times the main backend operations and
+// writes one JSON report with throughput and latency percentiles per operation.
+
+#include "donation_tracker.h" // Backend under test.
+#include "letter_generator.h" // Parallel letter generation, timed alongside the synchronous path.
+#include "donation_columns.h" // In-memory aggregation kernels.
+#include "reporting_snapshot.h" // Grouped reports over the columnar snapshot.
+#include "connection_pool.h" // Parallel reads on pooled connections.
+#include <QApplication>  // QTableWidget (used by searchDonors/getDonationsForDonor) needs a widget application.
+#include <QCommandLineParser> // For parsing command-line options.
+#include <QDate>         // Letters are generated for the last complete year.
+#include <QDateTime>     // Report timestamp.
+#include <QDir>          // Working directory for letter output.
+#include <QEventLoop>    // Waits for a LetterGenerator run.
+#include <QElapsedTimer> // Per-call timing.
+#include <QFile>         // Report output.
+#include <QJsonArray>    // Report structure.
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTableWidget>  // Target table for the table-filling APIs.
+#include <QTemporaryDir> // Each scale runs against a fresh database.
+#include <QThread>       // Concurrent readers for the pooled aggregate.
+#include <sqlite3.h>     // sqlite3_libversion for the report.
+#include <algorithm>     // std::sort, std::min.
+#include <cmath>         // std::log.
+#include <cstdio>        // Progress output on stderr.
+#include <random>        // Synthetic data.
+#include <utility>       // std::pair for the sink table.
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Synthetic data
+// -----------------------------------------------------------------------------
+
+static const char* const firstNames[] = {
+    "James", "Mary", "Robert", "Patricia", "John", "Jennifer", "Michael", "Linda", "David", "Elizabeth",
+    "William", "Barbara", "Richard", "Susan", "Joseph", "Jessica", "Thomas", "Sarah", "Carlos", "Karen",
+    "Daniel", "Lisa", "Matthew", "Nancy", "Anthony", "Betty", "Mark", "Sandra", "Ahmed", "Ashley",
+    "Wei", "Emily", "Kevin", "Donna", "Brian", "Michelle", "George", "Carol", "Luis", "Amanda"};
+static const char* const lastNames[] = {
+    "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis", "Rodriguez", "Martinez",
+    "Hernandez", "Lopez", "Gonzalez", "Wilson", "Anderson", "Thomas", "Taylor", "Moore", "Jackson", "Martin",
+    "Lee", "Perez", "Thompson", "White", "Harris", "Sanchez", "Clark", "Ramirez", "Lewis", "Robinson",
+    "Walker", "Young", "Allen", "King", "Wright", "Scott", "Torres", "Nguyen", "Hill", "O'Brien"};
+static const char* const streets[] = {"Main St", "Oak Ave", "Maple Dr", "Cedar Ln", "Elm St", "Park Blvd", "Pine Rd", "Lakeview Ct"};
+static const struct { const char* city; const char* state; const char* zip; } places[] = {
+    {"Springfield", "IL", "62701"}, {"Portland", "OR", "97201"}, {"Austin", "TX", "73301"}, {"Madison", "WI", "53703"},
+    {"Albany", "NY", "12207"}, {"Boulder", "CO", "80302"}, {"Raleigh", "NC", "27601"}, {"Tucson", "AZ", "85701"}};
+static const char* const paymentMethods[] = {"Check", "Credit Card", "Cash", "Bank Transfer"};
+// Weighted months: November 1.5x and December 3x the other months (year-end giving).
+static const double monthWeights[] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1.5, 3};
+
+template <typename T, std::size_t N>
+static const T& pick(const T (&values)[N], std::mt19937& rng) {
+    return values[std::uniform_int_distribution<std::size_t>(0, N - 1)(rng)];
+}
+
+/**
+ * @brief Generates donors and donations with a plausible shape: gifts spread over several
+ * years with a year-end peak, log-normal amounts, and a few donors giving far more often
+ * than most.
+ */
+class SyntheticData {
+public:
+    SyntheticData(unsigned seed, int lastYear, int years)
+        : rng(seed), lastYear(lastYear), years(years), months(std::begin(monthWeights), std::end(monthWeights)) {}
+
+    DonorRecord donor(int index) {
+        DonorRecord d;
+        d.firstName = pick(firstNames, rng);
+        d.lastName = pick(lastNames, rng);
+        d.street = std::to_string(1 + index % 9999) + " " + pick(streets, rng);
+        const auto& place = pick(places, rng);
+        d.city = place.city;
+        d.state = place.state;
+        d.zip = place.zip;
+        d.country = "USA";
+        d.phone = "555-" + std::to_string(100 + index % 900) + "-" + std::to_string(1000 + index % 9000);
+        d.email = d.firstName + "." + std::to_string(index) + "@example.org";
+        return d;
+    }
+
+    DonationRecord donation(int donorCount) {
+        DonationRecord r;
+        // Skewed towards low IDs: u^2 puts a quarter of the gifts on the first 6% of donors.
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        r.donorId = 1 + std::min(donorCount - 1, static_cast<int>(donorCount * u * u));
+        double amount = std::lognormal_distribution<double>(std::log(50.0), 1.0)(rng);
+        r.amountCents = centsFromAmount(std::min(std::max(amount, 1.0), 50000.0));
+        int year = lastYear - std::uniform_int_distribution<int>(0, years - 1)(rng);
+        int month = 1 + months(rng);
+        int day = std::uniform_int_distribution<int>(1, 28)(rng);
+        char date[11];
+        std::snprintf(date, sizeof(date), "%04d-%02d-%02d", year, month, day);
+        r.date = date;
+        r.paymentMethod = pick(paymentMethods, rng);
+        return r;
+    }
+
+    std::mt19937 rng; // Also used for picking query terms and lookup IDs.
+
+private:
+    int lastYear; // Most recent donation year.
+    int years; // Number of years donations are spread over.
+    std::discrete_distribution<int> months; // Index 0-11, weighted by monthWeights.
+};
+
+// -----------------------------------------------------------------------------
+// Timing helpers
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Times count calls of f(i), returning each call's latency in nanoseconds.
+ */
+template <typename F>
+static std::vector<qint64> timeCalls(int count, F f) {
+    std::vector<qint64> samples;
+    samples.reserve(count);
+    QElapsedTimer timer;
+    for (int i = 0; i < count; ++i) {
+        timer.start();
+        f(i);
+        samples.push_back(timer.nsecsElapsed());
+    }
+    return samples;
+}
+
+/**
+ * @brief Summarizes latency samples: count, total, throughput and percentiles (microseconds).
+ * Percentiles use the nearest-rank method on the sorted samples.
+ * @param samples Per-call latencies in nanoseconds.
+ * @param itemsPerCall Work items per call (e.g. rows imported) for the items_per_sec figure.
+ */
+static QJsonObject summarize(std::vector<qint64> samples, double itemsPerCall = 1.0) {
+    QJsonObject stats;
+    stats["count"] = static_cast<int>(samples.size());
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    qint64 total = 0;
+    for (qint64 sample : samples) {
+        total += sample;
+    }
+    auto percentile = [&samples](double p) {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100.0 * samples.size()));
+        return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)] / 1000.0;
+    };
+    double totalSeconds = total / 1e9;
+    stats["total_ms"] = total / 1e6;
+    stats["ops_per_sec"] = totalSeconds > 0 ? samples.size() / totalSeconds : 0.0;
+    if (itemsPerCall != 1.0) {
+        stats["items_per_sec"] = totalSeconds > 0 ? samples.size() * itemsPerCall / totalSeconds : 0.0;
+    }
+    stats["mean_us"] = total / 1000.0 / samples.size();
+    stats["p50_us"] = percentile(50);
+    stats["p90_us"] = percentile(90);
+    stats["p95_us"] = percentile(95);
+    stats["p99_us"] = percentile(99);
+    stats["max_us"] = samples.back() / 1000.0;
+    return stats;
+}
+
+/**
+ * @brief Benchmark settings taken from the command line.
+ */
+struct BenchmarkOptions {
+    std::vector<int> scales; // Donor counts to run at.
+    double donationsPerDonor = 5.0;
+    int years = 5; // Years the donations are spread over.
+    unsigned seed = 42;
+    int queries = 200; // searchDonors calls per scale.
+    int lookups = 1000; // getDonationsForDonor calls per scale.
+    int singleDonations = 2000; // addDonation calls per scale (the bulk of the data is imported).
+    bool letters = true; // Include the letter generation runs.
+};
+
+static void progress(const char* message, int donors) {
+    std::fprintf(stderr, "[%d donors] %s\n", donors, message);
+}
+
+/**
+ * @brief Runs every operation at one scale against a fresh database.
+ * @return The report entry for this scale.
+ */
+static QJsonObject runScale(int donors, const BenchmarkOptions& options) {
+    QTemporaryDir dir; // Removed (with the database and letters) when the scale is done.
+    QString previousDir = QDir::currentPath();
+    QDir::setCurrent(dir.path()); // generateDonationLetters writes to ./letters.
+
+    const int lastYear = QDate::currentDate().year() - 1; // Letters are run for the last complete year.
+    SyntheticData data(options.seed + static_cast<unsigned>(donors), lastYear, options.years);
+    QJsonObject operations;
+    ImportResult imported;
+    std::size_t cacheHits = 0;
+    std::size_t cacheMisses = 0;
+    {
+        DonationTracker tracker(ConnectionProfile::Interactive, dir.filePath("benchmark.db").toStdString());
+        QTableWidget table;
+
+        progress("addDonor", donors);
+        std::vector<DonorRecord> donorData;
+        donorData.reserve(donors);
+        for (int i = 0; i < donors; ++i) {
+            donorData.push_back(data.donor(i));
+        }
+        operations["addDonor"] = summarize(timeCalls(donors, [&](int i) {
+            const DonorRecord& d = donorData[i];
+            tracker.addDonor(d.firstName, d.lastName, d.street, d.city, d.state, d.zip, d.country, d.phone, d.email);
+        }));
+
+        progress("importDonations", donors);
+        int donationCount = static_cast<int>(donors * options.donationsPerDonor);
+        std::vector<DonationRecord> donations;
+        donations.reserve(donationCount);
+        for (int i = 0; i < donationCount; ++i) {
+            donations.push_back(data.donation(donors));
+        }
+        operations["importDonations"] = summarize(timeCalls(1, [&](int) { imported = tracker.importDonations(donations); }),
+                                                  static_cast<double>(donationCount));
+
+        progress("addDonation", donors);
+        operations["addDonation"] = summarize(timeCalls(options.singleDonations, [&](int) {
+            DonationRecord r = data.donation(donors);
+            tracker.addDonation(r.donorId, r.amountCents, r.date, r.paymentMethod);
+        }));
+
+        progress("searchDonors", donors);
+        std::vector<std::string> terms;
+        for (int i = 0; i < options.queries; ++i) {
+            std::string name = (i % 2) ? pick(lastNames, data.rng) : pick(firstNames, data.rng);
+            // Mix of 3-letter prefixes (search-as-you-type) and whole names.
+            terms.push_back(i % 3 == 0 ? name : name.substr(0, 3));
+        }
+        operations["searchDonors"] = summarize(timeCalls(options.queries, [&](int i) {
+            tracker.searchDonors(terms[i], &table, false);
+        }));
+        table.setRowCount(0); // Release the last result set before the next phase.
+
+        progress("getDonationsForDonor", donors);
+        std::uniform_int_distribution<int> donorIds(1, donors);
+        operations["getDonationsForDonor"] = summarize(timeCalls(options.lookups, [&](int) {
+            tracker.getDonationsForDonor(donorIds(data.rng), &table);
+        }));
+
+        progress("getDonorRecord", donors);
+        DonorRecord donor;
+        // Staff flip between a handful of donors: after the first pass every load is a cache hit.
+        operations["getDonorRecordRepeat"] = summarize(timeCalls(options.lookups, [&](int i) {
+            tracker.getDonorRecord(1 + i % std::min(donors, 16), donor);
+        }));
+        tracker.setDonorCacheCapacity(0);
+        operations["getDonorRecordUncached"] = summarize(timeCalls(options.lookups, [&](int i) {
+            tracker.getDonorRecord(1 + i % std::min(donors, 16), donor);
+        }));
+        tracker.setDonorCacheCapacity(256);
+
+        progress("getAllDonorIds", donors);
+        operations["getAllDonorIds"] = summarize(timeCalls(10, [&](int) { tracker.getAllDonorIds(); }));
+
+        progress("nextDonorId", donors);
+        int navigationId = tracker.firstDonorId();
+        operations["nextDonorId"] = summarize(timeCalls(options.lookups, [&](int) {
+            navigationId = tracker.nextDonorId(navigationId);
+            if (navigationId == -1) {
+                navigationId = tracker.firstDonorId(); // Wrap around at the end.
+            }
+        }));
+
+        progress("aggregates", donors);
+        operations["getYearSummaries"] = summarize(timeCalls(10, [&](int) { tracker.getYearSummaries(); }));
+        // The same aggregate ten times per pooled connection, all connections at once.
+        ConnectionPool readers(tracker.getDatabasePath());
+        operations["getYearSummariesPooled"] = summarize(timeCalls(1, [&](int) {
+            std::vector<QThread*> threads;
+            for (int t = 0; t < readers.maxConnections(); ++t) {
+                threads.push_back(QThread::create([&readers]() {
+                    ConnectionPool::Lease lease = readers.acquire();
+                    for (int i = 0; i < 10; ++i) {
+                        lease->getYearSummaries();
+                    }
+                }));
+                threads.back()->start();
+            }
+            for (QThread* thread : threads) {
+                thread->wait();
+                delete thread;
+            }
+        }), 10.0 * readers.maxConnections());
+        DonationColumns columns;
+        operations["loadDonationColumns"] = summarize(timeCalls(3, [&](int) { tracker.loadDonationColumns(columns); }));
+        volatile Cents sink = 0; // Keeps the kernel results observable so they are not optimized away.
+        operations["columnSumForYear"] = summarize(timeCalls(100, [&](int) { sink = columns.sumCents(lastYear); }),
+                                                   static_cast<double>(columns.size()));
+        operations["columnMonthHistogram"] = summarize(timeCalls(100, [&](int) {
+            sink = columns.monthHistogram(lastYear).totals[11];
+        }), static_cast<double>(columns.size()));
+        operations["columnAmountHistogram"] = summarize(timeCalls(100, [&](int) {
+            sink = static_cast<Cents>(columns.amountHistogram({1000, 2500, 5000, 10000, 25000, 50000, 100000, 500000})[0]);
+        }), static_cast<double>(columns.size()));
+        columns.clear();
+
+        ReportingSnapshot snapshot;
+        operations["reportingSnapshotBuild"] = summarize(timeCalls(3, [&](int) {
+            snapshot.invalidate();
+            snapshot.refresh(tracker);
+        }));
+        ReportFilter lastYearOnly;
+        lastYearOnly.yearFrom = lastYearOnly.yearTo = lastYear;
+        operations["reportGroupByState"] = summarize(timeCalls(100, [&](int) {
+            sink = static_cast<Cents>(snapshot.groupBy(ReportDimension::State, lastYearOnly).size());
+        }), static_cast<double>(snapshot.size()));
+
+        if (options.letters) {
+            progress("generateDonationLetters", donors);
+            operations["generateDonationLetters"] = summarize(timeCalls(1, [&](int) {
+                tracker.generateDonationLetters(lastYear);
+            }));
+            QDir("letters").removeRecursively();
+            // The same run into one file per kind: no per-donor create/close.
+            const std::pair<const char*, LetterSinkKind> singleFileSinks[] = {
+                {"generateDonationLettersFile", LetterSinkKind::ConcatenatedFile},
+                {"generateDonationLettersTar", LetterSinkKind::Tar},
+                {"generateDonationLettersPdf", LetterSinkKind::Pdf}};
+            for (const auto& sinkKind : singleFileSinks) {
+                progress(sinkKind.first, donors);
+                operations[sinkKind.first] = summarize(timeCalls(1, [&](int) {
+                    tracker.generateDonationLetters(lastYear, nullptr, sinkKind.second);
+                }));
+                QDir("letters").removeRecursively();
+            }
+
+            progress("LetterGenerator", donors);
+            LetterGenerator generator(tracker.getDatabasePath());
+            int lettersWritten = 0;
+            operations["letterGeneratorParallel"] = summarize(timeCalls(1, [&](int) {
+                QEventLoop loop;
+                QObject::connect(&generator, &LetterGenerator::finished, &loop,
+                                 [&](int written, int, bool, const QStringList&) {
+                    lettersWritten = written;
+                    loop.quit();
+                });
+                if (generator.start(lastYear)) {
+                    loop.exec();
+                }
+            }));
+            QJsonObject letters = operations["letterGeneratorParallel"].toObject();
+            letters["letters"] = lettersWritten;
+            operations["letterGeneratorParallel"] = letters;
+            QDir("letters").removeRecursively();
+        }
+
+        cacheHits = tracker.getStatementCacheHits();
+        cacheMisses = tracker.getStatementCacheMisses();
+    }
+    QDir::setCurrent(previousDir);
+
+    QJsonObject result;
+    result["donors"] = donors;
+    result["donations"] = static_cast<int>(imported.rowsImported) + options.singleDonations;
+    result["operations"] = operations;
+    result["statement_cache"] = QJsonObject{{"hits", static_cast<qint64>(cacheHits)}, {"misses", static_cast<qint64>(cacheMisses)}};
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+// Main function
+// -----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    // Headless: the table-filling APIs need QApplication, but nothing is ever shown.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("donation_tracker_benchmark");
+    QCoreApplication::setApplicationVersion(APP_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks the DonationTracker backend against synthetic data and prints a JSON report.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption scalesOption("scales", "Comma-separated donor counts to run at.", "list", "1000,10000,100000");
+    QCommandLineOption donationsOption("donations-per-donor", "Average donations per donor.", "n", "5");
+    QCommandLineOption yearsOption("years", "Years the donations are spread over.", "n", "5");
+    QCommandLineOption seedOption("seed", "Random seed for the synthetic data.", "n", "42");
+    QCommandLineOption queriesOption("queries", "searchDonors calls per scale.", "n", "200");
+    QCommandLineOption lookupsOption("lookups", "getDonationsForDonor calls per scale.", "n", "1000");
+    QCommandLineOption noLettersOption("no-letters", "Skip the letter generation runs.");
+    QCommandLineOption outputOption({"o", "output"}, "Write the report to file instead of stdout.", "file");
+    parser.addOptions({scalesOption, donationsOption, yearsOption, seedOption, queriesOption, lookupsOption, noLettersOption, outputOption});
+    parser.process(app);
+
+    BenchmarkOptions options;
+    for (const QString& scale : parser.value(scalesOption).split(',', Qt::SkipEmptyParts)) {
+        int donors = scale.trimmed().toInt();
+        if (donors > 0) {
+            options.scales.push_back(donors);
+        }
+    }
+    options.donationsPerDonor = std::max(0.0, parser.value(donationsOption).toDouble());
+    options.years = std::max(1, parser.value(yearsOption).toInt());
+    options.seed = parser.value(seedOption).toUInt();
+    options.queries = std::max(1, parser.value(queriesOption).toInt());
+    options.lookups = std::max(1, parser.value(lookupsOption).toInt());
+    options.letters = !parser.isSet(noLettersOption);
+    if (options.scales.empty()) {
+        std::fprintf(stderr, "No valid --scales given.\n");
+        return 1;
+    }
+
+    QJsonArray results;
+    for (int donors : options.scales) {
+        results.append(runScale(donors, options));
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "donation_tracker_backend";
+    report["version"] = APP_VERSION;
+    report["sqlite_version"] = sqlite3_libversion();
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["seed"] = static_cast<qint64>(options.seed);
+    report["donations_per_donor"] = options.donationsPerDonor;
+    report["years"] = options.years;
+    report["results"] = results;
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "Cannot write %s\n", qPrintable(parser.value(outputOption)));
+            return 1;
+        }
+        file.write(json);
+    } else {
+        std::fwrite(json.constData(), 1, static_cast<std::size_t>(json.size()), stdout);
+    }
+    return 0;
+}
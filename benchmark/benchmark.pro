@@ -0,0 +1,28 @@
+# Donation Tracker - A Qt-based application for managing donations
+# Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+# benchmark.pro
+# Headless benchmark for the DonationTracker backend: builds a synthetic database at
+# several scales and reports per-operation throughput and latency percentiles as JSON.
+#   qmake benchmark/benchmark.pro && make && ./donation_tracker_benchmark --scales 1000,10000
+
+TARGET = donation_tracker_benchmark
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+include(../backend.pri)
+SOURCES += benchmark.cpp
@@ -0,0 +1,145 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+// buffered_output.cpp
+// Implementation of BufferedOutput, the block-buffered (optionally gzip) output file.
+
+#include "buffered_output.h"
+#include <QDir> // Parent directories.
+#include <QFileInfo> // Parent directory of an output file.
+#include <cstdio> // stdout.
+#include <zlib.h> // gzip compression.
+
+/**
+ * @brief A zlib deflate stream writing the gzip container (window bits 15 + 16).
+ */
+struct BufferedOutput::Compressor {
+    z_stream stream;
+    std::string out; // Compressed bytes of one deflate call.
+    bool initialized = false;
+
+    Compressor() {
+        stream = z_stream();
+        initialized = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        out.resize(256 * 1024);
+    }
+    ~Compressor() {
+        if (initialized) {
+            deflateEnd(&stream);
+        }
+    }
+};
+
+/**
+ * @brief Stores an error message (if wanted) and returns false.
+ */
+static bool fail(std::string* error, const std::string& message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+BufferedOutput::BufferedOutput() : flushed(0), written(0), ok(true) {
+}
+
+BufferedOutput::~BufferedOutput() = default;
+
+bool BufferedOutput::open(const QString& path, bool gzip, std::string* error) {
+    QString dir = QFileInfo(path).absolutePath();
+    if (!QDir().mkpath(dir)) {
+        return fail(error, "Could not create directory: " + dir.toStdString());
+    }
+    file.setFileName(path);
+    return start(file.open(QIODevice::WriteOnly | QIODevice::Truncate), path.toStdString(), gzip, error);
+}
+
+bool BufferedOutput::openStdout(bool gzip, std::string* error) {
+    return start(file.open(stdout, QIODevice::WriteOnly), "standard output", gzip, error);
+}
+
+/**
+ * @brief Shared tail of open() and openStdout(): sets up the compressor and the buffer.
+ */
+bool BufferedOutput::start(bool opened, const std::string& name, bool gzip, std::string* error) {
+    if (!opened) {
+        return fail(error, "Could not open file for writing: " + name);
+    }
+    if (gzip) {
+        compressor.reset(new Compressor());
+        if (!compressor->initialized) {
+            file.close();
+            return fail(error, "Could not initialize gzip compression");
+        }
+    }
+    buffer.reserve(blockSize + 64 * 1024);
+    return true;
+}
+
+bool BufferedOutput::close(std::string* error) {
+    if (file.isOpen()) {
+        flush(true);
+        file.close();
+    }
+    if (!ok) {
+        std::string name = file.fileName().toStdString();
+        return fail(error, "Could not write " + (name.empty() ? std::string("standard output") : "file: " + name));
+    }
+    return true;
+}
+
+/**
+ * @brief Hands the buffer to the file, through the compressor when gzip is on.
+ * @param finish Also end the gzip stream (on close).
+ */
+void BufferedOutput::flush(bool finish) {
+    flushed += static_cast<qint64>(buffer.size());
+    if (!compressor) {
+        writeOut(buffer.data(), buffer.size());
+        buffer.clear();
+        return;
+    }
+    z_stream& stream = compressor->stream;
+    stream.next_in = reinterpret_cast<Bytef*>(&buffer[0]);
+    stream.avail_in = static_cast<uInt>(buffer.size());
+    int status = Z_OK;
+    do {
+        stream.next_out = reinterpret_cast<Bytef*>(&compressor->out[0]);
+        stream.avail_out = static_cast<uInt>(compressor->out.size());
+        status = deflate(&stream, finish ? Z_FINISH : Z_NO_FLUSH);
+        writeOut(compressor->out.data(), compressor->out.size() - stream.avail_out);
+    } while (stream.avail_out == 0 || (finish && status == Z_OK));
+    if (status == Z_STREAM_ERROR) {
+        ok = false;
+    }
+    buffer.clear();
+}
+
+/**
+ * @brief Writes one block. A failed write is remembered and reported by close(); later
+ * appends still count offsets.
+ */
+void BufferedOutput::writeOut(const char* data, std::size_t size) {
+    if (size == 0 || !ok) {
+        return;
+    }
+    ok = file.write(data, static_cast<qint64>(size)) == static_cast<qint64>(size);
+    written += size;
+}
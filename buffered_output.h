@@ -0,0 +1,104 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// buffered_output.h
+#ifndef BUFFERED_OUTPUT_H
+#define BUFFERED_OUTPUT_H
+
+#include <QFile> // Output file (or stdout).
+#include <QString> // Output paths.
+#include <cstddef> // std::size_t.
+#include <cstdint> // Byte counters.
+#include <cstring> // strlen.
+#include <memory> // Compressor state.
+#include <string> // Pending bytes.
+
+/**
+ * @brief The BufferedOutput class is an output file written through a large in-memory
+ * buffer, optionally gzip-compressed. Appends are collected and handed to the file (or the
+ * compressor) in blocks of at least blockSize bytes, so many small writes become a few
+ * large sequential ones. Used by the letter sinks and by ExportWriter.
+ */
+class BufferedOutput {
+public:
+    static const std::size_t blockSize = 1 << 20; // 1 MiB per write.
+
+    BufferedOutput();
+    ~BufferedOutput();
+    BufferedOutput(const BufferedOutput&) = delete;
+    BufferedOutput& operator=(const BufferedOutput&) = delete;
+
+    /**
+     * @brief Creates the parent directory and opens (truncates) the file.
+     * @param gzip Compress everything appended as one .gz stream.
+     */
+    bool open(const QString& path, bool gzip = false, std::string* error = nullptr);
+
+    /**
+     * @brief Writes to standard output instead of a file.
+     */
+    bool openStdout(bool gzip = false, std::string* error = nullptr);
+
+    void append(const char* data, std::size_t size) {
+        buffer.append(data, size);
+        flushIfFull();
+    }
+    void append(const char* text) { append(text, std::strlen(text)); }
+    void append(const std::string& text) { append(text.data(), text.size()); }
+    void append(char c) {
+        buffer += c;
+        flushIfFull();
+    }
+    void appendZeros(std::size_t count) {
+        buffer.append(count, '\0');
+        flushIfFull();
+    }
+
+    // Bytes appended so far, flushed or not (before compression).
+    qint64 offset() const { return flushed + static_cast<qint64>(buffer.size()); }
+    // Bytes handed to the file so far (after compression).
+    std::uint64_t bytesWritten() const { return written; }
+
+    /**
+     * @brief Flushes the buffer (and finishes the gzip stream) and closes the file.
+     * @return false if any write failed.
+     */
+    bool close(std::string* error = nullptr);
+
+private:
+    struct Compressor; // zlib stream state (buffered_output.cpp).
+
+    bool start(bool opened, const std::string& name, bool gzip, std::string* error);
+    void flushIfFull() {
+        if (buffer.size() >= blockSize) {
+            flush(false);
+        }
+    }
+    void flush(bool finish); // Writes (or compresses) the buffer.
+    void writeOut(const char* data, std::size_t size);
+
+    QFile file;
+    std::unique_ptr<Compressor> compressor; // Set when gzip is on.
+    std::string buffer; // Pending bytes, written once blockSize is reached.
+    qint64 flushed; // Bytes taken from the buffer so far.
+    std::uint64_t written; // Bytes written to the file.
+    bool ok; // False once a write has failed.
+};
+
+#endif // BUFFERED_OUTPUT_H
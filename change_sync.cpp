@@ -0,0 +1,210 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// change_sync.cpp
+// Implementation of the changeset files and of the central node's apply loop.
+
+#include "change_sync.h"
+#include "donation_tracker.h" // Central chapter copies.
+#include <QDir> // Outboxes and central copies.
+#include <QElapsedTimer> // Sync timing.
+#include <QFile> // Renaming and removing changesets.
+#include <QFileInfo> // Changeset sizes and names.
+#include <zlib.h> // gzip streams.
+
+/**
+ * @brief Constructor for ChangesetWriter.
+ */
+ChangesetWriter::ChangesetWriter() : file(nullptr), bytes(0), ok(false) {}
+
+ChangesetWriter::~ChangesetWriter() {
+    if (file) {
+        gzclose(file);
+        QFile::remove(QString::fromStdString(path + ".part"));
+    }
+}
+
+/**
+ * @brief Creates "<path>.part"; without gzip the file is written as plain text ("T" mode).
+ */
+bool ChangesetWriter::open(const std::string& path, bool gzip, std::string* error) {
+    this->path = path;
+    bytes = 0;
+    file = gzopen((path + ".part").c_str(), gzip ? "wb6" : "wbT");
+    ok = file != nullptr;
+    if (!ok && error) {
+        *error = "Cannot create " + path + ".part";
+    }
+    return ok;
+}
+
+bool ChangesetWriter::writeLine(const char* data, std::size_t size) {
+    if (ok && size > 0) {
+        ok = gzwrite(file, data, static_cast<unsigned>(size)) == static_cast<int>(size);
+    }
+    if (ok) {
+        ok = gzputc(file, '\n') == '\n';
+    }
+    return ok;
+}
+
+bool ChangesetWriter::commit(std::string* error) {
+    if (!file) {
+        if (error) {
+            *error = "No changeset open";
+        }
+        return false;
+    }
+    ok = gzclose(file) == Z_OK && ok;
+    file = nullptr;
+    QString part = QString::fromStdString(path + ".part");
+    QString target = QString::fromStdString(path);
+    QFile::remove(target); // A changeset of an interrupted earlier push; this one supersedes it.
+    if (ok) {
+        ok = QFile::rename(part, target);
+    }
+    if (!ok) {
+        QFile::remove(part);
+        if (error) {
+            *error = "Failed to write " + path;
+        }
+        return false;
+    }
+    bytes = static_cast<std::uint64_t>(QFileInfo(target).size());
+    return true;
+}
+
+/**
+ * @brief Constructor for ChangesetReader.
+ */
+ChangesetReader::ChangesetReader() : file(nullptr) {}
+
+ChangesetReader::~ChangesetReader() {
+    if (file) {
+        gzclose(file);
+    }
+}
+
+bool ChangesetReader::open(const std::string& path, std::string* error) {
+    file = gzopen(path.c_str(), "rb"); // Reads gzip and plain files alike.
+    if (!file && error) {
+        *error = "Cannot open " + path;
+    }
+    return file != nullptr;
+}
+
+bool ChangesetReader::readLine(std::string& line) {
+    line.clear();
+    char chunk[4096];
+    while (file && gzgets(file, chunk, sizeof(chunk))) {
+        line += chunk;
+        if (line.back() == '\n') { // Lines longer than a chunk arrive in pieces.
+            line.pop_back();
+            return true;
+        }
+    }
+    return !line.empty(); // A last line without a newline.
+}
+
+/**
+ * @brief Closes the file; a truncated or corrupt gzip stream is reported here.
+ */
+bool ChangesetReader::close(std::string* error) {
+    if (!file) {
+        return false;
+    }
+    int status = Z_OK;
+    std::string message = gzerror(file, &status); // Owned by the stream: copy before closing it.
+    gzclose(file);
+    file = nullptr;
+    if (status != Z_OK) {
+        if (error) {
+            *error = "Failed to read changeset " + message; // zlib prefixes the path.
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief e.g. "00000000000000001234-00002.ndjson.gz": fixed-width, so names sort numerically.
+ */
+std::string ChangeSync::changesetName(std::int64_t sequence, int part, bool gzip) {
+    return QString("%1-%2.ndjson%3")
+        .arg(sequence, 20, 10, QChar('0'))
+        .arg(part, 5, 10, QChar('0'))
+        .arg(gzip ? ".gz" : "")
+        .toStdString();
+}
+
+bool ChangeSync::changesetSequence(const std::string& path, std::int64_t& sequence) {
+    bool ok = false;
+    sequence = QFileInfo(QString::fromStdString(path)).fileName().section('-', 0, 0).toLongLong(&ok);
+    return ok;
+}
+
+std::vector<std::string> ChangeSync::listChangesets(const std::string& directory) {
+    std::vector<std::string> paths;
+    QDir dir(QString::fromStdString(directory));
+    for (const QFileInfo& file : dir.entryInfoList({"*.ndjson", "*.ndjson.gz"}, QDir::Files, QDir::Name)) {
+        paths.push_back(file.filePath().toStdString());
+    }
+    return paths;
+}
+
+SyncResult ChangeSync::applyInbox(const std::string& inboxDirectory, const std::string& centralDirectory) {
+    SyncResult total;
+    QElapsedTimer timer;
+    timer.start();
+    QDir inbox(QString::fromStdString(inboxDirectory));
+    QDir central(QString::fromStdString(centralDirectory));
+    if (!inbox.exists()) {
+        total.error = "No such directory: " + inboxDirectory;
+        return total;
+    }
+    if (!central.mkpath(".")) {
+        total.error = "Cannot create " + centralDirectory;
+        return total;
+    }
+
+    for (const QFileInfo& outbox : inbox.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+        std::vector<std::string> changesets = listChangesets(outbox.filePath().toStdString());
+        if (changesets.empty()) {
+            continue;
+        }
+        DonationTracker tracker(ConnectionProfile::Interactive, central.filePath(outbox.fileName() + ".db").toStdString());
+        tracker.setDonorCacheCapacity(0); // Nothing reads through this connection.
+        for (const std::string& path : changesets) {
+            SyncResult applied = tracker.applyChangeset(path);
+            if (!applied.ok) {
+                total.error = outbox.fileName().toStdString() + ": " + applied.error;
+                total.elapsedSeconds = timer.elapsed() / 1000.0;
+                return total;
+            }
+            total.changes += applied.changes;
+            total.changesets += applied.changesets;
+            total.skipped += applied.skipped;
+            total.bytes += applied.bytes;
+            QFile::remove(QString::fromStdString(path));
+        }
+    }
+    total.ok = true;
+    total.elapsedSeconds = timer.elapsed() / 1000.0;
+    return total;
+}
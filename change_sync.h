@@ -0,0 +1,118 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// change_sync.h
+#ifndef CHANGE_SYNC_H
+#define CHANGE_SYNC_H
+
+#include <cstddef> // std::size_t.
+#include <cstdint> // Change sequences and counters.
+#include <string> // Paths, lines and errors.
+#include <vector> // Changeset listings.
+
+struct gzFile_s; // zlib stream (change_sync.cpp).
+
+/**
+ * @brief How DonationTracker::pushChanges writes changesets.
+ */
+struct SyncOptions {
+    int batchSize = 5000; // Row changes per changeset file; each file is applied in one transaction.
+    bool gzip = true; // Compress the changesets.
+};
+
+/**
+ * @brief Outcome of a push or an apply.
+ */
+struct SyncResult {
+    bool ok = false;
+    std::uint64_t changes = 0; // Row changes written or applied.
+    int changesets = 0; // Changeset files written or applied.
+    int skipped = 0; // Changesets older than the central copy, dropped without applying.
+    std::uint64_t bytes = 0; // Size of the changeset files.
+    double elapsedSeconds = 0.0;
+    std::string error; // Why the sync failed (when !ok).
+};
+
+/**
+ * @brief The ChangesetWriter class writes one changeset file: one NDJSON change per line,
+ * optionally gzip-compressed. The file is written under "<path>.part" and renamed into place
+ * by commit(), so a reader never sees a partial changeset.
+ */
+class ChangesetWriter {
+public:
+    ChangesetWriter();
+    ~ChangesetWriter(); // Removes the ".part" file unless commit() succeeded.
+    ChangesetWriter(const ChangesetWriter&) = delete;
+    ChangesetWriter& operator=(const ChangesetWriter&) = delete;
+
+    bool open(const std::string& path, bool gzip, std::string* error = nullptr);
+    bool writeLine(const char* data, std::size_t size); // Appends data and a newline.
+    bool commit(std::string* error = nullptr); // Closes the file and renames it into place.
+    std::uint64_t bytesWritten() const { return bytes; } // File size once committed.
+
+private:
+    gzFile_s* file;
+    std::string path;
+    std::uint64_t bytes;
+    bool ok; // False once a write has failed.
+};
+
+/**
+ * @brief The ChangesetReader class reads a changeset line by line; plain and gzip files
+ * are both accepted.
+ */
+class ChangesetReader {
+public:
+    ChangesetReader();
+    ~ChangesetReader();
+    ChangesetReader(const ChangesetReader&) = delete;
+    ChangesetReader& operator=(const ChangesetReader&) = delete;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    bool readLine(std::string& line); // False at the end of the file or on a read error.
+    bool close(std::string* error = nullptr); // False if the file could not be read to the end.
+
+private:
+    gzFile_s* file;
+};
+
+/**
+ * @brief The ChangeSync class moves changesets from chapters to a central node.
+ * A push writes "<sequence>-<part>.ndjson[.gz]" files into the chapter's outbox directory,
+ * where sequence is the chapter's last change_log entry at the time; names sort in the
+ * order the files must be applied. The central node keeps a copy of each chapter in
+ * "<central>/<chapter>.db", the layout ChapterShards reads, and applies each chapter's
+ * outbox to it. How outboxes reach the central node (shared folder, rsync, upload) is
+ * left to the deployment; a changeset is only removed once it has been applied.
+ */
+class ChangeSync {
+public:
+    static std::string changesetName(std::int64_t sequence, int part, bool gzip);
+    static bool changesetSequence(const std::string& path, std::int64_t& sequence); // From the file name.
+    static std::vector<std::string> listChangesets(const std::string& directory); // Paths, in apply order.
+
+    /**
+     * @brief Applies every chapter outbox under inboxDirectory ("<inbox>/<chapter>/") to the
+     * chapter's central copy, creating it on first sync, and removes the applied changesets.
+     * Stops at the first changeset that fails; it is kept for the next run.
+     */
+    static SyncResult applyInbox(const std::string& inboxDirectory, const std::string& centralDirectory);
+};
+
+#endif // CHANGE_SYNC_H
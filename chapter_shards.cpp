@@ -0,0 +1,143 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// chapter_shards.cpp
+// Implementation of ChapterShards: one database per chapter, with parallel fan-out reports.
+
+#include "chapter_shards.h"
+#include <QDir> // Chapter databases of a directory.
+#include <QThread> // idealThreadCount for the fan-out.
+#include <QThreadPool> // Runs the per-chapter work.
+#include <algorithm> // std::min.
+#include <map> // Years of the combined summary.
+
+/**
+ * @brief Lists the "<name>.db" files of a directory as chapters.
+ */
+bool ChapterShards::fromDirectory(const std::string& directory, ChapterShards& shards, std::string* error) {
+    QDir dir(QString::fromStdString(directory));
+    if (!dir.exists()) {
+        if (error) {
+            *error = "No such directory: " + directory;
+        }
+        return false;
+    }
+    std::vector<Chapter> chapters;
+    for (const QFileInfo& file : dir.entryInfoList({"*.db"}, QDir::Files, QDir::Name)) {
+        Chapter chapter;
+        chapter.name = file.completeBaseName().toStdString();
+        chapter.dbPath = file.filePath().toStdString();
+        chapters.push_back(chapter);
+    }
+    if (chapters.empty()) {
+        if (error) {
+            *error = "No chapter databases (*.db) in " + directory;
+        }
+        return false;
+    }
+    shards = ChapterShards(chapters);
+    return true;
+}
+
+const Chapter* ChapterShards::find(const std::string& name) const {
+    for (const Chapter& chapter : chapterList) {
+        if (chapter.name == name) {
+            return &chapter;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Runs work for every chapter on a pool of at most one thread per chapter (and per core).
+ * Chapters are independent files, so the connections share nothing and scale with the cores.
+ * Each file is opened read-only and never migrated; a chapter that cannot be read (or is at
+ * another schema version) is reported and skipped, leaving its result empty.
+ */
+void ChapterShards::runEach(const std::function<void(std::size_t, DonationTracker&)>& work) const {
+    if (chapterList.empty()) {
+        return;
+    }
+    int threads = maxThreads > 0 ? maxThreads : QThread::idealThreadCount();
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::min(threads, static_cast<int>(chapterList.size())));
+    for (std::size_t i = 0; i < chapterList.size(); ++i) {
+        pool.start([this, &work, i]() {
+            DonationTracker tracker(ConnectionProfile::ReadOnlyReporting, chapterList[i].dbPath, OpenMode::ReadOnly);
+            if (!tracker.isOpen()) {
+                return;
+            }
+            tracker.setDonorCacheCapacity(0); // One-off reports; nothing to reuse.
+            work(i, tracker);
+        });
+    }
+    pool.waitForDone();
+}
+
+/**
+ * @brief Fans getYearSummaries out over the chapters and tags each row with its chapter.
+ */
+std::vector<ChapterYearSummary> ChapterShards::getYearSummaries() const {
+    std::vector<std::vector<YearSummary>> perChapter = fanOut<std::vector<YearSummary>>(
+        [](const Chapter&, DonationTracker& tracker) { return tracker.getYearSummaries(); });
+    std::vector<ChapterYearSummary> summaries;
+    for (std::size_t i = 0; i < perChapter.size(); ++i) {
+        for (const YearSummary& summary : perChapter[i]) {
+            ChapterYearSummary row;
+            row.chapter = chapterList[i].name;
+            row.summary = summary;
+            summaries.push_back(row);
+        }
+    }
+    return summaries;
+}
+
+/**
+ * @brief Sums per-chapter rows by year.
+ */
+std::vector<YearSummary> ChapterShards::combineYearSummaries(const std::vector<ChapterYearSummary>& summaries) {
+    std::map<int, YearSummary> byYear;
+    for (const ChapterYearSummary& row : summaries) {
+        YearSummary& total = byYear[row.summary.year];
+        total.year = row.summary.year;
+        total.donors += row.summary.donors;
+        total.donations += row.summary.donations;
+        total.totalCents += row.summary.totalCents;
+    }
+    std::vector<YearSummary> combined;
+    for (const auto& year : byYear) {
+        combined.push_back(year.second);
+    }
+    return combined;
+}
+
+bool ChapterShards::attach(DonationTracker& tracker, const std::string& chapter, std::string* error) const {
+    const Chapter* found = find(chapter);
+    if (!found) {
+        if (error) {
+            *error = "Unknown chapter: " + chapter;
+        }
+        return false;
+    }
+    return tracker.attachDatabase(found->name, found->dbPath, error);
+}
+
+bool ChapterShards::detach(DonationTracker& tracker, const std::string& chapter) const {
+    return tracker.detachDatabase(chapter);
+}
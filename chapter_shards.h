@@ -0,0 +1,123 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// chapter_shards.h
+#ifndef CHAPTER_SHARDS_H
+#define CHAPTER_SHARDS_H
+
+#include "donation_tracker.h" // Per-chapter connections and the record types they return.
+#include <cstddef> // std::size_t.
+#include <functional> // Per-chapter work.
+#include <string> // Chapter names and paths.
+#include <vector> // Chapters and fan-out results.
+
+/**
+ * @brief One chapter (organization) and the database file that holds it.
+ */
+struct Chapter {
+    std::string name; // Also the schema name when attached (see ChapterShards::attach).
+    std::string dbPath;
+};
+
+/**
+ * @brief A year's totals for one chapter, as returned by ChapterShards::getYearSummaries.
+ */
+struct ChapterYearSummary {
+    std::string chapter;
+    YearSummary summary;
+};
+
+/**
+ * @brief The ChapterShards class treats a set of chapter databases as one installation.
+ * Every chapter keeps its own file (with its own organization row), so chapters grow and
+ * take writes independently and never contend for one file's write lock. Cross-chapter
+ * reports fan out: the per-chapter query runs on every file in parallel, each on its own
+ * read-only connection, and the results are merged afterwards. For ad-hoc SQL that must see
+ * several chapters in one statement, attach() adds a chapter to an existing connection.
+ */
+class ChapterShards {
+public:
+    ChapterShards() = default;
+    explicit ChapterShards(const std::vector<Chapter>& chapters) : chapterList(chapters) {}
+
+    /**
+     * @brief Lists the chapters of a directory: every "<name>.db" file is chapter <name>.
+     * @param directory Directory holding the chapter databases.
+     * @param shards Receives the chapters, ordered by name.
+     * @return False (with error set) if the directory cannot be read or holds no database.
+     */
+    static bool fromDirectory(const std::string& directory, ChapterShards& shards, std::string* error = nullptr);
+
+    const std::vector<Chapter>& chapters() const { return chapterList; }
+
+    /**
+     * @brief The chapter with the given name, or nullptr.
+     */
+    const Chapter* find(const std::string& name) const;
+
+    /**
+     * @brief Caps the threads a fan-out uses (0, the default, means one per core).
+     */
+    void setMaxThreads(int threads) { maxThreads = threads; }
+
+    /**
+     * @brief Runs work once per chapter, in parallel, and returns the results in chapter order.
+     * Each call gets its own read-only DonationTracker for the chapter's file, with no donor
+     * cache, opened and closed on the thread that runs it. The file is opened with
+     * OpenMode::ReadOnly; a chapter that fails to open is reported and keeps a default T.
+     */
+    template <typename T>
+    std::vector<T> fanOut(const std::function<T(const Chapter&, DonationTracker&)>& work) const;
+
+    /**
+     * @brief Every chapter's per-year summaries, in chapter order and then by year.
+     */
+    std::vector<ChapterYearSummary> getYearSummaries() const;
+
+    /**
+     * @brief Adds up per-chapter summaries into one row per year, oldest year first.
+     * Chapters keep separate donor rolls, so someone giving to two chapters counts twice.
+     */
+    static std::vector<YearSummary> combineYearSummaries(const std::vector<ChapterYearSummary>& summaries);
+
+    /**
+     * @brief Attaches a chapter's database to a tracker's connection, as schema <name>.
+     * Does nothing if it is attached already. SQLite allows ten attached databases per
+     * connection by default, so attach on demand and detach when done.
+     */
+    bool attach(DonationTracker& tracker, const std::string& chapter, std::string* error = nullptr) const;
+    bool detach(DonationTracker& tracker, const std::string& chapter) const;
+
+private:
+    void runEach(const std::function<void(std::size_t, DonationTracker&)>& work) const; // The parallel loop.
+
+    std::vector<Chapter> chapterList;
+    int maxThreads = 0;
+};
+
+template <typename T>
+std::vector<T> ChapterShards::fanOut(const std::function<T(const Chapter&, DonationTracker&)>& work) const {
+    std::vector<T> results(chapterList.size());
+    runEach([this, &work, &results](std::size_t index, DonationTracker& tracker) {
+        results[index] = work(chapterList[index], tracker); // Each index is written by one thread only.
+    });
+    return results;
+}
+
+#endif // CHAPTER_SHARDS_H
@@ -0,0 +1,654 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donation_tracker_cli.cpp
+// Command-line front end to the DonationTracker backend for nightly and other batch jobs.
+// Results go to stdout as tab-separated rows; errors go to stderr.
+//
+// Exit codes: 0 success, 1 the command failed (or some rows/letters failed), 2 usage error.
+
+#include "donation_tracker.h" // Backend.
+#include "letter_generator.h" // Parallel letter runs.
+#include "donation_columns.h" // In-memory aggregation for histogram.
+#include "reporting_snapshot.h" // Grouped giving-trend reports.
+#include "chapter_shards.h" // Cross-chapter reports.
+#include "change_sync.h" // Applying chapter changesets centrally.
+#include <QDir> // Chapter outboxes.
+#include <QFileInfo> // Default chapter name of a push.
+#include <QCoreApplication> // Event loop for LetterGenerator; no GUI stack.
+#include <QCommandLineParser> // For parsing command-line options.
+#include <QEventLoop> // Waits for a letter run to finish.
+#include <QTextStream> // Output.
+#include <cstdio> // stdout/stderr.
+#include <memory> // The tracker is opened after option parsing.
+
+static QTextStream& out() {
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+static QTextStream& err() {
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+/**
+ * @brief Opens the tracker with the profile given on the command line, or the command's default.
+ */
+static bool openTracker(const QCommandLineParser& parser, const QCommandLineOption& dbOption,
+                        const QCommandLineOption& profileOption, ConnectionProfile defaultProfile,
+                        std::unique_ptr<DonationTracker>& tracker) {
+    ConnectionProfile profile = defaultProfile;
+    if (parser.isSet(profileOption) &&
+        !DonationTracker::connectionProfileFromString(parser.value(profileOption).toStdString(), profile)) {
+        err() << "Unknown connection profile: " << parser.value(profileOption) << "\n";
+        return false;
+    }
+    tracker.reset(new DonationTracker(profile, parser.value(dbOption).toStdString()));
+    return true;
+}
+
+/**
+ * @brief import <file.csv>: bulk-imports donations and prints a summary.
+ */
+static int runImport(DonationTracker& tracker, const QString& path, int batchSize) {
+    ImportResult result = tracker.importDonationsCsv(path.toStdString(), batchSize);
+    for (const ImportError& error : result.errors) {
+        err() << "line " << error.row << ": " << QString::fromStdString(error.message) << "\n";
+    }
+    out() << "imported\t" << result.rowsImported << "\n"
+          << "rejected\t" << result.rowsFailed << "\n"
+          << "seconds\t" << QString::number(result.elapsedSeconds, 'f', 2) << "\n"
+          << "rows_per_sec\t" << QString::number(result.rowsPerSecond(), 'f', 0) << "\n";
+    return result.rowsFailed == 0 ? 0 : 1;
+}
+
+/**
+ * @brief search [term]: lists matching donors (all donors without a term).
+ */
+static int runSearch(DonationTracker& tracker, const QString& term, int limit) {
+    out() << "id\tfirst_name\tlast_name\tstreet\tcity\tstate\tzip\tcountry\tphone\temail\n";
+    int remaining = limit;
+    tracker.visitDonors(term.toStdString(), [&remaining, limit](const DonorRecord& donor) {
+        out() << donor.id << "\t" << QString::fromStdString(donor.firstName) << "\t" << QString::fromStdString(donor.lastName)
+              << "\t" << QString::fromStdString(donor.street) << "\t" << QString::fromStdString(donor.city)
+              << "\t" << QString::fromStdString(donor.state) << "\t" << QString::fromStdString(donor.zip)
+              << "\t" << QString::fromStdString(donor.country) << "\t" << QString::fromStdString(donor.phone)
+              << "\t" << QString::fromStdString(donor.email) << "\n";
+        return limit <= 0 || --remaining > 0;
+    });
+    return 0;
+}
+
+/**
+ * @brief donations <donor-id>: lists a donor's donations, newest first.
+ */
+static int runDonations(DonationTracker& tracker, const QString& donorIdText) {
+    bool ok = false;
+    int donorId = donorIdText.toInt(&ok);
+    if (!ok) {
+        err() << "Invalid donor ID: " << donorIdText << "\n";
+        return 2;
+    }
+    out() << "id\tdonor_id\tamount\tdate\tpayment_method\n";
+    tracker.visitDonationsForDonor(donorId, [](const DonationRecord& donation) {
+        out() << donation.id << "\t" << donation.donorId << "\t" << QString::fromStdString(formatCents(donation.amountCents))
+              << "\t" << QString::fromStdString(donation.date) << "\t" << QString::fromStdString(donation.paymentMethod) << "\n";
+        return true;
+    });
+    return 0;
+}
+
+/**
+ * @brief totals [year]: per-year summary, or per-donor totals (largest first) for one year.
+ */
+static int runTotals(DonationTracker& tracker, const QStringList& args, int limit) {
+    if (args.isEmpty()) {
+        out() << "year\tdonors\tdonations\ttotal\n";
+        for (const YearSummary& summary : tracker.getYearSummaries()) {
+            out() << summary.year << "\t" << summary.donors << "\t" << summary.donations << "\t"
+                  << QString::fromStdString(formatCents(summary.totalCents)) << "\n";
+        }
+        return 0;
+    }
+
+    bool ok = false;
+    int year = args.first().toInt(&ok);
+    if (!ok) {
+        err() << "Invalid year: " << args.first() << "\n";
+        return 2;
+    }
+    out() << "donor_id\tfirst_name\tlast_name\tdonations\ttotal\n";
+    int remaining = limit;
+    tracker.visitDonorTotals(year, [&remaining, limit](const DonorTotal& total) {
+        out() << total.donorId << "\t" << QString::fromStdString(total.firstName) << "\t" << QString::fromStdString(total.lastName)
+              << "\t" << total.donations << "\t" << QString::fromStdString(formatCents(total.totalCents)) << "\n";
+        return limit <= 0 || --remaining > 0;
+    });
+    return 0;
+}
+
+/**
+ * @brief histogram [year]: donation counts and exact totals per month, or per amount band.
+ */
+static int runHistogram(DonationTracker& tracker, const QStringList& args, const QString& by) {
+    int year = 0;
+    if (!args.isEmpty()) {
+        bool ok = false;
+        year = args.first().toInt(&ok);
+        if (!ok || year == 0) {
+            err() << "Invalid year: " << args.first() << "\n";
+            return 2;
+        }
+    }
+    if (by != "month" && by != "amount") {
+        err() << "Unknown histogram kind: " << by << " (expected month or amount)\n";
+        return 2;
+    }
+
+    DonationColumns columns;
+    if (!tracker.loadDonationColumns(columns)) {
+        return 1;
+    }
+    if (by == "month") {
+        out() << "month\tdonations\ttotal\n";
+        MonthHistogram histogram = columns.monthHistogram(year);
+        for (int month = 0; month < 12; ++month) {
+            out() << (month + 1) << "\t" << histogram.counts[month] << "\t"
+                  << QString::fromStdString(formatCents(histogram.totals[month])) << "\n";
+        }
+        out() << "all\t" << columns.count(year) << "\t" << QString::fromStdString(formatCents(columns.sumCents(year))) << "\n";
+    } else {
+        // Bands in whole dollars; the last one is open-ended.
+        const std::vector<Cents> bounds = {1000, 2500, 5000, 10000, 25000, 50000, 100000, 500000};
+        std::vector<std::size_t> counts = columns.amountHistogram(bounds, year);
+        out() << "from\tbelow\tdonations\n";
+        for (std::size_t band = 0; band < counts.size(); ++band) {
+            out() << QString::fromStdString(formatCents(band == 0 ? 0 : bounds[band - 1])) << "\t"
+                  << (band < bounds.size() ? QString::fromStdString(formatCents(bounds[band])) : QString()) << "\t"
+                  << counts[band] << "\n";
+        }
+        out() << "all\t\t" << columns.count(year) << "\n";
+    }
+    return 0;
+}
+
+/**
+ * @brief report <dimension> [year]: donations and totals grouped by year, month,
+ * payment method, state or country, optionally for one year.
+ */
+static int runReport(DonationTracker& tracker, const QStringList& args) {
+    ReportDimension dimension;
+    if (!ReportingSnapshot::dimensionFromString(args.first().toStdString(), dimension)) {
+        err() << "Unknown report dimension: " << args.first()
+              << " (expected year, month, payment-method, state or country)\n";
+        return 2;
+    }
+    ReportFilter filter;
+    if (args.size() > 1) {
+        bool ok = false;
+        filter.yearFrom = filter.yearTo = args[1].toInt(&ok);
+        if (!ok || filter.yearFrom == 0) {
+            err() << "Invalid year: " << args[1] << "\n";
+            return 2;
+        }
+    }
+
+    ReportingSnapshot snapshot;
+    snapshot.refresh(tracker);
+    out() << args.first() << "\tdonations\ttotal\n";
+    for (const ReportGroup& group : snapshot.groupBy(dimension, filter)) {
+        out() << QString::fromStdString(group.label) << "\t" << group.donations << "\t"
+              << QString::fromStdString(formatCents(group.totalCents)) << "\n";
+    }
+    return 0;
+}
+
+/**
+ * @brief export <donations|donors> <path>: streams an extract to a file ("-" for stdout).
+ * The format follows the file name (.csv, .ndjson or .jsonl, plus .gz to compress) unless
+ * --format or --gzip say otherwise. The summary goes to stderr when the rows go to stdout.
+ */
+static int runExport(DonationTracker& tracker, const QStringList& args, const QString& formatName, bool gzip,
+                     const QString& dateFrom, const QString& dateTo, const QStringList& donorLists) {
+    ExportOptions options;
+    if (args[0] == "donations") {
+        options.table = ExportTable::Donations;
+    } else if (args[0] == "donors") {
+        options.table = ExportTable::Donors;
+    } else {
+        err() << "Unknown export table: " << args[0] << " (expected donations or donors)\n";
+        return 2;
+    }
+    QString path = args[1];
+    QString baseName = path;
+    options.gzip = gzip || path.endsWith(".gz");
+    if (baseName.endsWith(".gz")) {
+        baseName.chop(3);
+    }
+    QString format = formatName.isEmpty() ? (baseName.endsWith(".ndjson") || baseName.endsWith(".jsonl") ? "ndjson" : "csv")
+                                          : formatName;
+    if (format == "csv") {
+        options.format = ExportFormat::Csv;
+    } else if (format == "ndjson") {
+        options.format = ExportFormat::NdJson;
+    } else {
+        err() << "Unknown export format: " << format << " (expected csv or ndjson)\n";
+        return 2;
+    }
+    options.dateFrom = dateFrom.toStdString();
+    options.dateTo = dateTo.toStdString();
+    for (const QString& list : donorLists) {
+        for (const QString& idText : list.split(',', Qt::SkipEmptyParts)) {
+            bool ok = false;
+            int id = idText.trimmed().toInt(&ok);
+            if (!ok) {
+                err() << "Invalid donor ID: " << idText << "\n";
+                return 2;
+            }
+            options.donorIds.push_back(id);
+        }
+    }
+
+    ExportResult result = tracker.exportRows(options, path.toStdString());
+    if (!result.ok) {
+        err() << QString::fromStdString(result.error) << "\n";
+        return 1;
+    }
+    QTextStream& summary = path == "-" ? err() : out();
+    summary << "rows\t" << result.rows << "\n"
+            << "bytes\t" << result.bytes << "\n";
+    return 0;
+}
+
+/**
+ * @brief backup <path>: writes a snapshot of the database while other connections keep working.
+ */
+static int runBackup(DonationTracker& tracker, const QString& path, bool compact) {
+    BackupOptions options;
+    options.compact = compact;
+    BackupResult result = tracker.backupTo(path.toStdString(), options);
+    if (!result.ok) {
+        err() << QString::fromStdString(result.canceled ? std::string("Backup canceled") : result.error) << "\n";
+        return 1;
+    }
+    out() << "pages\t" << result.pageCount << "\n"
+          << "seconds\t" << QString::number(result.elapsedSeconds, 'f', 2) << "\n";
+    return 0;
+}
+
+/**
+ * @brief Prints the counters of a push or an apply.
+ */
+static void printSyncResult(const SyncResult& result) {
+    out() << "changes\t" << result.changes << "\n"
+          << "changesets\t" << result.changesets << "\n"
+          << "bytes\t" << result.bytes << "\n"
+          << "seconds\t" << QString::number(result.elapsedSeconds, 'f', 2) << "\n";
+}
+
+/**
+ * @brief push <outbox>: writes the changes since the last push to <outbox>/<chapter>/.
+ */
+static int runPush(DonationTracker& tracker, const QString& outbox, QString chapter, int batchSize, bool compress) {
+    if (chapter.isEmpty()) {
+        chapter = QFileInfo(QString::fromStdString(tracker.getDatabasePath())).completeBaseName();
+    }
+    SyncOptions options;
+    options.batchSize = batchSize;
+    options.gzip = compress;
+    SyncResult result = tracker.pushChanges(QDir(outbox).filePath(chapter).toStdString(), options);
+    if (!result.ok) {
+        err() << QString::fromStdString(result.error) << "\n";
+        return 1;
+    }
+    printSyncResult(result);
+    return 0;
+}
+
+/**
+ * @brief apply <inbox> <central>: applies every chapter outbox in inbox to the central copies.
+ */
+static int runApply(const QString& inbox, const QString& central) {
+    SyncResult result = ChangeSync::applyInbox(inbox.toStdString(), central.toStdString());
+    if (!result.ok) {
+        err() << QString::fromStdString(result.error) << "\n";
+        return 1;
+    }
+    printSyncResult(result);
+    out() << "skipped\t" << result.skipped << "\n";
+    return 0;
+}
+
+/**
+ * @brief duplicates: likely duplicate donors, best match first, with the keys they share.
+ */
+static int runDuplicates(DonationTracker& tracker, const QString& threshold, int limit) {
+    DedupOptions options;
+    if (!threshold.isEmpty()) {
+        bool ok = false;
+        options.threshold = threshold.toDouble(&ok);
+        if (!ok || options.threshold < 0.0 || options.threshold > 1.0) {
+            err() << "Invalid threshold: " << threshold << " (expected 0 to 1)\n";
+            return 2;
+        }
+    }
+    DedupResult result = tracker.findDuplicateDonors(options);
+    out() << "keep_id\tduplicate_id\tscore\tmatched_on\n";
+    int shown = 0;
+    for (const DuplicatePair& pair : result.pairs) {
+        if (limit > 0 && shown++ == limit) {
+            break;
+        }
+        QStringList keys;
+        if (pair.blocks & BlockEmail) {
+            keys << "email";
+        }
+        if (pair.blocks & BlockPhone) {
+            keys << "phone";
+        }
+        if (pair.blocks & BlockNameZip) {
+            keys << "name+zip";
+        }
+        out() << pair.keepId << "\t" << pair.duplicateId << "\t" << QString::number(pair.score, 'f', 3) << "\t"
+              << keys.join(',') << "\n";
+    }
+    err() << "blocks\t" << result.blocks << "\n"
+          << "skipped_blocks\t" << result.skippedBlocks << "\n"
+          << "pairs_compared\t" << result.candidatePairs << "\n"
+          << "duplicates\t" << result.pairs.size() << "\n"
+          << "seconds\t" << QString::number(result.elapsedSeconds, 'f', 2) << "\n";
+    return 0;
+}
+
+/**
+ * @brief merge <keep-id> <duplicate-id>: folds a duplicate donor into another.
+ */
+static int runMerge(DonationTracker& tracker, const QStringList& args) {
+    bool keepOk = false;
+    bool duplicateOk = false;
+    int keepId = args[0].toInt(&keepOk);
+    int duplicateId = args[1].toInt(&duplicateOk);
+    if (!keepOk || !duplicateOk) {
+        err() << "Invalid donor ID: " << (keepOk ? args[1] : args[0]) << "\n";
+        return 2;
+    }
+    if (!tracker.mergeDonors(keepId, duplicateId)) {
+        err() << "Could not merge donor " << duplicateId << " into " << keepId << "\n";
+        return 1;
+    }
+    out() << "merged\t" << duplicateId << "\t" << keepId << "\n";
+    return 0;
+}
+
+/**
+ * @brief chapters <dir> [year]: per-year totals of every chapter database in a directory,
+ * queried in parallel, followed by the combined rows (chapter "all").
+ */
+static int runChapters(const QString& directory, const QStringList& args) {
+    int year = 0;
+    if (!args.isEmpty()) {
+        bool ok = false;
+        year = args.first().toInt(&ok);
+        if (!ok) {
+            err() << "Invalid year: " << args.first() << "\n";
+            return 2;
+        }
+    }
+    ChapterShards shards;
+    std::string error;
+    if (!ChapterShards::fromDirectory(directory.toStdString(), shards, &error)) {
+        err() << QString::fromStdString(error) << "\n";
+        return 1;
+    }
+    std::vector<ChapterYearSummary> summaries = shards.getYearSummaries();
+    std::vector<ChapterYearSummary> rows;
+    for (const ChapterYearSummary& row : summaries) {
+        if (year == 0 || row.summary.year == year) {
+            rows.push_back(row);
+        }
+    }
+    for (const YearSummary& summary : ChapterShards::combineYearSummaries(rows)) {
+        ChapterYearSummary row;
+        row.chapter = "all";
+        row.summary = summary;
+        rows.push_back(row);
+    }
+    out() << "chapter\tyear\tdonors\tdonations\ttotal\n";
+    for (const ChapterYearSummary& row : rows) {
+        out() << QString::fromStdString(row.chapter) << "\t" << row.summary.year << "\t" << row.summary.donors << "\t"
+              << row.summary.donations << "\t" << QString::fromStdString(formatCents(row.summary.totalCents)) << "\n";
+    }
+    return 0;
+}
+
+/**
+ * @brief letters <year>: writes the year's donation letters with the parallel generator.
+ */
+static int runLetters(const std::string& dbPath, const QString& yearText, const QString& outputDir, const QString& templateName,
+                      const QString& sinkName, const QString& minimumText, const QString& orderName, bool lapsedOnly) {
+    bool ok = false;
+    int year = yearText.toInt(&ok);
+    if (!ok) {
+        err() << "Invalid year: " << yearText << "\n";
+        return 2;
+    }
+    // A built-in template name, otherwise a template file.
+    LetterTemplate letterTemplate;
+    std::string templateError;
+    if (!LetterTemplate::builtIn(templateName.toStdString(), letterTemplate) &&
+        !letterTemplate.loadFile(templateName, &templateError)) {
+        err() << QString::fromStdString(templateError) << "\n";
+        return 2;
+    }
+    LetterSinkKind sinkKind;
+    if (!LetterSink::kindFromString(sinkName.toStdString(), sinkKind)) {
+        err() << "Unknown output kind: " << sinkName << " (expected dir, file, tar or pdf)\n";
+        return 2;
+    }
+    ReceiptSelection selection;
+    selection.lapsedOnly = lapsedOnly; // Implied by the lapsed-donor template.
+    if (!minimumText.isEmpty() && (!parseCents(minimumText.toStdString(), selection.minimumCents) || selection.minimumCents < 0)) {
+        err() << "Invalid minimum total: " << minimumText << "\n";
+        return 2;
+    }
+    if (!ReceiptPlanner::orderFromString(orderName.toStdString(), selection.order)) {
+        err() << "Unknown letter order: " << orderName << " (expected presort, name or amount)\n";
+        return 2;
+    }
+
+    LetterGenerator generator(dbPath);
+    int exitCode = 0;
+    QEventLoop loop;
+    QObject::connect(&generator, &LetterGenerator::finished, &loop,
+                     [&](int written, int failed, bool, const QStringList& errors) {
+        for (const QString& error : errors) {
+            err() << error << "\n";
+        }
+        out() << "written\t" << written << "\n"
+              << "failed\t" << failed << "\n";
+        exitCode = (failed == 0 && errors.isEmpty()) ? 0 : 1;
+        loop.quit();
+    });
+    generator.start(year, outputDir, letterTemplate, sinkKind, selection);
+    loop.exec();
+    return exitCode;
+}
+
+// -----------------------------------------------------------------------------
+// Main function
+// -----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("donation_tracker_cli");
+    QCoreApplication::setApplicationVersion(APP_VERSION);
+
+    // Backend errors go to stderr; the GUI would have shown message boxes.
+    DonationTracker::setDefaultErrorSink([](ErrorSeverity severity, const std::string& title, const std::string& message) {
+        err() << (severity == ErrorSeverity::Critical ? "error: " : "warning: ")
+              << QString::fromStdString(title) << ": " << QString::fromStdString(message) << "\n";
+        err().flush();
+    });
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Donation Tracker command-line tool.\n\n"
+        "Commands:\n"
+        "  import <file.csv>      Bulk import donations (donor_id, amount, date, payment_method).\n"
+        "  search [term]          List matching donors (all donors without a term).\n"
+        "  donations <donor-id>   List a donor's donations, newest first.\n"
+        "  totals [year]          Per-year summary, or per-donor totals for one year.\n"
+        "  histogram [year]       Donations per month (or per amount band with --by amount).\n"
+        "  report <by> [year]     Donations grouped by year, month, payment-method, state or country.\n"
+        "  letters <year>         Write donation letters for a year (--min-total, --order).\n"
+        "  export <table> <path>  Stream donations or donors to CSV or NDJSON (- for stdout).\n"
+        "  backup <path>          Snapshot the database without stopping other users.\n"
+        "  duplicates             List likely duplicate donors (--threshold, --limit).\n"
+        "  merge <keep> <dup>     Move a duplicate donor's donations to another donor and delete it.\n"
+        "  push <outbox>          Write the changes since the last push to <outbox>/<chapter>/ (--chapter).\n"
+        "  apply <inbox> <dir>    Apply every chapter outbox in inbox to <dir>/<chapter>.db.\n"
+        "  chapters <dir> [year]  Per-year totals of each chapter database (<name>.db) in dir, and combined.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption dbOption("db", "Database file.", "path", "donations.db");
+    QCommandLineOption profileOption("profile", "Connection profile: interactive, bulk-load or read-only "
+                                                "(default: bulk-load for import, read-only otherwise).", "name");
+    QCommandLineOption batchOption("batch-size", "Rows per transaction for import, or changes per changeset for push.", "n", "5000");
+    QCommandLineOption limitOption("limit", "Maximum rows for search, totals and duplicates (0 = no limit).", "n", "0");
+    QCommandLineOption outputDirOption("output-dir", "Directory for letters.", "dir", "letters");
+    QCommandLineOption byOption("by", "Histogram kind: month or amount.", "kind", "month");
+    QCommandLineOption templateOption("template", "Letter template: thank-you, year-end-receipt, lapsed-donor "
+                                                  "or a template file with {{placeholders}}.", "name", "thank-you");
+    QCommandLineOption sinkOption("output", "Letter output: dir (one file per donor), file (one text file with an "
+                                            "index), tar or pdf.", "kind", "dir");
+    QCommandLineOption minTotalOption("min-total", "Write letters only for donors whose total for the year is at least "
+                                                   "this amount (e.g. 250.00).", "amount");
+    QCommandLineOption orderOption("order", "Letter order: presort (country, ZIP code, name), name or amount.", "order",
+                                   "presort");
+    QCommandLineOption lapsedOption("lapsed-only", "Write letters only to donors with no gift after the letter year "
+                                                   "(implied by the lapsed-donor template).");
+    QCommandLineOption queryStatsOption("query-stats", "Append per-statement timings to this file on exit (- for stderr).", "path");
+    QCommandLineOption slowQueryOption("slow-query-ms", "Log statements slower than this many milliseconds.", "ms");
+    QCommandLineOption formatOption("format", "Export format: csv or ndjson (default: from the file name).", "format");
+    QCommandLineOption gzipOption("gzip", "Compress the export with gzip (default for .gz file names).");
+    QCommandLineOption fromOption("from", "Export donations dated on or after this day (YYYY-MM-DD).", "date");
+    QCommandLineOption toOption("to", "Export donations dated on or before this day (YYYY-MM-DD).", "date");
+    QCommandLineOption donorOption("donor", "Export only these donor IDs (comma-separated; may be repeated).", "ids");
+    QCommandLineOption thresholdOption("threshold", "Duplicate similarity threshold, 0 to 1 (default 0.85).", "score");
+    QCommandLineOption chapterOption("chapter", "Chapter name of a push (default: the database file name).", "name");
+    QCommandLineOption noCompressOption("no-compress", "Write uncompressed changesets.");
+    QCommandLineOption compactOption("compact", "Back up with VACUUM INTO: a smaller, defragmented copy.");
+    parser.addOptions({dbOption, profileOption, batchOption, limitOption, outputDirOption, byOption, templateOption, sinkOption,
+                       queryStatsOption, slowQueryOption, formatOption, gzipOption, fromOption, toOption, donorOption,
+                       compactOption, thresholdOption, chapterOption, noCompressOption, minTotalOption, orderOption,
+                       lapsedOption});
+    parser.addPositionalArgument("command", "import, search, donations, totals, histogram, report, letters, export, backup, duplicates, merge, push, apply or chapters.");
+    parser.addPositionalArgument("arguments", "Command arguments.", "[arguments...]");
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        err() << parser.helpText();
+        return 2;
+    }
+    QString command = args.takeFirst();
+    int limit = parser.value(limitOption).toInt();
+
+    // Every tracker opened below is profiled; each appends its table when closed.
+    QueryProfilingOptions profiling;
+    profiling.statsPath = parser.value(queryStatsOption).toStdString();
+    profiling.collectStats = !profiling.statsPath.empty();
+    profiling.slowQueryMs = parser.value(slowQueryOption).toDouble();
+    DonationTracker::setDefaultQueryProfiling(profiling);
+
+    if (command == "chapters") {
+        if (args.isEmpty() || args.size() > 2) {
+            err() << "Usage: chapters <dir> [year]\n";
+            return 2;
+        }
+        QString directory = args.takeFirst();
+        return runChapters(directory, args); // Opens one connection per chapter, not --db.
+    }
+
+    if (command == "apply") {
+        if (args.size() != 2) {
+            err() << "Usage: apply <inbox> <central-dir>\n";
+            return 2;
+        }
+        return runApply(args[0], args[1]); // Opens each chapter's central copy, not --db.
+    }
+
+    if (command == "letters") {
+        if (args.size() != 1) {
+            err() << "Usage: letters <year> [--template <name or file>] [--output dir|file|tar|pdf] [--min-total <amount>] "
+                     "[--order presort|name|amount] [--lapsed-only]\n";
+            return 2;
+        }
+        // The generator reads through its own connection; open the tracker once so the
+        // schema is created or migrated before it starts.
+        std::unique_ptr<DonationTracker> tracker;
+        if (!openTracker(parser, dbOption, profileOption, ConnectionProfile::ReadOnlyReporting, tracker)) {
+            return 2;
+        }
+        std::string dbPath = tracker->getDatabasePath();
+        tracker.reset();
+        return runLetters(dbPath, args.first(), parser.value(outputDirOption), parser.value(templateOption),
+                          parser.value(sinkOption), parser.value(minTotalOption), parser.value(orderOption),
+                          parser.isSet(lapsedOption));
+    }
+
+    std::unique_ptr<DonationTracker> tracker;
+    bool writes = command == "merge" || command == "push"; // push trims the change log.
+    ConnectionProfile defaultProfile = command == "import" ? ConnectionProfile::BulkLoad
+                                       : writes            ? ConnectionProfile::Interactive
+                                                           : ConnectionProfile::ReadOnlyReporting;
+    if (!openTracker(parser, dbOption, profileOption, defaultProfile, tracker)) {
+        return 2;
+    }
+
+    if (command == "import" && args.size() == 1) {
+        return runImport(*tracker, args.first(), parser.value(batchOption).toInt());
+    } else if (command == "search" && args.size() <= 1) {
+        return runSearch(*tracker, args.join(' '), limit);
+    } else if (command == "donations" && args.size() == 1) {
+        return runDonations(*tracker, args.first());
+    } else if (command == "totals" && args.size() <= 1) {
+        return runTotals(*tracker, args, limit);
+    } else if (command == "histogram" && args.size() <= 1) {
+        return runHistogram(*tracker, args, parser.value(byOption));
+    } else if (command == "report" && (args.size() == 1 || args.size() == 2)) {
+        return runReport(*tracker, args);
+    } else if (command == "export" && args.size() == 2) {
+        return runExport(*tracker, args, parser.value(formatOption), parser.isSet(gzipOption), parser.value(fromOption),
+                         parser.value(toOption), parser.values(donorOption));
+    } else if (command == "backup" && args.size() == 1) {
+        return runBackup(*tracker, args.first(), parser.isSet(compactOption));
+    } else if (command == "duplicates" && args.isEmpty()) {
+        return runDuplicates(*tracker, parser.value(thresholdOption), limit);
+    } else if (command == "merge" && args.size() == 2) {
+        return runMerge(*tracker, args);
+    } else if (command == "push" && args.size() == 1) {
+        return runPush(*tracker, args.first(), parser.value(chapterOption), parser.value(batchOption).toInt(),
+                       !parser.isSet(noCompressOption));
+    }
+    err() << "Unknown command or wrong arguments: " << command << " " << args.join(' ') << "\n"
+          << "Run with --help for usage.\n";
+    return 2;
+}
@@ -0,0 +1,29 @@
+# Donation Tracker - A Qt-based application for managing donations
+# Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+# donation_tracker_cli.pro
+# Command-line front end for batch jobs (import, search, totals, letters). Builds against
+# QtCore only, so it runs on servers and in cron jobs without a display.
+#   qmake cli/donation_tracker_cli.pro && make && ./donation_tracker_cli --help
+
+QT = core
+TARGET = donation_tracker_cli
+TEMPLATE = app
+CONFIG += console headless
+CONFIG -= app_bundle
+include(../backend.pri)
+SOURCES += donation_tracker_cli.cpp
@@ -0,0 +1,124 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// connection_pool.cpp
+// Implementation of ConnectionPool, the read-only connections used for parallel reads.
+
+#include "connection_pool.h"
+#include <QDeadlineTimer> // Remaining wait for tryAcquire.
+#include <QMutexLocker> // Scoped locking of the pool state.
+#include <QThread> // Owner thread and the default size.
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        tracker = other.tracker;
+        other.tracker = nullptr;
+    }
+    return *this;
+}
+
+/**
+ * @brief Returns the leased connection to its pool; the lease is empty afterwards.
+ */
+void ConnectionPool::Lease::release() {
+    if (tracker) {
+        pool->checkin(tracker);
+        tracker = nullptr;
+    }
+}
+
+/**
+ * @brief Constructor for ConnectionPool.
+ * @param maxConnections 0 (or less) for one connection per core.
+ */
+ConnectionPool::ConnectionPool(const std::string& dbPath, int maxConnections)
+    : dbPath(dbPath), capacity(maxConnections > 0 ? maxConnections : QThread::idealThreadCount()),
+      ownerThread(QThread::currentThread()), opening(0) {
+}
+
+/**
+ * @brief Destructor for ConnectionPool. Closes every connection; none may still be leased.
+ */
+ConnectionPool::~ConnectionPool() {
+    QMutexLocker locker(&mutex);
+    idle.clear();
+    connections.clear(); // Closes each connection (finalizing its cached statements).
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    return Lease(this, checkout(-1));
+}
+
+ConnectionPool::Lease ConnectionPool::tryAcquire(int timeoutMs) {
+    DonationTracker* tracker = checkout(timeoutMs < 0 ? 0 : timeoutMs);
+    return tracker ? Lease(this, tracker) : Lease();
+}
+
+int ConnectionPool::openConnections() const {
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(connections.size());
+}
+
+int ConnectionPool::idleConnections() const {
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(idle.size());
+}
+
+/**
+ * @brief Takes an idle connection, opens a new one if there is room, or waits.
+ * Opening runs outside the lock so other callers can take idle connections meanwhile.
+ */
+DonationTracker* ConnectionPool::checkout(int timeoutMs) {
+    QDeadlineTimer deadline = timeoutMs < 0 ? QDeadlineTimer(QDeadlineTimer::Forever) : QDeadlineTimer(timeoutMs);
+    QMutexLocker locker(&mutex);
+    for (;;) {
+        if (!idle.empty()) {
+            DonationTracker* tracker = idle.back(); // Most recently used: its page cache is warmest.
+            idle.pop_back();
+            return tracker;
+        }
+        if (static_cast<int>(connections.size()) + opening < capacity) {
+            ++opening;
+            locker.unlock();
+            std::unique_ptr<DonationTracker> tracker(new DonationTracker(ConnectionProfile::ReadOnlyReporting, dbPath));
+            tracker->setDonorCacheCapacity(0);
+            tracker->moveToThread(ownerThread);
+            locker.relock();
+            --opening;
+            connections.push_back(std::move(tracker));
+            return connections.back().get();
+        }
+        if (!returned.wait(&mutex, deadline)) {
+            return nullptr;
+        }
+    }
+}
+
+/**
+ * @brief Puts a connection back and wakes one waiting caller.
+ */
+void ConnectionPool::checkin(DonationTracker* tracker) {
+    {
+        QMutexLocker locker(&mutex);
+        idle.push_back(tracker);
+    }
+    returned.wakeOne();
+}
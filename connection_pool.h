@@ -0,0 +1,114 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// connection_pool.h
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include "donation_tracker.h" // The pooled connections.
+#include <QMutex> // Guards the idle list.
+#include <QWaitCondition> // Wakes callers waiting for a free connection.
+#include <memory> // Owned trackers.
+#include <string> // Database path.
+#include <vector> // All and idle connections.
+
+class QThread;
+
+/**
+ * @brief The ConnectionPool class hands out read-only DonationTracker connections to
+ * threads that run long reads (reports, letter aggregates, exports) alongside the single
+ * writer connection. Under WAL each pooled connection reads its own consistent snapshot and
+ * neither blocks nor is blocked by the writer, so N leases can scan on N cores while the
+ * GUI keeps editing.
+ *
+ * Connections are opened lazily, up to maxConnections, with the ReadOnlyReporting profile
+ * and the donor cache disabled: a pooled connection never sees the writer's change signals,
+ * so it must not serve cached donors. A leased tracker belongs to its holder until the Lease
+ * is destroyed; checkout and return are thread-safe. All leases must be returned before the
+ * pool is destroyed.
+ */
+class ConnectionPool {
+public:
+    /**
+     * @brief A checked-out connection, returned to the pool when the lease is destroyed.
+     * Empty (false) if tryAcquire timed out.
+     */
+    class Lease {
+    public:
+        Lease() : pool(nullptr), tracker(nullptr) {}
+        Lease(Lease&& other) : pool(other.pool), tracker(other.tracker) { other.tracker = nullptr; }
+        Lease& operator=(Lease&& other);
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        explicit operator bool() const { return tracker != nullptr; }
+        DonationTracker& operator*() const { return *tracker; }
+        DonationTracker* operator->() const { return tracker; }
+        void release(); // Returns the connection early.
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, DonationTracker* tracker) : pool(pool), tracker(tracker) {}
+        ConnectionPool* pool;
+        DonationTracker* tracker;
+    };
+
+    /**
+     * @brief Constructor for ConnectionPool. Opens no connections yet.
+     * @param dbPath Database file; its schema must already be current (the writer's
+     *        DonationTracker migrates it).
+     * @param maxConnections Upper bound on open connections; defaults to one per core.
+     */
+    explicit ConnectionPool(const std::string& dbPath, int maxConnections = 0);
+    ~ConnectionPool();
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * @brief Checks out a connection, opening one if none is idle and the pool is not full,
+     * otherwise waiting for one to be returned.
+     */
+    Lease acquire();
+
+    /**
+     * @brief Like acquire(), but gives up after timeoutMs (the lease is then empty).
+     */
+    Lease tryAcquire(int timeoutMs);
+
+    int maxConnections() const { return capacity; }
+    int openConnections() const; // Connections opened so far.
+    int idleConnections() const; // Open connections not currently leased.
+    const std::string& getDatabasePath() const { return dbPath; }
+
+private:
+    DonationTracker* checkout(int timeoutMs); // nullptr on timeout; timeoutMs < 0 waits forever.
+    void checkin(DonationTracker* tracker);
+
+    std::string dbPath;
+    int capacity; // maxConnections.
+    QThread* ownerThread; // Pooled trackers are moved here so they outlive the threads that opened them.
+    mutable QMutex mutex; // Guards connections, idle and opening.
+    QWaitCondition returned; // Signalled when a lease is returned.
+    std::vector<std::unique_ptr<DonationTracker>> connections; // Every open connection.
+    std::vector<DonationTracker*> idle; // Open connections ready to lease.
+    int opening; // Connections being opened outside the lock; they count towards capacity.
+};
+
+#endif // CONNECTION_POOL_H
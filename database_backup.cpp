@@ -0,0 +1,236 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// database_backup.cpp
+// Implementation of DatabaseBackup: online snapshots through the SQLite backup API or VACUUM INTO.
+
+#include "database_backup.h"
+#include <QThread> // The backup thread.
+#include <QFile> // Replacing the destination with the finished snapshot.
+#include <QElapsedTimer> // Snapshot duration.
+#include <sqlite3.h> // Backup API.
+
+static const int vacuumProgressOps = 100000; // VM steps between cancel checks of VACUUM INTO.
+
+/**
+ * @brief Progress handler of a compacting snapshot: a nonzero return interrupts VACUUM INTO.
+ */
+static int vacuumProgress(void* context) {
+    const BackupProgress& progress = *static_cast<const BackupProgress*>(context);
+    return progress(0, 0) ? 0 : 1;
+}
+
+/**
+ * @brief Copies the source into a new database file page by page, a step at a time.
+ */
+static bool copyPages(sqlite3* source, const std::string& partPath, const BackupOptions& options,
+                      const BackupProgress& progress, BackupResult& result) {
+    sqlite3* destination = nullptr;
+    if (sqlite3_open_v2(partPath.c_str(), &destination, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+        result.error = std::string("Cannot create snapshot file: ") + sqlite3_errmsg(destination);
+        sqlite3_close(destination);
+        return false;
+    }
+    // The read transaction is what keeps the copy from restarting: between two steps the
+    // source connection keeps its WAL snapshot, so commits by other connections are simply
+    // not seen. It also means the WAL cannot be checkpointed past that snapshot until the end.
+    if (sqlite3_exec(source, "BEGIN; SELECT COUNT(*) FROM sqlite_master;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        result.error = std::string("Cannot read database: ") + sqlite3_errmsg(source);
+        sqlite3_close(destination);
+        return false;
+    }
+    sqlite3_backup* backup = sqlite3_backup_init(destination, "main", source, "main");
+    if (!backup) {
+        result.error = std::string("Cannot start snapshot: ") + sqlite3_errmsg(destination);
+        sqlite3_exec(source, "COMMIT;", nullptr, nullptr, nullptr);
+        sqlite3_close(destination);
+        return false;
+    }
+    int rc;
+    for (;;) {
+        rc = sqlite3_backup_step(backup, options.pagesPerStep);
+        result.pageCount = sqlite3_backup_pagecount(backup);
+        if (rc != SQLITE_OK && rc != SQLITE_BUSY && rc != SQLITE_LOCKED) {
+            break; // SQLITE_DONE, or an error.
+        }
+        if (progress && !progress(result.pageCount - sqlite3_backup_remaining(backup), result.pageCount)) {
+            result.canceled = true;
+            break;
+        }
+        if (options.pauseMs > 0) {
+            sqlite3_sleep(options.pauseMs);
+        }
+    }
+    sqlite3_backup_finish(backup);
+    sqlite3_exec(source, "COMMIT;", nullptr, nullptr, nullptr);
+    bool ok = rc == SQLITE_DONE && !result.canceled;
+    if (!ok && !result.canceled) {
+        result.error = std::string("Snapshot failed: ") + sqlite3_errstr(rc);
+    }
+    if (ok) {
+        // The copied header still says WAL; a snapshot should be a single self-contained file.
+        sqlite3_exec(destination, "PRAGMA journal_mode=DELETE;", nullptr, nullptr, nullptr);
+        if (progress) {
+            progress(result.pageCount, result.pageCount);
+        }
+    }
+    sqlite3_close(destination);
+    return ok;
+}
+
+/**
+ * @brief Writes a defragmented copy of the source with VACUUM INTO.
+ * The statement runs in a single read transaction of its own, so it sees one version of
+ * the database just like the page copy.
+ */
+static bool vacuumInto(sqlite3* source, const std::string& partPath, const BackupProgress& progress, BackupResult& result) {
+    if (progress) {
+        sqlite3_progress_handler(source, vacuumProgressOps, vacuumProgress, const_cast<BackupProgress*>(&progress));
+    }
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(source, "VACUUM INTO ?;", -1, &stmt, nullptr);
+    if (rc == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, partPath.c_str(), -1, SQLITE_TRANSIENT);
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_progress_handler(source, 0, nullptr, nullptr);
+    if (rc == SQLITE_INTERRUPT) {
+        result.canceled = true;
+        return false;
+    }
+    if (rc != SQLITE_DONE) {
+        result.error = std::string("Compacting snapshot failed: ") + sqlite3_errmsg(source);
+        return false;
+    }
+
+    sqlite3* snapshot = nullptr;
+    if (sqlite3_open_v2(partPath.c_str(), &snapshot, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK) {
+        sqlite3_stmt* count = nullptr;
+        if (sqlite3_prepare_v2(snapshot, "PRAGMA page_count;", -1, &count, nullptr) == SQLITE_OK &&
+            sqlite3_step(count) == SQLITE_ROW) {
+            result.pageCount = sqlite3_column_int(count, 0);
+        }
+        sqlite3_finalize(count);
+    }
+    sqlite3_close(snapshot);
+    if (progress) {
+        progress(result.pageCount, result.pageCount);
+    }
+    return true;
+}
+
+/**
+ * @brief Constructor for DatabaseBackup.
+ */
+DatabaseBackup::DatabaseBackup(const std::string& dbPath, QObject* parent)
+    : QObject(parent), dbPath(dbPath), thread(nullptr), running(false), canceled(false) {
+}
+
+/**
+ * @brief Destructor for DatabaseBackup.
+ * Cancels any running snapshot and waits for its thread to finish.
+ */
+DatabaseBackup::~DatabaseBackup() {
+    cancel();
+    if (thread) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+/**
+ * @brief Starts a snapshot on the backup thread.
+ * @return True if the snapshot was started, false if one is already in progress.
+ */
+bool DatabaseBackup::start(const QString& destinationPath, const BackupOptions& options) {
+    if (running.exchange(true)) {
+        return false; // Only one snapshot at a time.
+    }
+    if (thread) {
+        thread->wait(); // The previous snapshot has emitted finished() and is about to exit.
+        delete thread;
+    }
+    canceled = false;
+
+    std::string destination = destinationPath.toStdString();
+    thread = QThread::create([this, destination, options]() {
+        int lastCopied = -1;
+        BackupResult result = write(dbPath, destination, options, [this, &lastCopied](int pagesCopied, int pageCount) {
+            if (pagesCopied != lastCopied) {
+                lastCopied = pagesCopied;
+                emit progress(pagesCopied, pageCount);
+            }
+            return !canceled.load();
+        });
+        running = false;
+        emit finished(result.ok, result.canceled, QString::fromStdString(result.error));
+    });
+    thread->start();
+    return true;
+}
+
+/**
+ * @brief Asks a running snapshot to stop. Safe to call from any thread.
+ */
+void DatabaseBackup::cancel() {
+    canceled = true;
+}
+
+/**
+ * @brief Writes a snapshot of dbPath to destinationPath on the calling thread.
+ * The snapshot goes to "<destination>.part" first and only replaces the destination once
+ * it is complete.
+ */
+BackupResult DatabaseBackup::write(const std::string& dbPath, const std::string& destinationPath,
+                                   const BackupOptions& options, const BackupProgress& progress) {
+    BackupResult result;
+    QElapsedTimer timer;
+    timer.start();
+    const QString partFile = QString::fromStdString(destinationPath + ".part");
+    QFile::remove(partFile); // Left behind by an interrupted snapshot.
+
+    sqlite3* source = nullptr;
+    if (sqlite3_open_v2(dbPath.c_str(), &source, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        result.error = std::string("Cannot open database: ") + sqlite3_errmsg(source);
+        sqlite3_close(source);
+        return result;
+    }
+    sqlite3_busy_timeout(source, 5000);
+
+    bool ok = options.compact ? vacuumInto(source, destinationPath + ".part", progress, result)
+                              : copyPages(source, destinationPath + ".part", options, progress, result);
+    sqlite3_close(source);
+
+    const QString destinationFile = QString::fromStdString(destinationPath);
+    if (ok && QFile::exists(destinationFile) && !QFile::remove(destinationFile)) {
+        result.error = "Cannot replace " + destinationPath;
+        ok = false;
+    }
+    if (ok && !QFile::rename(partFile, destinationFile)) {
+        result.error = "Cannot rename the snapshot to " + destinationPath;
+        ok = false;
+    }
+    if (!ok) {
+        QFile::remove(partFile);
+    }
+    result.ok = ok;
+    result.elapsedSeconds = timer.elapsed() / 1000.0;
+    return result;
+}
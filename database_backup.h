@@ -0,0 +1,123 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// database_backup.h
+#ifndef DATABASE_BACKUP_H
+#define DATABASE_BACKUP_H
+
+#include <QObject> // Base class; progress is reported through signals.
+#include <QString> // Destination path and error messages.
+#include <atomic> // Running and cancel flags shared with the backup thread.
+#include <functional> // Progress callback of the synchronous copy.
+#include <string> // Database paths.
+
+class QThread;
+
+/**
+ * @brief How a database snapshot is taken.
+ */
+struct BackupOptions {
+    bool compact = false; // VACUUM INTO: a defragmented copy without free pages, written in one statement.
+    int pagesPerStep = 1024; // Pages copied per sqlite3_backup_step (4 MiB with 4 KiB pages).
+    int pauseMs = 5; // Sleep between steps, so the copy yields disk bandwidth to the application.
+};
+
+/**
+ * @brief Outcome of a snapshot.
+ */
+struct BackupResult {
+    bool ok = false;
+    bool canceled = false; // The progress callback (or cancel()) stopped the copy.
+    int pageCount = 0; // Pages in the snapshot.
+    double elapsedSeconds = 0.0;
+    std::string error; // Why the snapshot failed (when !ok and !canceled).
+};
+
+/**
+ * @brief Called between steps with the pages copied so far; returning false cancels.
+ * A compacting snapshot has no page-by-page progress and reports 0 until it is done.
+ */
+using BackupProgress = std::function<bool(int pagesCopied, int pageCount)>;
+
+/**
+ * @brief The DatabaseBackup class writes consistent snapshots of a live database file.
+ * The copy runs through its own read-only connection, inside one read transaction: under
+ * WAL that pins a single version of the database for the whole copy without blocking the
+ * application's writers, and commits made meanwhile do not restart it. The snapshot is
+ * written under "<destination>.part" and renamed into place once complete, so a crash or
+ * cancel never leaves a torn file under the destination name.
+ */
+class DatabaseBackup : public QObject {
+    Q_OBJECT // Enables Qt's meta-object system.
+
+public:
+    /**
+     * @brief Constructor for DatabaseBackup.
+     * @param dbPath Path of the database file to snapshot.
+     * @param parent The parent object.
+     */
+    explicit DatabaseBackup(const std::string& dbPath, QObject* parent = nullptr);
+    // Destructor cancels a running snapshot and waits for its thread.
+    ~DatabaseBackup();
+
+    /**
+     * @brief Starts a snapshot on a background thread. Returns immediately.
+     * Does nothing (and returns false) if a snapshot is already in progress.
+     * @param destinationPath File to write; replaced if it exists.
+     * @param options Page-copy or compacting snapshot, and its pacing.
+     * @return True if the snapshot was started.
+     */
+    bool start(const QString& destinationPath, const BackupOptions& options = BackupOptions());
+
+    /**
+     * @brief True between start() and the matching finished() signal.
+     */
+    bool isRunning() const { return running.load(); }
+
+    /**
+     * @brief Writes a snapshot on the calling thread (used by start() and by the CLI).
+     * @param dbPath Database to copy.
+     * @param destinationPath File to write; replaced if it exists.
+     * @param options Page-copy or compacting snapshot, and its pacing.
+     * @param progress Optional; called between steps, and may cancel.
+     */
+    static BackupResult write(const std::string& dbPath, const std::string& destinationPath,
+                              const BackupOptions& options = BackupOptions(), const BackupProgress& progress = nullptr);
+
+public slots:
+    /**
+     * @brief Asks a running snapshot to stop; the partial file is removed.
+     * finished() is still emitted once the thread has wound down.
+     */
+    void cancel();
+
+signals:
+    // Emitted from the backup thread as pages are copied; delivered queued to GUI receivers.
+    void progress(int pagesCopied, int pageCount);
+    // Emitted once per snapshot.
+    void finished(bool ok, bool canceled, const QString& error);
+
+private:
+    std::string dbPath; // Database file to copy.
+    QThread* thread; // Runs the current snapshot (nullptr when idle).
+    std::atomic<bool> running; // A snapshot is in progress.
+    std::atomic<bool> canceled; // Set by cancel(); polled between steps.
+};
+
+#endif // DATABASE_BACKUP_H
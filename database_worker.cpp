@@ -0,0 +1,175 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// database_worker.cpp
+// Implementation of DatabaseWorker, the dedicated thread that serves the GUI's read queries.
+
+#include "database_worker.h"
+#include <QThread> // The worker thread.
+#include <QThreadPool> // Threads for parallel jobs.
+#include <QMutexLocker> // Scoped locking of the request queue.
+
+/**
+ * @brief Constructor for DatabaseWorker.
+ * The worker's connection is opened on the worker thread itself, so the GUI thread
+ * does not wait for it.
+ */
+DatabaseWorker::DatabaseWorker(const std::string& dbPath, QObject* parent)
+    : QObject(parent), dbPath(dbPath), stopping(false), readers(dbPath), parallelThreads(new QThreadPool(this)) {
+    parallelThreads->setMaxThreadCount(readers.maxConnections());
+    thread = QThread::create([this]() { run(); });
+    thread->start();
+}
+
+/**
+ * @brief Destructor for DatabaseWorker.
+ * The requests and parallel jobs being executed (if any) complete; everything still
+ * waiting is canceled.
+ */
+DatabaseWorker::~DatabaseWorker() {
+    {
+        QMutexLocker locker(&queueMutex);
+        stopping = true;
+    }
+    queueNotEmpty.wakeAll();
+    thread->wait();
+    delete thread;
+    parallelThreads->waitForDone(); // Queued parallel jobs see stopping and cancel themselves.
+}
+
+/**
+ * @brief Appends a request to the queue and wakes the worker thread.
+ */
+void DatabaseWorker::post(std::function<void(DonationTracker*)> request) {
+    {
+        QMutexLocker locker(&queueMutex);
+        if (!stopping) {
+            queue.push_back(std::move(request));
+            request = nullptr;
+        }
+    }
+    if (request) {
+        request(nullptr); // Posted during shutdown: cancel straight away.
+        return;
+    }
+    queueNotEmpty.wakeOne();
+}
+
+/**
+ * @brief Worker thread body: opens the connection, then serves requests until stopped.
+ */
+void DatabaseWorker::run() {
+    // Read-only profile: larger cache and mmap, and query_only guards against stray writes.
+    DonationTracker tracker(ConnectionProfile::ReadOnlyReporting, dbPath);
+
+    for (;;) {
+        std::function<void(DonationTracker*)> request;
+        {
+            QMutexLocker locker(&queueMutex);
+            while (queue.empty() && !stopping) {
+                queueNotEmpty.wait(&queueMutex);
+            }
+            if (stopping) {
+                break;
+            }
+            request = std::move(queue.front());
+            queue.pop_front();
+        }
+        request(&tracker);
+    }
+
+    // Cancel whatever was still queued so no caller waits forever.
+    std::deque<std::function<void(DonationTracker*)>> remaining;
+    {
+        QMutexLocker locker(&queueMutex);
+        remaining.swap(queue);
+    }
+    for (auto& request : remaining) {
+        request(nullptr);
+    }
+}
+
+/**
+ * @brief Starts a job on the pool threads with a leased connection, or with nullptr to
+ * cancel it once the worker is shutting down.
+ */
+void DatabaseWorker::startParallel(std::function<void(DonationTracker*)> job) {
+    parallelThreads->start([this, job]() {
+        {
+            QMutexLocker locker(&queueMutex);
+            if (stopping) {
+                locker.unlock();
+                job(nullptr);
+                return;
+            }
+        }
+        ConnectionPool::Lease lease = readers.acquire(); // Never waits: one connection per thread.
+        job(&*lease);
+    });
+}
+
+/**
+ * @brief Fetches the next page of a donor listing on the worker thread.
+ */
+QFuture<DonorPage> DatabaseWorker::searchDonors(const DonorPageCursor& cursor, int limit) {
+    return submit<DonorPage>([cursor, limit](DonationTracker& tracker) {
+        DonorPage page;
+        page.cursor = cursor;
+        page.rows = tracker.fetchDonorPage(page.cursor, limit);
+        return page;
+    });
+}
+
+/**
+ * @brief Fetches one donor on the worker thread (id 0 in the result if not found).
+ */
+QFuture<DonorRecord> DatabaseWorker::getDonorDetails(int id) {
+    return submit<DonorRecord>([id](DonationTracker& tracker) {
+        DonorRecord donor;
+        if (!tracker.getDonorRecord(id, donor)) {
+            donor = DonorRecord();
+        }
+        return donor;
+    });
+}
+
+void DatabaseWorker::invalidateDonor(int donorId) {
+    post([donorId](DonationTracker* tracker) {
+        if (tracker) {
+            tracker->invalidateCachedDonor(donorId);
+        }
+    });
+}
+
+void DatabaseWorker::invalidateDonorCache() {
+    post([](DonationTracker* tracker) {
+        if (tracker) {
+            tracker->clearDonorCache();
+        }
+    });
+}
+
+/**
+ * @brief Fetches a donor's donations on the worker thread, newest first.
+ */
+QFuture<std::vector<DonationRecord>> DatabaseWorker::getDonationsForDonor(int donorId) {
+    return submit<std::vector<DonationRecord>>([donorId](DonationTracker& tracker) {
+        return tracker.fetchDonationsForDonor(donorId);
+    });
+}
@@ -0,0 +1,173 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// database_worker.h
+#ifndef DATABASE_WORKER_H
+#define DATABASE_WORKER_H
+
+#include "donation_tracker.h" // DonationTracker and the record types returned to callers.
+#include "connection_pool.h" // Read-only connections for parallel jobs.
+#include <QObject> // Base class.
+#include <QFuture> // Results handed back to the caller.
+#include <QFutureInterface> // Producer side of those results.
+#include <QMutex> // Guards the request queue.
+#include <QWaitCondition> // Wakes the worker thread when a request arrives.
+#include <deque> // FIFO request queue.
+#include <functional> // Queued requests.
+#include <memory> // Shared ownership of each request's QFutureInterface.
+#include <string> // Database path.
+#include <vector> // Donation lists and donor pages.
+
+class QThread;
+class QThreadPool;
+
+/**
+ * @brief One page of a donor listing, together with the cursor advanced past it.
+ * Pass the returned cursor to the next DatabaseWorker::searchDonors call to continue.
+ */
+struct DonorPage {
+    DonorPageCursor cursor; // Position after this page.
+    std::vector<DonorRecord> rows; // The donors on this page.
+};
+
+/**
+ * @brief The DatabaseWorker class runs read queries on a dedicated thread.
+ * The thread owns its own DonationTracker (and so its own sqlite3 connection, opened with
+ * the read-only reporting profile) and serves requests from a FIFO queue one at a time.
+ * Every request returns a QFuture immediately; watch it with a QFutureWatcher to get the
+ * result back on the GUI thread. Canceling the future skips a queued request and interrupts
+ * one that is already running (see DonationTracker::setCancelCheck). Under WAL the worker always sees the latest committed
+ * writes from the GUI connection, and a slow query here never stalls input handling.
+ * Writes stay on the GUI thread's DonationTracker, which also emits the change signals.
+ *
+ * Long reads that need not keep the queue's order (reports, exports) can instead be run with
+ * submitParallel, each on its own pooled connection, so several run at once and none holds
+ * up the lookups behind it.
+ */
+class DatabaseWorker : public QObject {
+    Q_OBJECT // Enables Qt's meta-object system.
+
+public:
+    /**
+     * @brief Constructor for DatabaseWorker. Starts the worker thread.
+     * @param dbPath Path of the database file; the schema must already be current
+     *        (i.e. the GUI's DonationTracker has been constructed first).
+     * @param parent The parent object.
+     */
+    explicit DatabaseWorker(const std::string& dbPath, QObject* parent = nullptr);
+    // Destructor cancels queued requests and joins the worker thread.
+    ~DatabaseWorker();
+
+    /**
+     * @brief Fetches the next page of a donor listing (see DonationTracker::fetchDonorPage).
+     * @param cursor Position to continue from; a default cursor with a search term starts a listing.
+     * @param limit Maximum number of rows to return.
+     */
+    QFuture<DonorPage> searchDonors(const DonorPageCursor& cursor, int limit);
+
+    /**
+     * @brief Fetches one donor. The result has id 0 if the donor does not exist.
+     */
+    QFuture<DonorRecord> getDonorDetails(int id);
+
+    /**
+     * @brief Fetches a donor's donations, newest first.
+     */
+    QFuture<std::vector<DonationRecord>> getDonationsForDonor(int donorId);
+
+    // The worker's connection caches donors (DonationTracker::setDonorCacheCapacity) but
+    // does not see writes made through other connections. Report them here; the request is
+    // queued, so it takes effect before any lookup submitted after it.
+    void invalidateDonor(int donorId); // After a donor, or one of their donations, changed.
+    void invalidateDonorCache(); // After changes that may touch any donor (e.g. an import).
+
+    /**
+     * @brief Queues an arbitrary job against the worker's connection.
+     * The job runs on the worker thread; it is skipped if the future is canceled first.
+     * @param job Function computing the result from the worker's DonationTracker.
+     * @return Future that receives the job's result.
+     */
+    template <typename T>
+    QFuture<T> submit(std::function<T(DonationTracker&)> job);
+
+    /**
+     * @brief Runs a job on a pooled read-only connection, concurrently with the queue and
+     * with other parallel jobs (at most one per core). The connection has no donor cache.
+     * Jobs are not ordered relative to submit() requests or to each other.
+     * @param job Function computing the result from a pooled DonationTracker.
+     * @return Future that receives the job's result; canceled if the worker shuts down first.
+     */
+    template <typename T>
+    QFuture<T> submitParallel(std::function<T(DonationTracker&)> job);
+
+private:
+    void post(std::function<void(DonationTracker*)> request); // Appends to the queue and wakes the thread.
+    void run(); // Worker thread body.
+    void startParallel(std::function<void(DonationTracker*)> job); // Runs job on the pool threads.
+
+    std::string dbPath; // Database file opened by the worker thread.
+    QThread* thread; // The worker thread.
+    QMutex queueMutex; // Guards queue and stopping.
+    QWaitCondition queueNotEmpty; // Signalled by post() and the destructor.
+    // Pending requests. Each is called with the worker's tracker, or with nullptr to
+    // cancel it during shutdown.
+    std::deque<std::function<void(DonationTracker*)>> queue;
+    bool stopping; // Set by the destructor.
+    ConnectionPool readers; // Connections for submitParallel jobs.
+    QThreadPool* parallelThreads; // One thread per pooled connection.
+};
+
+template <typename T>
+QFuture<T> DatabaseWorker::submit(std::function<T(DonationTracker&)> job) {
+    auto promise = std::make_shared<QFutureInterface<T>>();
+    promise->reportStarted();
+    post([promise, job](DonationTracker* tracker) {
+        if (tracker && !promise->isCanceled()) {
+            // Canceling the future also abandons the query mid-statement.
+            tracker->setCancelCheck([promise]() { return promise->isCanceled(); });
+            T result = job(*tracker);
+            tracker->setCancelCheck(nullptr);
+            promise->reportResult(result);
+        } else {
+            promise->reportCanceled(); // Superseded by the caller, or the worker is shutting down.
+        }
+        promise->reportFinished();
+    });
+    return promise->future();
+}
+
+template <typename T>
+QFuture<T> DatabaseWorker::submitParallel(std::function<T(DonationTracker&)> job) {
+    auto promise = std::make_shared<QFutureInterface<T>>();
+    promise->reportStarted();
+    startParallel([promise, job](DonationTracker* tracker) {
+        if (tracker && !promise->isCanceled()) {
+            tracker->setCancelCheck([promise]() { return promise->isCanceled(); });
+            T result = job(*tracker);
+            tracker->setCancelCheck(nullptr);
+            promise->reportResult(result);
+        } else {
+            promise->reportCanceled();
+        }
+        promise->reportFinished();
+    });
+    return promise->future();
+}
+
+#endif // DATABASE_WORKER_H
@@ -0,0 +1,71 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donation_columns.h
+#ifndef DONATION_COLUMNS_H
+#define DONATION_COLUMNS_H
+
+#include "money.h" // Cents.
+#include <cstddef> // std::size_t.
+#include <cstdint> // Fixed-width column types.
+#include <vector> // Column storage.
+
+/**
+ * @brief Per-month donation counts and totals, as computed by DonationColumns::monthHistogram.
+ * Index 0 is January.
+ */
+struct MonthHistogram {
+    std::int64_t counts[12] = {};
+    Cents totals[12] = {};
+};
+
+/**
+ * @brief The donations table loaded as parallel, contiguous arrays for in-process aggregation.
+ * Row i of the table is (donorIds[i], amountCents[i], years[i], months[i]). Loaded by
+ * DonationTracker::loadDonationColumns. The aggregate kernels are plain loops over the
+ * arrays without data-dependent branches, so the compiler can vectorize them; all sums are
+ * exact 64-bit integer cents.
+ *
+ * Every kernel takes a year filter; 0 means all years.
+ */
+struct DonationColumns {
+    std::vector<std::int32_t> donorIds;
+    std::vector<Cents> amountCents;
+    std::vector<std::int16_t> years; // Donation year (0 if unknown).
+    std::vector<std::int8_t> months; // 1-12 (0 if unknown).
+
+    std::size_t size() const { return amountCents.size(); }
+    void clear(); // Drops all rows and releases their memory.
+    void reserve(std::size_t rows);
+
+    Cents sumCents(int year = 0) const; // Sum of the amounts.
+    std::size_t count(int year = 0) const; // Number of donations.
+    MonthHistogram monthHistogram(int year = 0) const; // Counts and sums per calendar month.
+
+    /**
+     * @brief Counts donations per amount band.
+     * @param upperBounds Ascending band limits in cents. Band k holds amounts below
+     *        upperBounds[k] (and at or above upperBounds[k-1]); the last band holds the rest.
+     * @param year Year filter (0 for all years).
+     * @return upperBounds.size() + 1 counts.
+     */
+    std::vector<std::size_t> amountHistogram(const std::vector<Cents>& upperBounds, int year = 0) const;
+};
+
+#endif // DONATION_COLUMNS_H
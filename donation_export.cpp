@@ -0,0 +1,153 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donation_export.cpp
+// Implementation of ExportWriter, the buffered CSV/NDJSON formatter behind
+// DonationTracker::exportRows.
+
+#include "donation_export.h"
+
+ExportWriter::ExportWriter(ExportFormat format)
+    : format(format), column(0), rows(0) {
+}
+
+/**
+ * @brief Opens the output and writes the CSV header line.
+ */
+bool ExportWriter::open(const std::string& path, bool gzip, const std::vector<const char*>& columns, std::string* error) {
+    bool opened = path == "-" ? out.openStdout(gzip, error) : out.open(QString::fromStdString(path), gzip, error);
+    if (!opened) {
+        return false;
+    }
+
+    keys.clear();
+    for (const char* name : columns) {
+        keys.push_back(std::string("\"") + name + "\":");
+    }
+    if (format == ExportFormat::Csv) {
+        for (std::size_t i = 0; i < columns.size(); ++i) {
+            if (i > 0) {
+                out.append(',');
+            }
+            out.append(columns[i]);
+        }
+        out.append("\r\n");
+    }
+    return true;
+}
+
+void ExportWriter::beginRow() {
+    column = 0;
+    if (format == ExportFormat::NdJson) {
+        out.append('{');
+    }
+}
+
+void ExportWriter::beginValue() {
+    if (column > 0) {
+        out.append(',');
+    }
+    if (format == ExportFormat::NdJson) {
+        out.append(keys[column]);
+    }
+    ++column;
+}
+
+void ExportWriter::addInt(std::int64_t value) {
+    beginValue();
+    out.append(std::to_string(value));
+}
+
+void ExportWriter::addCents(Cents value) {
+    beginValue();
+    out.append(formatCents(value)); // A bare decimal is a valid JSON number too.
+}
+
+void ExportWriter::addNull() {
+    beginValue();
+    if (format == ExportFormat::NdJson) {
+        out.append("null");
+    }
+}
+
+/**
+ * @brief Appends a text value, quoted for CSV only when it contains a separator, quote or
+ * line break, and escaped as a JSON string for NDJSON.
+ */
+void ExportWriter::addText(const char* text, std::size_t size) {
+    if (!text) {
+        addNull();
+        return;
+    }
+    beginValue();
+    if (format == ExportFormat::Csv) {
+        bool quote = false;
+        for (std::size_t i = 0; i < size && !quote; ++i) {
+            char c = text[i];
+            quote = c == ',' || c == '"' || c == '\n' || c == '\r';
+        }
+        if (!quote) {
+            out.append(text, size);
+            return;
+        }
+        out.append('"');
+        for (std::size_t i = 0; i < size; ++i) {
+            if (text[i] == '"') {
+                out.append('"');
+            }
+            out.append(text[i]);
+        }
+        out.append('"');
+        return;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    out.append('"');
+    for (std::size_t i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        switch (c) {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            if (c < 0x20) {
+                out.append("\\u00");
+                out.append(hex[c >> 4]);
+                out.append(hex[c & 0xF]);
+            } else {
+                out.append(static_cast<char>(c)); // UTF-8 passes through unchanged.
+            }
+        }
+    }
+    out.append('"');
+}
+
+void ExportWriter::endRow() {
+    out.append(format == ExportFormat::NdJson ? "}\n" : "\r\n");
+    ++rows;
+}
+
+/**
+ * @brief Flushes, finishes the gzip stream and closes the output.
+ */
+bool ExportWriter::close(std::string* error) {
+    return out.close(error);
+}
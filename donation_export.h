@@ -0,0 +1,111 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donation_export.h
+#ifndef DONATION_EXPORT_H
+#define DONATION_EXPORT_H
+
+#include "buffered_output.h" // The output file (or stdout).
+#include "money.h" // Cents.
+#include <cstddef> // std::size_t.
+#include <cstdint> // Row and byte counters.
+#include <string> // Paths and filters.
+#include <vector> // Donor filter and column names.
+
+// Which table an export reads.
+enum class ExportTable {
+    Donations, // One row per donation, with the donor's name.
+    Donors // One row per donor, with address and contact fields.
+};
+
+// Text format of an export.
+enum class ExportFormat {
+    Csv, // RFC 4180: a header line, then comma-separated rows; fields quoted when needed.
+    NdJson // One JSON object per line, keyed by column name.
+};
+
+/**
+ * @brief What DonationTracker::exportRows writes and where.
+ */
+struct ExportOptions {
+    ExportTable table = ExportTable::Donations;
+    ExportFormat format = ExportFormat::Csv;
+    bool gzip = false; // Compress the output as a .gz stream.
+    std::string dateFrom; // Inclusive "YYYY-MM-DD" lower bound on the donation date; empty for none.
+    std::string dateTo; // Inclusive upper bound; empty for none.
+    std::vector<int> donorIds; // Only these donors; empty for all.
+};
+
+/**
+ * @brief Outcome of an export.
+ */
+struct ExportResult {
+    bool ok = false;
+    std::uint64_t rows = 0; // Rows written.
+    std::uint64_t bytes = 0; // Bytes written to the output (after compression).
+    std::string error; // Why the export failed (when !ok).
+};
+
+/**
+ * @brief The ExportWriter class formats rows as CSV or NDJSON into a BufferedOutput,
+ * optionally gzip-compressed. Values are appended one at a time straight from the statement
+ * columns, and the output hands them to the file in BufferedOutput::blockSize blocks, so
+ * memory stays at a few megabytes however large the extract is.
+ */
+class ExportWriter {
+public:
+    explicit ExportWriter(ExportFormat format);
+    ExportWriter(const ExportWriter&) = delete;
+    ExportWriter& operator=(const ExportWriter&) = delete;
+
+    /**
+     * @brief Opens the output and writes the CSV header.
+     * @param path Output file, or "-" for stdout.
+     * @param gzip Compress the output.
+     * @param columns Column names, in the order values are added to each row.
+     */
+    bool open(const std::string& path, bool gzip, const std::vector<const char*>& columns, std::string* error = nullptr);
+
+    // Row values, added in column order between beginRow() and endRow().
+    void beginRow();
+    void addInt(std::int64_t value);
+    void addCents(Cents value); // Written as an exact decimal, e.g. 1234.56.
+    void addText(const char* text, std::size_t size); // UTF-8; nullptr writes a null.
+    void addNull();
+    void endRow();
+
+    /**
+     * @brief Flushes the buffer (and compressor) and closes the output.
+     */
+    bool close(std::string* error = nullptr);
+
+    std::uint64_t rowsWritten() const { return rows; }
+    std::uint64_t bytesWritten() const { return out.bytesWritten(); }
+
+private:
+    void beginValue(); // Separator and, for NDJSON, the key of the next column.
+
+    ExportFormat format;
+    BufferedOutput out;
+    std::vector<std::string> keys; // NDJSON: "\"name\":" per column.
+    std::size_t column; // Index of the next value in the row.
+    std::uint64_t rows;
+};
+
+#endif // DONATION_EXPORT_H
@@ -0,0 +1,2465 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donation_tracker.cpp
+// This file contains the implementation of the DonationTracker class, the SQLite backend
+// shared by the GUI, the background workers and the benchmark.
+
+#include "donation_tracker.h" // DonationTracker declaration and record types.
+#include "letter_generator.h" // Shared letter formatting.
+#include "donation_columns.h" // Targets of loadDonationColumns.
+#include "donation_export.h" // ExportWriter behind exportRows.
+#include "sqlite_row.h" // Borrowed, NULL-safe column text.
+#include "change_sync.h" // Changeset files of pushChanges/applyChangeset.
+#include <QFile>        // For file I/O operations.
+#include <QDir>         // Sync outboxes.
+#include <QFileInfo>    // Changeset sizes.
+#include <QTextStream>  // For reading and writing text.
+#include <QDate>        // For date manipulation.
+#include <QElapsedTimer> // For timing bulk imports.
+#include <QStringList>  // For CSV field splitting.
+#include <mutex>        // Guards the default error sink.
+#include <algorithm>    // std::min/std::max for batch sizes.
+#include <cstdio>       // Query statistics on stderr.
+#include <cstdint>      // Packed donor-pair keys of duplicate detection.
+#include <iterator>     // std::next.
+
+// -----------------------------------------------------------------------------
+// DonationTracker Implementation
+// This section implements the core database logic defined in donation_tracker.h.
+// -----------------------------------------------------------------------------
+
+// Shared by addDonation and the bulk importer so both reuse the same cached statement.
+// donation_year is derived from the bound date (?3) so the year index stays in sync, and the
+// legacy REAL amount column is written from the exact cents (?2) for older readers.
+static const char* const insertDonationSql =
+    "INSERT INTO donations (donor_id, amount_cents, amount, date, payment_method, donation_year) "
+    "VALUES (?1, ?2, ?2 / 100.0, ?3, ?4, CAST(SUBSTR(?3, 1, 4) AS INTEGER));";
+
+// Phone number with the usual separators removed. Spelled out rather than wrapped in a
+// custom SQL function so the expression index also works for connections that never
+// register one; SQLite only uses the index when a query repeats the expression exactly.
+static const char* const phoneDigitsSql =
+    "replace(replace(replace(replace(replace(replace(phone, ' ', ''), '-', ''), '(', ''), ')', ''), '.', ''), '+', '')";
+
+/**
+ * @brief A duplicate-detection blocking key: an indexed expression over donors and the
+ * condition that leaves empty values out of the (partial) index.
+ */
+struct BlockingKey {
+    DuplicateBlock block;
+    const char* index;
+    std::string expression; // One or more comma-separated key columns.
+    std::string condition;
+};
+
+/**
+ * @brief The blocking keys, shared by the schema version 6 indexes and the scans that read them.
+ */
+static std::vector<BlockingKey> blockingKeys() {
+    return {
+        {BlockEmail, "idx_donors_match_email", "lower(trim(email))", "trim(email) <> ''"},
+        {BlockPhone, "idx_donors_match_phone", std::string("substr(") + phoneDigitsSql + ", -10)",
+         std::string("length(") + phoneDigitsSql + ") >= 7"},
+        {BlockNameZip, "idx_donors_match_name_zip", "lower(trim(last_name)), substr(trim(zip), 1, 5)",
+         "trim(last_name) <> '' AND trim(zip) <> ''"},
+    };
+}
+
+/**
+ * @brief A table captured by the change log (schema version 7), with its columns, id first.
+ * Parents come first: pushes write tables in this order, so a donation never reaches the
+ * central copy ahead of its donor.
+ */
+struct SyncTable {
+    const char* name;
+    std::vector<std::string> columns;
+};
+
+static std::vector<SyncTable> syncTables() {
+    return {
+        {"organization", {"id", "name", "address"}},
+        {"donors", {"id", "first_name", "last_name", "street", "city", "state", "zip", "country", "phone", "email"}},
+        {"donations", {"id", "donor_id", "amount", "amount_cents", "date", "payment_method", "donation_year"}},
+    };
+}
+
+/**
+ * @brief Reads a table's pending changes as changeset lines, one per changed row:
+ * {"t":"donors","id":7,"row":{...}} with the row as it is now, or "row":null once deleted.
+ */
+static std::string pushChangesSql(const SyncTable& table) {
+    std::string row;
+    for (const std::string& column : table.columns) {
+        row += (row.empty() ? "'" : ", '") + column + "', t." + column;
+    }
+    return std::string("SELECT json_object('t', '") + table.name + "', 'id', c.row_id, 'row', "
+           "CASE WHEN t.id IS NULL THEN NULL ELSE json_object(" + row + ") END) "
+           "FROM change_log c LEFT JOIN " + table.name + " t ON t.id = c.row_id "
+           "WHERE c.table_name = '" + table.name + "' AND c.seq <= ?1 ORDER BY c.seq;";
+}
+
+/**
+ * @brief Inserts or overwrites the row of a changeset line (?1); a no-op for deletions.
+ */
+static std::string upsertChangeSql(const SyncTable& table) {
+    std::string columns;
+    std::string values;
+    std::string assignments;
+    for (const std::string& column : table.columns) {
+        columns += (columns.empty() ? "" : ", ") + column;
+        values += (values.empty() ? "json_extract(r, '$." : ", json_extract(r, '$.") + column + "')";
+        if (column != "id") {
+            assignments += (assignments.empty() ? "" : ", ") + column + " = excluded." + column;
+        }
+    }
+    // The WHERE clause also keeps ON CONFLICT from being parsed as a join constraint of the SELECT.
+    return std::string("INSERT INTO ") + table.name + " (" + columns + ") SELECT " + values +
+           " FROM (SELECT json_extract(?1, '$.row') AS r) WHERE r IS NOT NULL "
+           "ON CONFLICT (id) DO UPDATE SET " + assignments + ";";
+}
+
+/**
+ * @brief Deletes the row of a changeset line (?1) that records a deletion.
+ */
+static std::string deleteChangeSql(const SyncTable& table) {
+    return std::string("DELETE FROM ") + table.name +
+           " WHERE id = json_extract(?1, '$.id') AND json_extract(?1, '$.row') IS NULL;";
+}
+
+/**
+ * @brief The table a changeset line belongs to: lines start with {"t":"<table>" as
+ * written by json_object in pushChangesSql. Empty for any other line.
+ */
+static std::string changeTable(const std::string& line) {
+    static const std::string prefix = "{\"t\":\"";
+    if (line.compare(0, prefix.size(), prefix) != 0) {
+        return std::string();
+    }
+    std::size_t end = line.find('"', prefix.size());
+    return end == std::string::npos ? std::string() : line.substr(prefix.size(), end - prefix.size());
+}
+
+/**
+ * @brief Fills a donor from a row laid out as id, first_name, ..., email (the donor listings).
+ * copyText reuses the record's string capacity when the caller reuses the record.
+ */
+static void readDonorRecord(sqlite3_stmt* stmt, DonorRecord& donor) {
+    SqliteRow columns(stmt);
+    donor.id = sqlite3_column_int(stmt, 0);
+    columns.copyText(1, donor.firstName);
+    columns.copyText(2, donor.lastName);
+    columns.copyText(3, donor.street);
+    columns.copyText(4, donor.city);
+    columns.copyText(5, donor.state);
+    columns.copyText(6, donor.zip);
+    columns.copyText(7, donor.country);
+    columns.copyText(8, donor.phone);
+    columns.copyText(9, donor.email);
+}
+
+/**
+ * @brief Fills a donor from row i of a batch in the same layout.
+ */
+static void readDonorRecord(const RowBatch& batch, int i, DonorRecord& donor) {
+    donor.id = static_cast<int>(batch.integer(i, 0));
+    batch.copyText(i, 1, donor.firstName);
+    batch.copyText(i, 2, donor.lastName);
+    batch.copyText(i, 3, donor.street);
+    batch.copyText(i, 4, donor.city);
+    batch.copyText(i, 5, donor.state);
+    batch.copyText(i, 6, donor.zip);
+    batch.copyText(i, 7, donor.country);
+    batch.copyText(i, 8, donor.phone);
+    batch.copyText(i, 9, donor.email);
+}
+
+// Sink copied into each new tracker; replaced by the GUI with a message-box sink.
+static std::mutex defaultSinkMutex;
+static ErrorSink defaultSink = [](ErrorSeverity severity, const std::string& title, const std::string& message) {
+    if (severity == ErrorSeverity::Critical) {
+        qCritical().noquote() << QString::fromStdString(title) + ":" << QString::fromStdString(message);
+    } else {
+        qWarning().noquote() << QString::fromStdString(title) + ":" << QString::fromStdString(message);
+    }
+};
+
+/**
+ * @brief Sets the error sink that newly constructed trackers start with.
+ * @param sink The new default sink.
+ */
+void DonationTracker::setDefaultErrorSink(ErrorSink sink) {
+    std::lock_guard<std::mutex> lock(defaultSinkMutex);
+    defaultSink = std::move(sink);
+}
+
+/**
+ * @brief Returns a copy of the current default error sink.
+ */
+ErrorSink DonationTracker::defaultErrorSink() {
+    std::lock_guard<std::mutex> lock(defaultSinkMutex);
+    return defaultSink;
+}
+
+// Profiling options copied into each new tracker.
+static std::mutex defaultProfilingMutex;
+static QueryProfilingOptions defaultProfiling;
+
+/**
+ * @brief Sets the profiling options that newly constructed trackers start with.
+ */
+void DonationTracker::setDefaultQueryProfiling(const QueryProfilingOptions& options) {
+    std::lock_guard<std::mutex> lock(defaultProfilingMutex);
+    defaultProfiling = options;
+}
+
+/**
+ * @brief Returns a copy of the current default profiling options.
+ */
+QueryProfilingOptions DonationTracker::defaultQueryProfiling() {
+    std::lock_guard<std::mutex> lock(defaultProfilingMutex);
+    return defaultProfiling;
+}
+
+/**
+ * @brief Forwards an error report to this tracker's sink, if one is set.
+ */
+void DonationTracker::reportError(ErrorSeverity severity, const char* title, const QString& message) {
+    if (errorSink && !canceledByCheck) { // Failures of deliberately interrupted statements are not errors.
+        errorSink(severity, title, message.toStdString());
+    }
+}
+
+/**
+ * @brief Constructor for DonationTracker.
+ * Initializes the SQLite database connection. If the database file doesn't exist,
+ * it will be created. Critical errors during opening will result in a message box.
+ * Opened read-only, the file is left exactly as it is: no journal mode switch, no
+ * migration and no search index; a file at another schema version is closed again.
+ * @param profile Connection profile applied once the schema is up to date.
+ * @param dbPath Path of the database file (default "donations.db" in the working directory).
+ * @param openMode ReadOnly for connections that must never write to the file.
+ */
+DonationTracker::DonationTracker(ConnectionProfile profile, const std::string& dbPath, OpenMode openMode)
+    : db(nullptr), dbPath(dbPath), profile(profile), openMode(openMode), errorSink(defaultErrorSink()), canceledByCheck(false), ftsAvailable(false), statementCacheHits(0), statementCacheMisses(0),
+      donorCacheCapacity(256), donorCacheHits(0), donorCacheMisses(0) {
+    if (openMode == OpenMode::ReadOnly) {
+        if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+            reportError(ErrorSeverity::Warning, "Database Error", "Cannot open database: " + QString(sqlite3_errmsg(db)));
+            closeConnection();
+            return;
+        }
+        queryProfiler.configure(db, defaultQueryProfiling());
+        int version = getSchemaVersion();
+        if (version != currentSchemaVersion) {
+            reportError(ErrorSeverity::Warning, "Database Error",
+                        QString("%1 is at schema version %2, not %3; it was not read.")
+                            .arg(QString::fromStdString(dbPath)).arg(version).arg(currentSchemaVersion));
+            closeConnection();
+            return;
+        }
+        ensureSearchIndex();
+        applyConnectionProfile(profile);
+        return;
+    }
+    // Attempt to open the SQLite database file (by default "donations.db").
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
+        // If opening fails, display a critical error message.
+        reportError(ErrorSeverity::Critical, "Error", "Cannot open database: " + QString(sqlite3_errmsg(db)));
+    } else {
+        queryProfiler.configure(db, defaultQueryProfiling()); // Before the schema work, so migrations are timed too.
+        // WAL is persistent in the file, so switch before creating tables. Foreign keys stay off
+        // until the profile is applied, because schema migrations may rebuild tables.
+        sqlite3_exec(db, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+        // If successful, create necessary tables.
+        createTables();
+        applyConnectionProfile(profile);
+    }
+}
+
+/**
+ * @brief Destructor for DonationTracker.
+ * Closes the SQLite database connection if it's open.
+ */
+DonationTracker::~DonationTracker() {
+    if (!queryProfiler.options().statsPath.empty()) {
+        dumpQueryStats(queryProfiler.options().statsPath);
+    }
+    closeConnection();
+}
+
+void DonationTracker::closeConnection() {
+    queryProfiler.detach();
+    clearStatementCache(); // Cached statements must be finalized before the connection can close.
+    if (db) {
+        sqlite3_close(db); // Close the database connection.
+        db = nullptr;
+    }
+}
+
+/**
+ * @brief Returns a prepared statement for the given SQL, preparing it only on first use.
+ * Statements are kept for the lifetime of the connection. A cached statement is reset and
+ * has its bindings cleared before it is handed out, so callers can bind and step straight away.
+ * Callers should sqlite3_reset() the statement when done instead of finalizing it.
+ * @param sql The SQL text of the statement; also used as the cache key.
+ * @return The ready-to-bind statement, or nullptr if preparation failed.
+ */
+sqlite3_stmt* DonationTracker::prepareCached(const std::string& sql) {
+    auto it = statementCache.find(sql);
+    if (it != statementCache.end()) {
+        ++statementCacheHits;
+        sqlite3_reset(it->second); // Defensive: a previous caller may have left it mid-step.
+        sqlite3_clear_bindings(it->second); // Start from NULL parameters like a fresh statement.
+        return it->second;
+    }
+
+    ++statementCacheMisses;
+    sqlite3_stmt* stmt = nullptr;
+    // SQLITE_PREPARE_PERSISTENT hints that the statement will be retained and reused many times.
+    if (sqlite3_prepare_v3(db, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(stmt); // Nothing is cached for SQL that fails to prepare.
+        return nullptr;
+    }
+    statementCache.emplace(sql, stmt);
+    return stmt;
+}
+
+/**
+ * @brief Finalizes every cached statement and empties the cache.
+ * The hit/miss counters are left untouched.
+ */
+void DonationTracker::clearStatementCache() {
+    for (auto& entry : statementCache) {
+        sqlite3_finalize(entry.second);
+    }
+    statementCache.clear();
+}
+
+/**
+ * @brief Installs or removes the cancel check polled while statements run.
+ */
+void DonationTracker::setCancelCheck(std::function<bool()> check) {
+    cancelCheck = std::move(check);
+    canceledByCheck = false;
+    if (db) {
+        // 4000 VM steps is a few microseconds of work: responsive, yet the check stays off the profile.
+        sqlite3_progress_handler(db, cancelCheck ? 4000 : 0, cancelCheck ? &DonationTracker::progressCallback : nullptr, this);
+    }
+}
+
+/**
+ * @brief Progress handler: a nonzero return makes SQLite interrupt the running statement.
+ */
+int DonationTracker::progressCallback(void* context) {
+    DonationTracker* tracker = static_cast<DonationTracker*>(context);
+    if (tracker->cancelCheck()) {
+        tracker->canceledByCheck = true;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Applies profiling options to this tracker's connection.
+ */
+void DonationTracker::setQueryProfiling(const QueryProfilingOptions& options) {
+    queryProfiler.configure(db, options);
+}
+
+/**
+ * @brief Appends this tracker's statement statistics to a file or stderr.
+ * The table is written with a single call so that trackers closing at the same time
+ * (e.g. the GUI's and the database worker's) do not interleave their lines.
+ */
+bool DonationTracker::dumpQueryStats(const std::string& path) const {
+    std::string text = "# Query statistics for " + dbPath + " (" + connectionProfileName(profile) + ")\n" +
+                       QueryProfiler::format(queryProfiler.stats());
+    if (path == "-") {
+        return std::fwrite(text.data(), 1, text.size(), stderr) == text.size();
+    }
+    QFile file(QString::fromStdString(path));
+    return file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text) &&
+           file.write(text.data(), static_cast<qint64>(text.size())) == static_cast<qint64>(text.size());
+}
+
+/**
+ * @brief Applies the pragmas for a connection profile.
+ * WAL lets readers run alongside the single writer and makes commits cheap with
+ * synchronous=NORMAL (the WAL is synced at checkpoints, not every commit). Foreign keys
+ * are enabled for every profile so ON DELETE CASCADE is honoured.
+ * @param newProfile The profile to apply.
+ * @return True if all pragmas were applied, false otherwise (reported via message box).
+ */
+bool DonationTracker::applyConnectionProfile(ConnectionProfile newProfile) {
+    std::string sql;
+    switch (newProfile) {
+    case ConnectionProfile::Interactive:
+        sql = "PRAGMA query_only=OFF;"
+              "PRAGMA journal_mode=WAL;"
+              "PRAGMA synchronous=NORMAL;"
+              "PRAGMA foreign_keys=ON;"
+              "PRAGMA cache_size=-16384;" // 16 MiB page cache.
+              "PRAGMA mmap_size=268435456;" // Map up to 256 MiB of the file.
+              "PRAGMA temp_store=MEMORY;"
+              "PRAGMA wal_autocheckpoint=1000;"; // SQLite default, in pages.
+        break;
+    case ConnectionProfile::BulkLoad:
+        // synchronous stays NORMAL: under WAL that already avoids an fsync per commit,
+        // and unlike OFF it cannot corrupt the file on power loss.
+        sql = "PRAGMA query_only=OFF;"
+              "PRAGMA journal_mode=WAL;"
+              "PRAGMA synchronous=NORMAL;"
+              "PRAGMA foreign_keys=ON;"
+              "PRAGMA cache_size=-262144;" // 256 MiB page cache, so index pages stay resident.
+              "PRAGMA mmap_size=1073741824;" // Map up to 1 GiB of the file.
+              "PRAGMA temp_store=MEMORY;"
+              "PRAGMA wal_autocheckpoint=10000;"; // Fewer, larger checkpoints during the load.
+        break;
+    case ConnectionProfile::ReadOnlyReporting:
+        if (openMode == OpenMode::ReadWrite) {
+            sql = "PRAGMA journal_mode=WAL;"; // A read-only file keeps its journal mode; switching would write it.
+        }
+        sql += "PRAGMA synchronous=NORMAL;"
+              "PRAGMA foreign_keys=ON;"
+              "PRAGMA cache_size=-65536;" // 64 MiB page cache.
+              "PRAGMA mmap_size=1073741824;" // Map up to 1 GiB of the file.
+              "PRAGMA temp_store=MEMORY;" // GROUP BY / ORDER BY scratch space in RAM.
+              "PRAGMA query_only=ON;"; // Reject writes on this connection.
+        break;
+    }
+
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        reportError(ErrorSeverity::Warning, "Database Error",
+                             QString("Failed to apply connection profile '%1': %2").arg(connectionProfileName(newProfile)).arg(errMsg));
+        sqlite3_free(errMsg);
+        return false;
+    }
+    profile = newProfile;
+    return true;
+}
+
+/**
+ * @brief Parses a connection profile name.
+ * @param name "interactive", "bulk-load" or "read-only"/"reporting" (case-insensitive).
+ * @param result Receives the parsed profile.
+ * @return True if the name was recognised.
+ */
+bool DonationTracker::connectionProfileFromString(const std::string& name, ConnectionProfile& result) {
+    QString lower = QString::fromStdString(name).trimmed().toLower();
+    if (lower == "interactive") {
+        result = ConnectionProfile::Interactive;
+    } else if (lower == "bulk-load" || lower == "bulk") {
+        result = ConnectionProfile::BulkLoad;
+    } else if (lower == "read-only" || lower == "reporting" || lower == "read-only-reporting") {
+        result = ConnectionProfile::ReadOnlyReporting;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the canonical name for a connection profile.
+ */
+const char* DonationTracker::connectionProfileName(ConnectionProfile profile) {
+    switch (profile) {
+    case ConnectionProfile::Interactive: return "interactive";
+    case ConnectionProfile::BulkLoad: return "bulk-load";
+    case ConnectionProfile::ReadOnlyReporting: return "read-only";
+    }
+    return "interactive";
+}
+
+/**
+ * @brief Creates the necessary tables in the SQLite database if they don't already exist.
+ * This includes 'donors', 'donations', and 'organization' tables.
+ * Once the base tables exist, pending schema migrations are applied.
+ * A database already at currentSchemaVersion has all of them, so opening it skips both and
+ * costs one read of the header.
+ * Errors during table creation are reported via a message box.
+ */
+void DonationTracker::createTables() {
+    if (getSchemaVersion() == currentSchemaVersion) {
+        ensureSearchIndex();
+        return;
+    }
+
+    // SQL statement to create three tables: donors, donations, and organization.
+    // 'donors' table stores donor personal information.
+    // 'donations' table stores donation records, with a foreign key to 'donors' and CASCADE delete.
+    // 'organization' table stores details of the organization (single row).
+    const char* sql = "CREATE TABLE IF NOT EXISTS donors ("
+                      "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                      "first_name TEXT, last_name TEXT, street TEXT, city TEXT, "
+                      "state TEXT, zip TEXT, country TEXT, "
+                      "phone TEXT, email TEXT);"
+                      "CREATE TABLE IF NOT EXISTS donations ("
+                      "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                      "donor_id INTEGER, amount REAL, date TEXT, "
+                      "payment_method TEXT, "
+                      "FOREIGN KEY(donor_id) REFERENCES donors(id) ON DELETE CASCADE);" // Added ON DELETE CASCADE for referential integrity.
+                      "CREATE TABLE IF NOT EXISTS organization ("
+                      "id INTEGER PRIMARY KEY, "
+                      "name TEXT, address TEXT);";
+    char* errMsg = nullptr; // Pointer to store SQLite error messages.
+    // Execute the SQL statement.
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        // If execution fails, display a critical error message.
+        reportError(ErrorSeverity::Critical, "Database Error", QString("SQL error in createTables: %1").arg(errMsg));
+        sqlite3_free(errMsg); // Free the error message memory.
+        return;
+    }
+    migrateSchema(); // Bring older databases up to the current schema version.
+    ensureSearchIndex(); // Full-text donor search, when this SQLite build has FTS5.
+}
+
+/**
+ * @brief Creates the FTS5 donor search index and its sync triggers if they are missing.
+ * donors_fts is an external-content table over donors: it stores only the token index and
+ * reads field values from donors by rowid. Insert/update/delete triggers on donors keep it
+ * current. This is not a numbered migration because it depends on the SQLite build rather
+ * than the file: without FTS5, searches fall back to LIKE scans.
+ */
+void DonationTracker::ensureSearchIndex() {
+    sqlite3_stmt* stmt = prepareCached("SELECT 1 FROM sqlite_master WHERE type='table' AND name='donors_fts';");
+    ftsAvailable = stmt && sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_reset(stmt);
+    if (ftsAvailable || openMode == OpenMode::ReadOnly || !sqlite3_compileoption_used("ENABLE_FTS5")) {
+        return; // Without the index, search falls back to LIKE.
+    }
+
+    const char* sql =
+        "BEGIN IMMEDIATE;"
+        // prefix='2 3' adds prefix indexes so short search-as-you-type prefixes stay cheap.
+        "CREATE VIRTUAL TABLE donors_fts USING fts5("
+        "first_name, last_name, email, phone, city, state, zip, country, "
+        "content='donors', content_rowid='id', prefix='2 3', tokenize='unicode61 remove_diacritics 2');"
+        "CREATE TRIGGER donors_fts_ai AFTER INSERT ON donors BEGIN "
+        "INSERT INTO donors_fts(rowid, first_name, last_name, email, phone, city, state, zip, country) "
+        "VALUES (new.id, new.first_name, new.last_name, new.email, new.phone, new.city, new.state, new.zip, new.country); END;"
+        "CREATE TRIGGER donors_fts_ad AFTER DELETE ON donors BEGIN "
+        "INSERT INTO donors_fts(donors_fts, rowid, first_name, last_name, email, phone, city, state, zip, country) "
+        "VALUES ('delete', old.id, old.first_name, old.last_name, old.email, old.phone, old.city, old.state, old.zip, old.country); END;"
+        "CREATE TRIGGER donors_fts_au AFTER UPDATE ON donors BEGIN "
+        "INSERT INTO donors_fts(donors_fts, rowid, first_name, last_name, email, phone, city, state, zip, country) "
+        "VALUES ('delete', old.id, old.first_name, old.last_name, old.email, old.phone, old.city, old.state, old.zip, old.country); "
+        "INSERT INTO donors_fts(rowid, first_name, last_name, email, phone, city, state, zip, country) "
+        "VALUES (new.id, new.first_name, new.last_name, new.email, new.phone, new.city, new.state, new.zip, new.country); END;"
+        // Rank name matches above email/phone, and those above location fields.
+        "INSERT INTO donors_fts(donors_fts, rank) VALUES ('rank', 'bm25(10.0, 10.0, 5.0, 5.0, 2.0, 1.0, 2.0, 1.0)');"
+        "INSERT INTO donors_fts(donors_fts) VALUES ('rebuild');" // Index existing donors.
+        "COMMIT;";
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to create donor search index: %1").arg(errMsg));
+        sqlite3_free(errMsg);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return;
+    }
+    ftsAvailable = true;
+}
+
+/**
+ * @brief Splits a search term into lower-cased words, the way the FTS tokenizer does:
+ * runs of letters and digits, with everything else acting as a separator.
+ * @param searchTerm The raw search text (e.g., "o'brien 555-12").
+ * @return The words (e.g., {"o", "brien", "555", "12"}).
+ */
+std::vector<std::string> DonationTracker::searchTokens(const std::string& searchTerm) {
+    std::vector<std::string> tokens;
+    // Compatibility decomposition splits each accented letter into its base letter and
+    // combining marks; dropping the marks leaves the folded word.
+    QString term = QString::fromStdString(searchTerm).normalized(QString::NormalizationForm_KD).toLower();
+    QString token;
+    for (QChar c : term) {
+        QChar::Category category = c.category();
+        if (category == QChar::Mark_NonSpacing || category == QChar::Mark_SpacingCombining ||
+            category == QChar::Mark_Enclosing) {
+            continue; // Part of the letter before it, not a separator.
+        }
+        if (c.isLetterOrNumber()) {
+            token += c;
+        } else if (!token.isEmpty()) {
+            tokens.push_back(token.toStdString());
+            token.clear();
+        }
+    }
+    if (!token.isEmpty()) {
+        tokens.push_back(token.toStdString());
+    }
+    return tokens;
+}
+
+/**
+ * @brief Builds an FTS5 MATCH expression requiring every word as a prefix.
+ * Each word is quoted so it cannot be parsed as FTS syntax (AND, NEAR, column filters).
+ * @param tokens Words from searchTokens().
+ * @return e.g. "\"jo\"* \"smi\"*" for {"jo", "smi"}.
+ */
+static std::string ftsPrefixQuery(const std::vector<std::string>& tokens) {
+    std::string query;
+    for (const std::string& token : tokens) {
+        if (!query.empty()) {
+            query += ' ';
+        }
+        query += '"' + token + "\"*"; // Tokens hold only letters/digits, so no quote escaping is needed.
+    }
+    return query;
+}
+
+/**
+ * @brief Reads the schema version stored in the database header (PRAGMA user_version).
+ * A freshly created or pre-migration database reports 0.
+ * @return The stored schema version.
+ */
+int DonationTracker::getSchemaVersion() {
+    int version = 0;
+    sqlite3_stmt* stmt = prepareCached("PRAGMA user_version;");
+    if (stmt && sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_reset(stmt);
+    return version;
+}
+
+/**
+ * @brief Applies one schema migration step inside a transaction.
+ * The step's SQL and the user_version bump commit together, so an interrupted
+ * migration leaves the database at the previous version and is retried on next start.
+ * @param version The schema version the database is at once this step succeeds.
+ * @param sql The migration statements to execute.
+ * @return True if the step was applied, false if it failed and was rolled back.
+ */
+bool DonationTracker::applyMigration(int version, const char* sql) {
+    std::string script = std::string("BEGIN IMMEDIATE;") + sql +
+                         "PRAGMA user_version = " + std::to_string(version) + ";COMMIT;";
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, script.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        reportError(ErrorSeverity::Critical, "Database Error",
+                              QString("Schema migration to version %1 failed: %2").arg(version).arg(errMsg));
+        sqlite3_free(errMsg);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr); // Undo the partial step, if a transaction is open.
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Upgrades the schema step by step from the stored user_version.
+ * Each step runs at most once per database; steps are never edited once released,
+ * new changes are added as a new step at the end (and currentSchemaVersion raised to it).
+ */
+void DonationTracker::migrateSchema() {
+    int version = getSchemaVersion();
+
+    // Version 1: index donations by donor and by an integer year column, so per-donor
+    // lookups and year-end letter runs are index range scans instead of full table scans.
+    // donation_year is written by addDonation/updateDonation from the 'YYYY-MM-DD' date.
+    if (version < 1) {
+        if (!applyMigration(1, "ALTER TABLE donations ADD COLUMN donation_year INTEGER;"
+                               "UPDATE donations SET donation_year = CAST(SUBSTR(date, 1, 4) AS INTEGER);"
+                               "CREATE INDEX IF NOT EXISTS idx_donations_donor_date ON donations(donor_id, date);"
+                               "CREATE INDEX IF NOT EXISTS idx_donations_year_donor ON donations(donation_year, donor_id, amount);")) {
+            return; // Later steps build on this one.
+        }
+    }
+
+    // Version 2: databases created before ON DELETE CASCADE was added to createTables have a
+    // plain foreign key, which makes deleteDonor fail once foreign keys are enforced. Rebuild
+    // the table with the cascading key (SQLite cannot alter a constraint in place), keeping
+    // row IDs and the AUTOINCREMENT high-water mark. Runs with foreign keys still off.
+    if (version < 2) {
+        if (!applyMigration(2, "CREATE TABLE donations_new ("
+                               "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                               "donor_id INTEGER, amount REAL, date TEXT, "
+                               "payment_method TEXT, donation_year INTEGER, "
+                               "FOREIGN KEY(donor_id) REFERENCES donors(id) ON DELETE CASCADE);"
+                               "INSERT INTO donations_new (id, donor_id, amount, date, payment_method, donation_year) "
+                               "SELECT id, donor_id, amount, date, payment_method, donation_year FROM donations;"
+                               "UPDATE sqlite_sequence SET seq = (SELECT seq FROM sqlite_sequence WHERE name = 'donations') "
+                               "WHERE name = 'donations_new' AND seq < (SELECT seq FROM sqlite_sequence WHERE name = 'donations');"
+                               "DROP TABLE donations;"
+                               "ALTER TABLE donations_new RENAME TO donations;"
+                               "CREATE INDEX idx_donations_donor_date ON donations(donor_id, date);"
+                               "CREATE INDEX idx_donations_year_donor ON donations(donation_year, donor_id, amount);")) {
+            return;
+        }
+    }
+
+    // Version 3: index donors in grid order so the paged donor listing is a range scan.
+    // The rowid (id) is implicitly the last key column, which makes the keyset unique.
+    if (version < 3) {
+        if (!applyMigration(3, "CREATE INDEX IF NOT EXISTS idx_donors_name ON donors(first_name, last_name);")) {
+            return;
+        }
+    }
+
+    // Version 4: per-donor yearly totals, kept current by triggers on donations, so letter
+    // runs and totals reports read one row per donor instead of summing every donation.
+    // A donor's row disappears with their last gift of the year (count 0) or with the donor
+    // (cascade). Amounts are rounded to cents on every step so repeated +/- stays exact.
+    if (version < 4) {
+        if (!applyMigration(4, "CREATE TABLE donor_year_totals ("
+                               "donor_id INTEGER NOT NULL REFERENCES donors(id) ON DELETE CASCADE, "
+                               "year INTEGER NOT NULL, donation_count INTEGER NOT NULL, total REAL NOT NULL, "
+                               "PRIMARY KEY (donor_id, year)) WITHOUT ROWID;"
+                               "CREATE INDEX idx_donor_year_totals_year_total ON donor_year_totals(year, total);"
+                               "INSERT INTO donor_year_totals (donor_id, year, donation_count, total) "
+                               "SELECT donor_id, donation_year, COUNT(*), ROUND(SUM(amount), 2) FROM donations "
+                               "WHERE donor_id IS NOT NULL AND donation_year IS NOT NULL GROUP BY donor_id, donation_year;"
+                               "CREATE TRIGGER donations_totals_ai AFTER INSERT ON donations "
+                               "WHEN new.donor_id IS NOT NULL AND new.donation_year IS NOT NULL BEGIN "
+                               "INSERT INTO donor_year_totals (donor_id, year, donation_count, total) "
+                               "VALUES (new.donor_id, new.donation_year, 1, ROUND(new.amount, 2)) "
+                               "ON CONFLICT (donor_id, year) DO UPDATE SET donation_count = donation_count + 1, "
+                               "total = ROUND(total + excluded.total, 2); END;"
+                               "CREATE TRIGGER donations_totals_ad AFTER DELETE ON donations "
+                               "WHEN old.donor_id IS NOT NULL AND old.donation_year IS NOT NULL BEGIN "
+                               "UPDATE donor_year_totals SET donation_count = donation_count - 1, total = ROUND(total - old.amount, 2) "
+                               "WHERE donor_id = old.donor_id AND year = old.donation_year;"
+                               "DELETE FROM donor_year_totals WHERE donor_id = old.donor_id AND year = old.donation_year "
+                               "AND donation_count <= 0; END;"
+                               "CREATE TRIGGER donations_totals_au AFTER UPDATE OF donor_id, amount, donation_year ON donations BEGIN "
+                               "UPDATE donor_year_totals SET donation_count = donation_count - 1, total = ROUND(total - old.amount, 2) "
+                               "WHERE donor_id = old.donor_id AND year = old.donation_year;"
+                               "DELETE FROM donor_year_totals WHERE donor_id = old.donor_id AND year = old.donation_year "
+                               "AND donation_count <= 0;"
+                               "INSERT INTO donor_year_totals (donor_id, year, donation_count, total) "
+                               "SELECT new.donor_id, new.donation_year, 1, ROUND(new.amount, 2) "
+                               "WHERE new.donor_id IS NOT NULL AND new.donation_year IS NOT NULL "
+                               "ON CONFLICT (donor_id, year) DO UPDATE SET donation_count = donation_count + 1, "
+                               "total = ROUND(total + excluded.total, 2); END;")) {
+            return;
+        }
+    }
+
+    // Version 5: store amounts as integer cents so sums are exact. amount_cents is the
+    // source of truth; the REAL amount column is kept as a mirror for older tools. The
+    // totals triggers are rebuilt on cents, and a fallback trigger fills amount_cents for
+    // rows inserted by a writer that only sets amount. The index moves to total_cents so
+    // top-donor and letter reads stay index-only.
+    if (version < 5) {
+        if (!applyMigration(5, "ALTER TABLE donations ADD COLUMN amount_cents INTEGER;"
+                               "UPDATE donations SET amount_cents = CAST(ROUND(amount * 100) AS INTEGER);"
+                               "DROP TRIGGER donations_totals_ai;"
+                               "DROP TRIGGER donations_totals_ad;"
+                               "DROP TRIGGER donations_totals_au;"
+                               "DROP INDEX idx_donor_year_totals_year_total;"
+                               "ALTER TABLE donor_year_totals ADD COLUMN total_cents INTEGER NOT NULL DEFAULT 0;"
+                               "DELETE FROM donor_year_totals;"
+                               "INSERT INTO donor_year_totals (donor_id, year, donation_count, total_cents, total) "
+                               "SELECT donor_id, donation_year, COUNT(*), SUM(amount_cents), SUM(amount_cents) / 100.0 FROM donations "
+                               "WHERE donor_id IS NOT NULL AND donation_year IS NOT NULL GROUP BY donor_id, donation_year;"
+                               "CREATE INDEX idx_donor_year_totals_year_cents ON donor_year_totals(year, total_cents);"
+                               "CREATE TRIGGER donations_cents_ai AFTER INSERT ON donations WHEN new.amount_cents IS NULL BEGIN "
+                               "UPDATE donations SET amount_cents = CAST(ROUND(new.amount * 100) AS INTEGER) WHERE id = new.id; END;"
+                               "CREATE TRIGGER donations_totals_ai AFTER INSERT ON donations "
+                               "WHEN new.donor_id IS NOT NULL AND new.donation_year IS NOT NULL AND new.amount_cents IS NOT NULL BEGIN "
+                               "INSERT INTO donor_year_totals (donor_id, year, donation_count, total_cents, total) "
+                               "VALUES (new.donor_id, new.donation_year, 1, new.amount_cents, new.amount_cents / 100.0) "
+                               "ON CONFLICT (donor_id, year) DO UPDATE SET donation_count = donation_count + 1, "
+                               "total_cents = total_cents + excluded.total_cents, total = (total_cents + excluded.total_cents) / 100.0; END;"
+                               "CREATE TRIGGER donations_totals_ad AFTER DELETE ON donations "
+                               "WHEN old.donor_id IS NOT NULL AND old.donation_year IS NOT NULL AND old.amount_cents IS NOT NULL BEGIN "
+                               "UPDATE donor_year_totals SET donation_count = donation_count - 1, "
+                               "total_cents = total_cents - old.amount_cents, total = (total_cents - old.amount_cents) / 100.0 "
+                               "WHERE donor_id = old.donor_id AND year = old.donation_year;"
+                               "DELETE FROM donor_year_totals WHERE donor_id = old.donor_id AND year = old.donation_year "
+                               "AND donation_count <= 0; END;"
+                               "CREATE TRIGGER donations_totals_au AFTER UPDATE OF donor_id, amount_cents, donation_year ON donations BEGIN "
+                               "UPDATE donor_year_totals SET donation_count = donation_count - 1, "
+                               "total_cents = total_cents - old.amount_cents, total = (total_cents - old.amount_cents) / 100.0 "
+                               "WHERE old.amount_cents IS NOT NULL AND donor_id = old.donor_id AND year = old.donation_year;"
+                               "DELETE FROM donor_year_totals WHERE donor_id = old.donor_id AND year = old.donation_year "
+                               "AND donation_count <= 0;"
+                               "INSERT INTO donor_year_totals (donor_id, year, donation_count, total_cents, total) "
+                               "SELECT new.donor_id, new.donation_year, 1, new.amount_cents, new.amount_cents / 100.0 "
+                               "WHERE new.donor_id IS NOT NULL AND new.donation_year IS NOT NULL AND new.amount_cents IS NOT NULL "
+                               "ON CONFLICT (donor_id, year) DO UPDATE SET donation_count = donation_count + 1, "
+                               "total_cents = total_cents + excluded.total_cents, total = (total_cents + excluded.total_cents) / 100.0; END;")) {
+            return;
+        }
+    }
+
+    // Version 6: expression indexes over the normalized duplicate-detection blocking keys,
+    // partial so that donors without an e-mail, phone or ZIP add nothing to them.
+    if (version < 6) {
+        std::string sql;
+        for (const BlockingKey& key : blockingKeys()) {
+            sql += std::string("CREATE INDEX ") + key.index + " ON donors(" + key.expression + ") WHERE " + key.condition + ";";
+        }
+        if (!applyMigration(6, sql.c_str())) {
+            return;
+        }
+    }
+
+    // Version 7: change capture for incremental sync. Triggers log the ID of every inserted,
+    // updated or deleted row; INSERT OR REPLACE keeps one entry per row and moves it to a new
+    // sequence on each change, so the log holds only what the next push must send, and a
+    // row changed while a push runs is re-logged past it. Existing rows are logged too: the
+    // first push sends the whole database, later ones only what changed. sync_state keeps
+    // the last changeset sequence a central copy has applied.
+    if (version < 7) {
+        std::string sql = "CREATE TABLE change_log (seq INTEGER PRIMARY KEY AUTOINCREMENT, "
+                          "table_name TEXT NOT NULL, row_id INTEGER NOT NULL, UNIQUE (table_name, row_id));"
+                          "CREATE TABLE sync_state (name TEXT PRIMARY KEY, value INTEGER NOT NULL) WITHOUT ROWID;";
+        for (const SyncTable& table : syncTables()) {
+            std::string name = table.name;
+            std::string log = "INSERT OR REPLACE INTO change_log (table_name, row_id) ";
+            sql += "CREATE TRIGGER " + name + "_change_ai AFTER INSERT ON " + name + " BEGIN " +
+                   log + "VALUES ('" + name + "', new.id); END;";
+            sql += "CREATE TRIGGER " + name + "_change_au AFTER UPDATE ON " + name + " BEGIN " +
+                   log + "SELECT '" + name + "', old.id WHERE old.id <> new.id; " +
+                   log + "VALUES ('" + name + "', new.id); END;";
+            sql += "CREATE TRIGGER " + name + "_change_ad AFTER DELETE ON " + name + " BEGIN " +
+                   log + "VALUES ('" + name + "', old.id); END;";
+            sql += "INSERT INTO change_log (table_name, row_id) SELECT '" + name + "', id FROM " + name + ";";
+        }
+        if (!applyMigration(7, sql.c_str())) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Adds a new donor record to the 'donors' table.
+ * Uses a prepared statement to prevent SQL injection and efficiently bind parameters.
+ * @return True on successful insertion, false otherwise.
+ */
+bool DonationTracker::addDonor(const std::string& firstName, const std::string& lastName, const std::string& street, const std::string& city,
+                  const std::string& state, const std::string& zip, const std::string& country,
+                  const std::string& phone, const std::string& email) {
+    const char* sql = "INSERT INTO donors (first_name, last_name, street, city, state, zip, country, phone, email) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);";
+    sqlite3_stmt* stmt = prepareCached(sql); // Cached prepared statement, already reset and unbound.
+    if (stmt) {
+        // Bind parameters to the prepared statement.
+        sqlite3_bind_text(stmt, 1, firstName.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, lastName.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, street.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, city.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 5, state.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 6, zip.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 7, country.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 8, phone.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 9, email.c_str(), -1, SQLITE_TRANSIENT);
+        // Execute the prepared statement.
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            sqlite3_reset(stmt); // Reset the statement so it can be reused from the cache.
+            emit donorAdded(static_cast<int>(sqlite3_last_insert_rowid(db))); // Let views add just this row.
+            return true;
+        } else {
+            // Report failure to add donor.
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to add donor: %1").arg(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_reset(stmt); // Reset even on failure; a no-op if prepare failed (stmt is nullptr).
+    return false;
+}
+
+/**
+ * @brief Updates an existing donor record in the 'donors' table.
+ * @param id The ID of the donor to update.
+ * @return True on successful update, false otherwise.
+ */
+bool DonationTracker::updateDonor(int id, const std::string& firstName, const std::string& lastName, const std::string& street, const std::string& city,
+                     const std::string& state, const std::string& zip, const std::string& country,
+                     const std::string& phone, const std::string& email) {
+    const char* sql = "UPDATE donors SET first_name=?, last_name=?, street=?, city=?, state=?, zip=?, country=?, phone=?, email=? WHERE id=?;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        sqlite3_bind_text(stmt, 1, firstName.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, lastName.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, street.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, city.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 5, state.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 6, zip.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 7, country.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 8, phone.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 9, email.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 10, id); // Bind the ID for the WHERE clause.
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            sqlite3_reset(stmt);
+            if (sqlite3_changes(db) > 0) {
+                invalidateCachedDonor(id);
+                emit donorUpdated(id);
+            }
+            return true;
+        } else {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to update donor: %1").arg(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_reset(stmt);
+    return false;
+}
+
+/**
+ * @brief Deletes a donor record from the 'donors' table based on ID.
+ * Due to ON DELETE CASCADE, related donations in the 'donations' table will also be deleted.
+ * @param id The ID of the donor to delete.
+ * @return True on successful deletion, false otherwise.
+ */
+bool DonationTracker::deleteDonor(int id) {
+    const char* sql = "DELETE FROM donors WHERE id=?;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, id);
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            sqlite3_reset(stmt);
+            if (sqlite3_changes(db) > 0) {
+                invalidateCachedDonor(id);
+                emit donorDeleted(id); // Cascaded donation deletes are implied.
+            }
+            return true;
+        } else {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to delete donor: %1").arg(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_reset(stmt);
+    return false;
+}
+
+/**
+ * @brief Scans each blocking key in index order, collects the distinct pairs found inside
+ * the groups, then loads just the donors involved and scores the pairs.
+ */
+DedupResult DonationTracker::findDuplicateDonors(const DedupOptions& options) {
+    DedupResult result;
+    QElapsedTimer timer;
+    timer.start();
+
+    // Pair (lower ID << 32 | higher ID) -> blocking keys it shares.
+    std::unordered_map<std::uint64_t, unsigned> pairBlocks;
+    std::vector<int> group;
+    auto closeGroup = [&](unsigned block) {
+        if (group.size() >= 2) {
+            ++result.blocks;
+            if (static_cast<int>(group.size()) > options.maxBlockSize) {
+                ++result.skippedBlocks;
+            } else {
+                for (std::size_t i = 0; i < group.size(); ++i) {
+                    for (std::size_t j = i + 1; j < group.size(); ++j) { // IDs ascend within a group.
+                        pairBlocks[static_cast<std::uint64_t>(group[i]) << 32 | static_cast<std::uint32_t>(group[j])] |= block;
+                    }
+                }
+            }
+        }
+        group.clear();
+    };
+
+    for (const BlockingKey& key : blockingKeys()) {
+        std::string sql = "SELECT " + key.expression + ", id FROM donors WHERE " + key.condition +
+                          " ORDER BY " + key.expression + ", id;";
+        sqlite3_stmt* stmt = prepareCached(sql);
+        if (!stmt) {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to scan donor keys: %1").arg(sqlite3_errmsg(db)));
+            continue;
+        }
+        SqliteRow columns(stmt);
+        int keyColumns = sqlite3_column_count(stmt) - 1;
+        std::string current;
+        std::string value;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            value.clear();
+            for (int i = 0; i < keyColumns; ++i) {
+                TextView text = columns.text(i);
+                value.append(text.data, text.size).push_back('\x1f');
+            }
+            if (value != current) {
+                closeGroup(key.block);
+                current.swap(value);
+            }
+            group.push_back(sqlite3_column_int(stmt, keyColumns));
+        }
+        closeGroup(key.block);
+        if (rc != SQLITE_DONE) {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to scan donor keys: %1").arg(sqlite3_errmsg(db)));
+        }
+        sqlite3_reset(stmt);
+    }
+
+    std::vector<CandidatePair> pairs;
+    pairs.reserve(pairBlocks.size());
+    std::string ids = "[";
+    std::unordered_map<int, DonorRecord> donors;
+    for (const auto& entry : pairBlocks) {
+        CandidatePair pair;
+        pair.firstId = static_cast<int>(entry.first >> 32);
+        pair.secondId = static_cast<int>(entry.first & 0xffffffffu);
+        pair.blocks = entry.second;
+        pairs.push_back(pair);
+        for (int id : {pair.firstId, pair.secondId}) {
+            if (donors.emplace(id, DonorRecord()).second) {
+                ids += (ids.size() > 1 ? "," : "") + std::to_string(id);
+            }
+        }
+    }
+    ids += "]";
+    result.candidatePairs = pairs.size();
+
+    // Only the candidates are loaded, in one statement.
+    sqlite3_stmt* stmt = prepareCached("SELECT id, first_name, last_name, street, city, state, zip, country, phone, email "
+                                       "FROM donors WHERE id IN (SELECT value FROM json_each(?));");
+    if (stmt && !pairs.empty()) {
+        sqlite3_bind_text(stmt, 1, ids.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            readDonorRecord(stmt, donors[sqlite3_column_int(stmt, 0)]);
+        }
+    }
+    sqlite3_reset(stmt);
+    for (auto it = donors.begin(); it != donors.end();) {
+        it = it->second.id == 0 ? donors.erase(it) : std::next(it); // Gone (or unreadable): its pairs are skipped.
+    }
+
+    result.pairs = DonorMatcher::scorePairs(donors, pairs, options);
+    result.elapsedSeconds = timer.elapsed() / 1000.0;
+    return result;
+}
+
+/**
+ * @brief Merges duplicateId into keepId: fills keepId's empty fields, moves the donations
+ * and deletes the duplicate, all or nothing.
+ */
+bool DonationTracker::mergeDonors(int keepId, int duplicateId) {
+    if (keepId == duplicateId || !executeCached("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+
+    static const std::string fillSql = []() {
+        std::string sql = "UPDATE donors SET ";
+        const char* fields[] = {"first_name", "last_name", "street", "city", "state", "zip", "country", "phone", "email"};
+        for (std::size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+            std::string field = fields[i];
+            sql += (i > 0 ? ", " : "") + field + " = CASE WHEN trim(COALESCE(" + field + ", '')) = '' "
+                   "THEN (SELECT " + field + " FROM donors WHERE id = ?2) ELSE " + field + " END";
+        }
+        return sql + " WHERE id = ?1 AND EXISTS (SELECT 1 FROM donors WHERE id = ?2);";
+    }();
+    const char* steps[] = {
+        fillSql.c_str(),
+        "UPDATE donations SET donor_id = ?1 WHERE donor_id = ?2;",
+        "DELETE FROM donors WHERE id = ?2;",
+    };
+    bool ok = true;
+    for (int i = 0; i < 3 && ok; ++i) {
+        sqlite3_stmt* stmt = prepareCached(steps[i]);
+        int rc = SQLITE_ERROR;
+        if (stmt) {
+            sqlite3_bind_int(stmt, 1, keepId);
+            sqlite3_bind_int(stmt, 2, duplicateId);
+            rc = sqlite3_step(stmt);
+        }
+        if (rc != SQLITE_DONE) {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to merge donors: %1").arg(sqlite3_errmsg(db)));
+            ok = false;
+        } else if (i != 1 && sqlite3_changes(db) != 1) {
+            ok = false; // The fill and the delete each touch one row when both donors exist.
+        }
+        sqlite3_reset(stmt);
+    }
+    if (!ok || !executeCached("COMMIT;")) {
+        executeCached("ROLLBACK;");
+        return false;
+    }
+
+    invalidateCachedDonor(keepId);
+    invalidateCachedDonor(duplicateId);
+    emit donorUpdated(keepId);
+    emit donorDeleted(duplicateId);
+    return true;
+}
+
+/**
+ * @brief Adds a new donation record to the 'donations' table.
+ * @return True on successful insertion, false otherwise.
+ */
+bool DonationTracker::addDonation(int donorId, Cents amountCents, const std::string& date, const std::string& paymentMethod) {
+    sqlite3_stmt* stmt = prepareCached(insertDonationSql);
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, donorId);
+        sqlite3_bind_int64(stmt, 2, amountCents);
+        sqlite3_bind_text(stmt, 3, date.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, paymentMethod.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            sqlite3_reset(stmt);
+            invalidateCachedDonations(donorId);
+            emit donationAdded(static_cast<int>(sqlite3_last_insert_rowid(db)), donorId);
+            return true;
+        } else {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to add donation: %1").arg(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_reset(stmt);
+    return false;
+}
+
+/**
+ * @brief Runs a cached statement that takes no parameters and returns no rows.
+ * @param sql The statement to run (e.g., "BEGIN IMMEDIATE;").
+ * @return True if the statement ran to completion.
+ */
+bool DonationTracker::executeCached(const char* sql) {
+    sqlite3_stmt* stmt = prepareCached(sql);
+    bool ok = stmt && sqlite3_step(stmt) == SQLITE_DONE;
+    sqlite3_reset(stmt);
+    return ok;
+}
+
+/**
+ * @brief Inserts one batch of donations inside a single transaction.
+ * Each row is validated and bound to the shared insert statement. A row that fails
+ * validation or its INSERT is recorded in result.errors; SQLite rolls back only that
+ * statement, so the rest of the batch still commits. If the COMMIT itself fails, the
+ * whole batch is rolled back and every row in it is reported as failed.
+ * @param records Pointer to the first record of the batch.
+ * @param count Number of records in the batch.
+ * @param firstRow Row number reported for records[0] in ImportError entries.
+ * @param result Accumulates counts and errors across batches.
+ */
+void DonationTracker::importDonationBatch(const DonationRecord* records, std::size_t count, std::size_t firstRow,
+                                          ImportResult& result) {
+    if (!executeCached("BEGIN IMMEDIATE;")) {
+        for (std::size_t i = 0; i < count; ++i) {
+            result.errors.push_back({firstRow + i, std::string("Could not start transaction: ") + sqlite3_errmsg(db)});
+        }
+        result.rowsFailed += count;
+        return;
+    }
+
+    sqlite3_stmt* stmt = prepareCached(insertDonationSql);
+    std::size_t errorsBefore = result.errors.size();
+    std::size_t inserted = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const DonationRecord& record = records[i];
+        std::size_t row = firstRow + i;
+        // Validate up front; the GUI dialogs normally guarantee these.
+        if (record.donorId <= 0) {
+            result.errors.push_back({row, "Invalid donor ID: " + std::to_string(record.donorId)});
+            continue;
+        }
+        if (record.amountCents < 0) {
+            result.errors.push_back({row, "Invalid amount: " + formatCents(record.amountCents)});
+            continue;
+        }
+        if (!QDate::fromString(QString::fromStdString(record.date), "yyyy-MM-dd").isValid()) {
+            result.errors.push_back({row, "Invalid date (expected YYYY-MM-DD): " + record.date});
+            continue;
+        }
+        if (!stmt) {
+            result.errors.push_back({row, std::string("Failed to prepare insert: ") + sqlite3_errmsg(db)});
+            continue;
+        }
+
+        sqlite3_reset(stmt); // Rebind the same statement for each row.
+        sqlite3_bind_int(stmt, 1, record.donorId);
+        sqlite3_bind_int64(stmt, 2, record.amountCents);
+        sqlite3_bind_text(stmt, 3, record.date.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, record.paymentMethod.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            ++inserted;
+        } else {
+            result.errors.push_back({row, sqlite3_errmsg(db)});
+        }
+    }
+    sqlite3_reset(stmt);
+
+    if (executeCached("COMMIT;")) {
+        result.rowsImported += inserted;
+        for (std::size_t i = 0; i < count && !donorCache.empty(); ++i) {
+            invalidateCachedDonations(records[i].donorId);
+        }
+        result.rowsFailed += result.errors.size() - errorsBefore;
+    } else {
+        std::string reason = std::string("Batch rolled back, commit failed: ") + sqlite3_errmsg(db);
+        executeCached("ROLLBACK;");
+        result.errors.resize(errorsBefore); // Replace per-row errors with one entry per row in the batch.
+        for (std::size_t i = 0; i < count; ++i) {
+            result.errors.push_back({firstRow + i, reason});
+        }
+        result.rowsFailed += count;
+    }
+}
+
+/**
+ * @brief Inserts a vector of donations in transactions of batchSize rows.
+ * @return The import result; ImportError::row is the 1-based index into records.
+ */
+ImportResult DonationTracker::importDonations(const std::vector<DonationRecord>& records, int batchSize) {
+    ImportResult result;
+    QElapsedTimer timer;
+    timer.start();
+    ConnectionProfile previousProfile = profile;
+    if (previousProfile == ConnectionProfile::Interactive) {
+        applyConnectionProfile(ConnectionProfile::BulkLoad); // Run the load with the bulk cache settings.
+    }
+
+    std::size_t step = static_cast<std::size_t>(std::max(batchSize, 1));
+    for (std::size_t offset = 0; offset < records.size(); offset += step) {
+        std::size_t count = std::min(step, records.size() - offset);
+        importDonationBatch(records.data() + offset, count, offset + 1, result);
+    }
+
+    if (profile != previousProfile) {
+        applyConnectionProfile(previousProfile);
+    }
+    result.elapsedSeconds = timer.nsecsElapsed() / 1e9;
+    if (result.rowsImported > 0) {
+        emit donationsImported(static_cast<int>(result.rowsImported)); // One notification per import, not per row.
+    }
+    return result;
+}
+
+/**
+ * @brief Splits one CSV line into fields, honouring double-quoted fields and "" escapes.
+ * @param line The line to split (without the trailing newline).
+ * @return The unquoted field values.
+ */
+static QStringList splitCsvLine(const QString& line) {
+    QStringList fields;
+    QString field;
+    bool inQuotes = false;
+    for (int i = 0; i < line.size(); ++i) {
+        QChar c = line.at(i);
+        if (inQuotes) {
+            if (c == '"') {
+                if (i + 1 < line.size() && line.at(i + 1) == '"') {
+                    field += '"'; // Escaped quote inside a quoted field.
+                    ++i;
+                } else {
+                    inQuotes = false;
+                }
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            inQuotes = true;
+        } else if (c == ',') {
+            fields.append(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.append(field);
+    return fields;
+}
+
+/**
+ * @brief Streams a CSV file of donations into the database, one batch at a time.
+ * Malformed lines are reported by line number alongside rows rejected by the database.
+ * @return The import result; ImportError::row is the line number in the file.
+ */
+ImportResult DonationTracker::importDonationsCsv(const std::string& path, int batchSize) {
+    ImportResult result;
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        result.errors.push_back({0, "Could not open file: " + file.errorString().toStdString()});
+        return result;
+    }
+
+    ConnectionProfile previousProfile = profile;
+    if (previousProfile == ConnectionProfile::Interactive) {
+        applyConnectionProfile(ConnectionProfile::BulkLoad); // Run the load with the bulk cache settings.
+    }
+
+    std::size_t step = static_cast<std::size_t>(std::max(batchSize, 1));
+    std::vector<DonationRecord> batch;
+    batch.reserve(step);
+    std::size_t batchFirstLine = 0; // Line number of batch[0].
+    std::size_t lastBatchLine = 0; // Line number of batch.back(), to detect gaps from skipped lines.
+
+    // Rows are reported by line number, so a batch must cover consecutive lines; flush early
+    // whenever a skipped (bad, blank or header) line breaks the run.
+    auto flush = [&]() {
+        if (!batch.empty()) {
+            importDonationBatch(batch.data(), batch.size(), batchFirstLine, result);
+            batch.clear();
+        }
+    };
+
+    QTextStream in(&file);
+    QString line;
+    std::size_t lineNumber = 0;
+    while (in.readLineInto(&line)) {
+        ++lineNumber;
+        if (line.trimmed().isEmpty()) {
+            continue;
+        }
+        QStringList fields = splitCsvLine(line);
+        bool donorOk = false;
+        bool amountOk = false;
+        int donorId = fields.size() > 0 ? fields[0].trimmed().toInt(&donorOk) : 0;
+        Cents amountCents = 0;
+        if (fields.size() > 1) {
+            amountOk = parseCents(fields[1].trimmed().toStdString(), amountCents); // Exact; no double round trip.
+        }
+        if (lineNumber == 1 && !donorOk) {
+            continue; // Header line.
+        }
+        if (fields.size() != 4 || !donorOk || !amountOk) {
+            result.errors.push_back({lineNumber, "Malformed line (expected donor_id,amount,date,payment_method): " +
+                                                 line.toStdString()});
+            ++result.rowsFailed;
+            continue;
+        }
+
+        if (!batch.empty() && lineNumber != lastBatchLine + 1) {
+            flush();
+        }
+        if (batch.empty()) {
+            batchFirstLine = lineNumber;
+        }
+        DonationRecord record;
+        record.donorId = donorId;
+        record.amountCents = amountCents;
+        record.date = fields[2].trimmed().toStdString();
+        record.paymentMethod = fields[3].trimmed().toStdString();
+        batch.push_back(std::move(record));
+        lastBatchLine = lineNumber;
+        if (batch.size() >= step) {
+            flush();
+        }
+    }
+    flush();
+
+    if (profile != previousProfile) {
+        applyConnectionProfile(previousProfile);
+    }
+    result.elapsedSeconds = timer.nsecsElapsed() / 1e9;
+    if (result.rowsImported > 0) {
+        emit donationsImported(static_cast<int>(result.rowsImported)); // One notification per import, not per row.
+    }
+    return result;
+}
+
+/**
+ * @brief Updates an existing donation record in the 'donations' table.
+ * @param id The ID of the donation to update.
+ * @return True on successful update, false otherwise.
+ */
+bool DonationTracker::updateDonation(int id, int donorId, Cents amountCents, const std::string& date, const std::string& paymentMethod) {
+    const char* sql = "UPDATE donations SET donor_id=?1, amount_cents=?2, amount=?2 / 100.0, date=?3, payment_method=?4, "
+                      "donation_year=CAST(SUBSTR(?3, 1, 4) AS INTEGER) WHERE id=?5;";
+    // The donation may move to another donor; both donors' cached lists go stale.
+    int previousDonorId = queryInt("SELECT donor_id FROM donations WHERE id=?;", &id, -1);
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, donorId);
+        sqlite3_bind_int64(stmt, 2, amountCents);
+        sqlite3_bind_text(stmt, 3, date.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, paymentMethod.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 5, id);
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            sqlite3_reset(stmt);
+            if (sqlite3_changes(db) > 0) {
+                invalidateCachedDonations(previousDonorId);
+                invalidateCachedDonations(donorId);
+                emit donationUpdated(id, donorId);
+            }
+            return true;
+        } else {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to update donation: %1").arg(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_reset(stmt);
+    return false;
+}
+
+/**
+ * @brief Deletes a donation record from the 'donations' table.
+ * @param id The ID of the donation to delete.
+ * @return True on successful deletion, false otherwise.
+ */
+bool DonationTracker::deleteDonation(int id) {
+    const char* sql = "DELETE FROM donations WHERE id=?;";
+    int donorId = queryInt("SELECT donor_id FROM donations WHERE id=?;", &id, -1); // For cache invalidation.
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, id);
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            sqlite3_reset(stmt);
+            if (sqlite3_changes(db) > 0) {
+                invalidateCachedDonations(donorId);
+                emit donationDeleted(id);
+            }
+            return true;
+        } else {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to delete donation: %1").arg(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_reset(stmt);
+    return false;
+}
+
+/**
+ * @brief Retrieves the organization's name and address from the 'organization' table.
+ * Assumes there is only one organization record with id=1.
+ * @param name Reference to a string to store the retrieved name.
+ * @param address Reference to a string to store the retrieved address.
+ * @return True if details are found, false otherwise.
+ */
+bool DonationTracker::getOrganizationDetails(std::string& name, std::string& address) {
+    const char* sql = "SELECT name, address FROM organization WHERE id=1;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            // Retrieve data from the current row (NULL columns read as empty).
+            SqliteRow columns(stmt);
+            columns.copyText(0, name);
+            columns.copyText(1, address);
+            sqlite3_reset(stmt);
+            return true;
+        }
+    }
+    sqlite3_reset(stmt);
+    return false;
+}
+
+/**
+ * @brief Sets or updates the organization's details in the 'organization' table.
+ * Uses INSERT OR REPLACE to either insert a new record or update an existing one (for id=1).
+ * @param name The organization's name.
+ * @param address The organization's address.
+ * @return True on successful operation, false otherwise.
+ */
+bool DonationTracker::setOrganizationDetails(const std::string& name, const std::string& address) {
+    const char* sql = "INSERT OR REPLACE INTO organization (id, name, address) VALUES (1, ?, ?);";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, address.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            sqlite3_reset(stmt);
+            return true;
+        } else {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to set organization details: %1").arg(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_reset(stmt);
+    return false;
+}
+
+/**
+ * @brief Generates donation letters for the donors selected for the specified year.
+ * Creates a "letters" directory and saves each letter as a text file. This runs on the calling
+ * thread; the GUI uses LetterGenerator instead, which writes the same letters in parallel.
+ * @param year The year for which to aggregate donations and generate letters.
+ * @param selection Minimum total and letter order; the batches are written one after another.
+ * @return True if all letters were successfully generated, false if any error occurred.
+ */
+bool DonationTracker::generateDonationLetters(int year, const LetterTemplate* letterTemplate, LetterSinkKind sinkKind,
+                                              const ReceiptSelection& selection) {
+    const LetterTemplate& letter = letterTemplate ? *letterTemplate : LetterTemplate::thankYou();
+    std::unique_ptr<LetterSink> sink = LetterSink::create(sinkKind, LetterSink::outputPath(sinkKind, "letters", year));
+    std::string sinkError;
+    if (!sink->open(&sinkError)) {
+        reportError(ErrorSeverity::Warning, "File Error", QString::fromStdString(sinkError));
+        return false;
+    }
+
+    std::string orgName, orgAddress;
+    getOrganizationDetails(orgName, orgAddress); // Get organization details for the letterhead, once per run.
+
+    LetterContext context;
+    context.orgName = orgName;
+    context.orgAddress = orgAddress;
+    context.dateLine = QDate::currentDate().toString("MMMM d, yyyy").toStdString(); // Current date.
+    context.year = year;
+
+    // The planner selects and orders the letters; batches arrive in order and are written as they come.
+    bool success = true; // Flag to track overall success.
+    std::string text; // Reused for every letter.
+    std::string planError;
+    LetterRow row; // Reused for every letter, so the name and address fields keep their capacity.
+    ReceiptSelection selected = selection;
+    selected.lapsedOnly = selection.lapsedOnly || letter.lapsedDonorsOnly(); // The letter decides who it is for.
+    bool planned = ReceiptPlanner::plan(db, year, selected, [&](ReceiptBatch& batch) {
+        for (int i = 0; i < batch.size(); ++i) {
+            batch.letter(i, row);
+            letter.render(row, context, text); // Same text as the background generator.
+            if (!sink->write(LetterGenerator::letterFileName(row, year, letter.fileSuffix()), text, &sinkError)) {
+                // Report error if the letter could not be written.
+                reportError(ErrorSeverity::Warning, "File Error", QString::fromStdString(sinkError));
+                success = false; // Mark overall process as failed.
+            }
+        }
+        return true;
+    }, &planError);
+    if (!planned) {
+        reportError(ErrorSeverity::Warning, "Database Error", QString::fromStdString(planError));
+        success = false;
+    }
+    if (!sink->close(&sinkError)) {
+        reportError(ErrorSeverity::Warning, "File Error", QString::fromStdString(sinkError));
+        success = false;
+    }
+    return success;
+}
+
+/**
+ * @brief Retrieves the full details of a specific donor by their ID.
+ * @param id The ID of the donor to retrieve.
+ * @param firstName Output parameter for donor's first name.
+ * @param lastName Output parameter for donor's last name.
+ * @param street Output parameter for donor's street address.
+ * @param city Output parameter for donor's city.
+ * @param state Output parameter for donor's state.
+ * @param zip Output parameter for donor's ZIP code.
+ * @param country Output parameter for donor's country.
+ * @param phone Output parameter for donor's phone number.
+ * @param email Output parameter for donor's email.
+ * @return True if donor details were found, false otherwise.
+ */
+bool DonationTracker::getDonorDetails(int id, std::string& firstName, std::string& lastName, std::string& street, std::string& city,
+                                     std::string& state, std::string& zip, std::string& country,
+                                     std::string& phone, std::string& email) {
+    DonorRecord donor;
+    if (!getDonorRecord(id, donor)) {
+        return false;
+    }
+    // The record is a local copy, so its strings can be moved out.
+    firstName = std::move(donor.firstName);
+    lastName = std::move(donor.lastName);
+    street = std::move(donor.street);
+    city = std::move(donor.city);
+    state = std::move(donor.state);
+    zip = std::move(donor.zip);
+    country = std::move(donor.country);
+    phone = std::move(donor.phone);
+    email = std::move(donor.email);
+    return true;
+}
+
+/**
+ * @brief Ends a listing whose page could not be read, so paging loops stop instead of
+ * asking for the same page again.
+ */
+static void endFailedListing(DonorPageCursor& cursor) {
+    cursor.started = true;
+    cursor.atEnd = true;
+    cursor.failed = true;
+}
+
+/**
+ * @brief Fetches one page of donors as records the caller keeps (the GUI model's rows).
+ * @param cursor Listing position, updated to the last row returned.
+ * @param limit Maximum number of rows to return.
+ * @return The page of donors.
+ */
+std::vector<DonorRecord> DonationTracker::fetchDonorPage(DonorPageCursor& cursor, int limit) {
+    RowBatch batch;
+    fetchDonorBatch(cursor, limit, batch);
+    std::vector<DonorRecord> page(static_cast<std::size_t>(batch.size()));
+    for (int i = 0; i < batch.size(); ++i) {
+        readDonorRecord(batch, i, page[i]);
+    }
+    return page;
+}
+
+/**
+ * @brief Fetches one page of donors in (first_name, last_name, id) order.
+ * The first page starts at the beginning of the index; later pages resume strictly after
+ * the cursor's last key, which idx_donors_name serves as a range scan. The statement is
+ * reset before returning, so no read transaction is left open between pages.
+ */
+void DonationTracker::fetchDonorBatch(DonorPageCursor& cursor, int limit, RowBatch& batch) {
+    batch.clear();
+    if (cursor.atEnd || limit <= 0) {
+        return;
+    }
+
+    if (ftsAvailable && !cursor.searchTerm.empty()) {
+        std::vector<std::string> tokens = searchTokens(cursor.searchTerm);
+        if (!tokens.empty()) {
+            fetchRankedDonorBatch(cursor, tokens, limit, batch);
+            return;
+        }
+        // Only punctuation was typed: list everyone, as an empty search does.
+    }
+
+    bool filtered = !ftsAvailable && !cursor.searchTerm.empty(); // LIKE fallback without FTS5.
+    // Four SQL variants (filtered or not, first page or not); each is prepared once and cached.
+    std::string sql = "SELECT id, first_name, last_name, street, city, state, zip, country, phone, email FROM donors";
+    const char* glue = " WHERE ";
+    if (filtered) {
+        sql += glue;
+        sql += "(LOWER(first_name) LIKE ?1 OR LOWER(last_name) LIKE ?1 OR LOWER(email) LIKE ?1 OR LOWER(phone) LIKE ?1 OR "
+               "LOWER(city) LIKE ?1 OR LOWER(state) LIKE ?1 OR LOWER(zip) LIKE ?1 OR LOWER(country) LIKE ?1)";
+        glue = " AND ";
+    }
+    if (cursor.started) {
+        sql += glue;
+        sql += "(first_name, last_name, id) > (?2, ?3, ?4)"; // Resume strictly after the last row returned.
+    }
+    sql += " ORDER BY first_name, last_name, id LIMIT ?5;";
+
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
+        reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to prepare statement for donor page: %1").arg(sqlite3_errmsg(db)));
+        endFailedListing(cursor);
+        return;
+    }
+    if (filtered) {
+        std::string pattern = "%" + QString::fromStdString(cursor.searchTerm).toLower().toStdString() + "%";
+        sqlite3_bind_text(stmt, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    if (cursor.started) {
+        sqlite3_bind_text(stmt, 2, cursor.lastFirstName.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, cursor.lastLastName.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 4, cursor.lastId);
+    }
+    sqlite3_bind_int(stmt, 5, limit);
+
+    int rc = batch.fill(stmt, limit);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to read donor page: %1").arg(sqlite3_errmsg(db)));
+        sqlite3_reset(stmt);
+        endFailedListing(cursor); // Rows read before the error are still returned.
+        return;
+    }
+    sqlite3_reset(stmt);
+
+    cursor.started = true;
+    if (batch.size() < limit) {
+        cursor.atEnd = true;
+    }
+    if (!batch.empty()) {
+        int last = batch.size() - 1;
+        batch.copyText(last, 1, cursor.lastFirstName);
+        batch.copyText(last, 2, cursor.lastLastName);
+        cursor.lastId = static_cast<int>(batch.integer(last, 0));
+    }
+}
+
+/**
+ * @brief Retrieves a single donor as a DonorRecord.
+ * @param id The ID of the donor to retrieve.
+ * @param donor Receives the donor's fields.
+ * @return True if the donor exists, false otherwise.
+ */
+bool DonationTracker::getDonorRecord(int id, DonorRecord& donor) {
+    DonorCacheEntry* entry = findCachedDonor(id);
+    if (entry && entry->hasDonor) {
+        ++donorCacheHits;
+        donor = entry->donor;
+        return true;
+    }
+    ++donorCacheMisses;
+    const char* sql = "SELECT id, first_name, last_name, street, city, state, zip, country, phone, email FROM donors WHERE id=?;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    bool found = false;
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, id);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            readDonorRecord(stmt, donor);
+            found = true;
+        }
+    }
+    sqlite3_reset(stmt);
+    if (found && (entry = cacheDonorEntry(id)) != nullptr) {
+        entry->donor = donor;
+        entry->hasDonor = true;
+    }
+    return found;
+}
+
+/**
+ * @brief Looks up a cached donor and moves it to the front of the recency list.
+ */
+DonationTracker::DonorCacheEntry* DonationTracker::findCachedDonor(int id) {
+    auto it = donorCache.find(id);
+    if (it == donorCache.end()) {
+        return nullptr;
+    }
+    donorCacheOrder.splice(donorCacheOrder.begin(), donorCacheOrder, it->second.position); // O(1), no allocation.
+    return &it->second;
+}
+
+/**
+ * @brief Returns the cache entry for a donor, adding an empty one if needed.
+ * Adding past the capacity evicts the least recently used donor.
+ * @return The entry, or nullptr if the cache is disabled.
+ */
+DonationTracker::DonorCacheEntry* DonationTracker::cacheDonorEntry(int id) {
+    if (donorCacheCapacity == 0) {
+        return nullptr;
+    }
+    if (DonorCacheEntry* entry = findCachedDonor(id)) {
+        return entry;
+    }
+    while (donorCache.size() >= donorCacheCapacity) {
+        donorCache.erase(donorCacheOrder.back());
+        donorCacheOrder.pop_back();
+    }
+    donorCacheOrder.push_front(id);
+    DonorCacheEntry& entry = donorCache[id];
+    entry.position = donorCacheOrder.begin();
+    return &entry;
+}
+
+void DonationTracker::invalidateCachedDonor(int donorId) {
+    auto it = donorCache.find(donorId);
+    if (it != donorCache.end()) {
+        donorCacheOrder.erase(it->second.position);
+        donorCache.erase(it);
+    }
+}
+
+void DonationTracker::invalidateCachedDonations(int donorId) {
+    auto it = donorCache.find(donorId);
+    if (it != donorCache.end()) {
+        std::vector<DonationRecord>().swap(it->second.donations);
+        it->second.hasDonations = false;
+    }
+}
+
+void DonationTracker::clearDonorCache() {
+    donorCache.clear();
+    donorCacheOrder.clear();
+}
+
+void DonationTracker::setDonorCacheCapacity(std::size_t capacity) {
+    donorCacheCapacity = capacity;
+    while (donorCache.size() > donorCacheCapacity) {
+        donorCache.erase(donorCacheOrder.back());
+        donorCacheOrder.pop_back();
+    }
+}
+
+/**
+ * @brief Fetches one page of full-text search results, best matches first.
+ * Every search word must match the start of a word in one of the searched fields.
+ * Ranked results have no stable keyset, so pages advance by offset.
+ * @param cursor Listing position; its offset is advanced by the rows returned.
+ * @param tokens The search words, from searchTokens(cursor.searchTerm).
+ * @param limit Maximum number of rows to return.
+ * @param batch Receives the page of donors.
+ */
+void DonationTracker::fetchRankedDonorBatch(DonorPageCursor& cursor, const std::vector<std::string>& tokens, int limit,
+                                            RowBatch& batch) {
+    const char* sql = "SELECT d.id, d.first_name, d.last_name, d.street, d.city, d.state, d.zip, d.country, d.phone, d.email "
+                      "FROM donors_fts JOIN donors d ON d.id = donors_fts.rowid "
+                      "WHERE donors_fts MATCH ? ORDER BY rank LIMIT ? OFFSET ?;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
+        reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to prepare statement for donor search: %1").arg(sqlite3_errmsg(db)));
+        endFailedListing(cursor);
+        return;
+    }
+    std::string query = ftsPrefixQuery(tokens);
+    sqlite3_bind_text(stmt, 1, query.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, limit);
+    sqlite3_bind_int(stmt, 3, cursor.offset);
+
+    int rc = batch.fill(stmt, limit);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to read donor search results: %1").arg(sqlite3_errmsg(db)));
+        sqlite3_reset(stmt);
+        endFailedListing(cursor);
+        return;
+    }
+    sqlite3_reset(stmt);
+
+    cursor.started = true;
+    cursor.ranked = true;
+    cursor.offset += batch.size();
+    if (batch.size() < limit) {
+        cursor.atEnd = true;
+    }
+}
+
+/**
+ * @brief Retrieves all donor IDs from the database, ordered by ID.
+ * This is used for sequential navigation through donor records.
+ * @return A vector of integer donor IDs.
+ */
+std::vector<int> DonationTracker::getAllDonorIds() {
+    std::vector<int> ids; // Vector to store donor IDs.
+    const char* sql = "SELECT id FROM donors ORDER BY id;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        // Iterate through all rows and add each ID to the vector.
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            ids.push_back(sqlite3_column_int(stmt, 0));
+        }
+    }
+    sqlite3_reset(stmt);
+    return ids;
+}
+
+/**
+ * @brief Runs a single-integer query with an optional integer parameter.
+ * @return The value, or fallback if the query returns no row or a NULL.
+ */
+int DonationTracker::queryInt(const char* sql, const int* param, int fallback) {
+    int value = fallback;
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        if (param) {
+            sqlite3_bind_int(stmt, 1, *param);
+        }
+        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+            value = sqlite3_column_int(stmt, 0);
+        }
+    }
+    sqlite3_reset(stmt);
+    return value;
+}
+
+// MIN/MAX on the rowid and the keyset lookups below are single b-tree descents.
+int DonationTracker::firstDonorId() {
+    return queryInt("SELECT MIN(id) FROM donors;", nullptr, -1);
+}
+
+int DonationTracker::lastDonorId() {
+    return queryInt("SELECT MAX(id) FROM donors;", nullptr, -1);
+}
+
+int DonationTracker::nextDonorId(int id) {
+    return queryInt("SELECT id FROM donors WHERE id > ? ORDER BY id LIMIT 1;", &id, -1);
+}
+
+int DonationTracker::prevDonorId(int id) {
+    return queryInt("SELECT id FROM donors WHERE id < ? ORDER BY id DESC LIMIT 1;", &id, -1);
+}
+
+int DonationTracker::donorPosition(int id) {
+    return queryInt("SELECT COUNT(*) FROM donors WHERE id < ?;", &id, 0);
+}
+
+int DonationTracker::donorIdAtPosition(int position) {
+    if (position < 0) {
+        return -1;
+    }
+    return queryInt("SELECT id FROM donors ORDER BY id LIMIT 1 OFFSET ?;", &position, -1);
+}
+
+int DonationTracker::getDonorCount() {
+    return queryInt("SELECT COUNT(*) FROM donors;", nullptr, 0);
+}
+
+/**
+ * @brief Retrieves all donations for a given donor, newest first.
+ * @param donorId The ID of the donor whose donations are to be retrieved.
+ * @return The donations (empty if the donor has none or does not exist).
+ */
+std::vector<DonationRecord> DonationTracker::fetchDonationsForDonor(int donorId) {
+    DonorCacheEntry* entry = findCachedDonor(donorId);
+    if (entry && entry->hasDonations) {
+        ++donorCacheHits;
+        return entry->donations;
+    }
+    ++donorCacheMisses;
+    std::vector<DonationRecord> donations;
+    visitDonationsForDonor(donorId, [&donations](const DonationRecord& donation) {
+        donations.push_back(donation);
+        return true;
+    });
+    // Only cache donors that exist, so probing unknown IDs cannot flush the cache.
+    if (!donations.empty() || entry || queryInt("SELECT 1 FROM donors WHERE id=?;", &donorId, 0)) {
+        entry = cacheDonorEntry(donorId);
+        if (entry) {
+            entry->donations = donations;
+            entry->hasDonations = true;
+        }
+    }
+    return donations;
+}
+
+/**
+ * @brief Streams a donor's donations, newest first, to a visitor.
+ * @param donorId The ID of the donor whose donations are to be visited.
+ * @param visitor Called once per donation; return false to stop early.
+ * @return The number of donations visited.
+ */
+std::size_t DonationTracker::visitDonationsForDonor(int donorId, const std::function<bool(const DonationRecord&)>& visitor) {
+    std::size_t visited = 0;
+    // Served by idx_donations_donor_date, which also yields the rows already in date order.
+    const char* sql = "SELECT id, donor_id, amount_cents, date, payment_method FROM donations WHERE donor_id=? ORDER BY date DESC;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, donorId); // Bind the donor ID.
+        DonationRecord donation;
+        SqliteRow columns(stmt);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            donation.id = sqlite3_column_int(stmt, 0);
+            donation.donorId = sqlite3_column_int(stmt, 1);
+            donation.amountCents = sqlite3_column_int64(stmt, 2);
+            columns.copyText(3, donation.date);
+            columns.copyText(4, donation.paymentMethod);
+            ++visited;
+            if (!visitor(donation)) {
+                break;
+            }
+        }
+    }
+    sqlite3_reset(stmt);
+    return visited;
+}
+
+/**
+ * @brief Streams every donor matching searchTerm (all donors if empty) to a visitor,
+ * reading one page at a time into a reused batch; the visitor sees one reused record.
+ * @param searchTerm The string to search for.
+ * @param visitor Called once per donor; return false to stop early.
+ * @return The number of donors visited.
+ */
+std::size_t DonationTracker::visitDonors(const std::string& searchTerm, const std::function<bool(const DonorRecord&)>& visitor) {
+    std::size_t visited = 0;
+    DonorPageCursor cursor;
+    cursor.searchTerm = searchTerm;
+    RowBatch batch;
+    DonorRecord donor;
+    while (!cursor.atEnd) {
+        fetchDonorBatch(cursor, 1000, batch);
+        for (int i = 0; i < batch.size(); ++i) {
+            readDonorRecord(batch, i, donor);
+            ++visited;
+            if (!visitor(donor)) {
+                return visited;
+            }
+        }
+    }
+    return visited;
+}
+
+/**
+ * @brief Streams per-donor totals for a year, largest total first.
+ * @param year The donation year.
+ * @param visitor Called once per donor; return false to stop early.
+ * @return The number of donors visited.
+ */
+std::size_t DonationTracker::visitDonorTotals(int year, const std::function<bool(const DonorTotal&)>& visitor) {
+    std::size_t visited = 0;
+    const char* sql = "SELECT d.id, d.first_name, d.last_name, t.donation_count, t.total_cents "
+                      "FROM donor_year_totals t JOIN donors d ON d.id = t.donor_id "
+                      "WHERE t.year = ? ORDER BY t.total_cents DESC, t.donor_id;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, year);
+        DonorTotal total;
+        SqliteRow columns(stmt);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            total.donorId = sqlite3_column_int(stmt, 0);
+            columns.copyText(1, total.firstName);
+            columns.copyText(2, total.lastName);
+            total.donations = sqlite3_column_int(stmt, 3);
+            total.totalCents = sqlite3_column_int64(stmt, 4);
+            ++visited;
+            if (!visitor(total)) {
+                break;
+            }
+        }
+    }
+    sqlite3_reset(stmt);
+    return visited;
+}
+
+/**
+ * @brief Returns donor count, gift count and total per year, oldest year first.
+ */
+std::vector<YearSummary> DonationTracker::getYearSummaries() {
+    std::vector<YearSummary> summaries;
+    // One row per donor and year in donor_year_totals, grouped in idx_donor_year_totals_year_cents order.
+    const char* sql = "SELECT year, COUNT(*), SUM(donation_count), SUM(total_cents) "
+                      "FROM donor_year_totals GROUP BY year ORDER BY year;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            YearSummary summary;
+            summary.year = sqlite3_column_int(stmt, 0);
+            summary.donors = sqlite3_column_int(stmt, 1);
+            summary.donations = sqlite3_column_int(stmt, 2);
+            summary.totalCents = sqlite3_column_int64(stmt, 3);
+            summaries.push_back(summary);
+        }
+    }
+    sqlite3_reset(stmt);
+    return summaries;
+}
+
+/**
+ * @brief Loads the donations table into columns (donor, cents, year, month).
+ */
+bool DonationTracker::loadDonationColumns(DonationColumns& columns) {
+    columns.clear();
+    columns.reserve(static_cast<std::size_t>(queryInt("SELECT COUNT(*) FROM donations;", nullptr, 0)));
+    const char* sql = "SELECT donor_id, amount_cents, donation_year, CAST(SUBSTR(date, 6, 2) AS INTEGER) FROM donations;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    int rc = SQLITE_ERROR;
+    if (stmt) {
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            columns.donorIds.push_back(sqlite3_column_int(stmt, 0));
+            columns.amountCents.push_back(sqlite3_column_int64(stmt, 1));
+            columns.years.push_back(static_cast<std::int16_t>(sqlite3_column_int(stmt, 2)));
+            columns.months.push_back(static_cast<std::int8_t>(sqlite3_column_int(stmt, 3)));
+        }
+        if (rc != SQLITE_DONE) {
+            reportError(ErrorSeverity::Warning, "Database Error", QString("Failed to load donations: %1").arg(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_reset(stmt);
+    return rc == SQLITE_DONE;
+}
+
+/**
+ * @brief Streams donations after a given ID together with donor attributes.
+ * The range scan on the donations rowid makes an incremental top-up cost only the new rows.
+ */
+std::size_t DonationTracker::visitReportRows(int afterDonationId, const std::function<bool(const ReportRow&)>& visitor) {
+    std::size_t visited = 0;
+    const char* sql = "SELECT don.id, don.donor_id, don.amount_cents, don.donation_year, "
+                      "CAST(SUBSTR(don.date, 6, 2) AS INTEGER), don.payment_method, d.state, d.country "
+                      "FROM donations don LEFT JOIN donors d ON d.id = don.donor_id "
+                      "WHERE don.id > ? ORDER BY don.id;";
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (stmt) {
+        sqlite3_bind_int(stmt, 1, afterDonationId);
+        ReportRow row;
+        SqliteRow columns(stmt);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            row.donationId = sqlite3_column_int(stmt, 0);
+            row.donorId = sqlite3_column_int(stmt, 1);
+            row.amountCents = sqlite3_column_int64(stmt, 2);
+            row.year = sqlite3_column_int(stmt, 3);
+            row.month = sqlite3_column_int(stmt, 4);
+            columns.copyText(5, row.paymentMethod);
+            columns.copyText(6, row.state);
+            columns.copyText(7, row.country);
+            ++visited;
+            if (!visitor(row)) {
+                break;
+            }
+        }
+    }
+    sqlite3_reset(stmt);
+    return visited;
+}
+
+/**
+ * @brief Streams donors or donations to a CSV or NDJSON file.
+ * Each variant of the query (filters present or not) is one statement, prepared once and
+ * cached. Rows go straight from sqlite3_step into the writer's buffer, and the plans need no
+ * sort: unfiltered and date-filtered exports scan in ID order, and donor-filtered donation
+ * exports walk idx_donations_donor_date in (donor, date) order.
+ * @param options Table, format, compression and filters.
+ * @param path Output file, or "-" for stdout.
+ * @return Rows and bytes written, or the error that stopped the export.
+ */
+ExportResult DonationTracker::exportRows(const ExportOptions& options, const std::string& path) {
+    ExportResult result;
+    bool byDonor = !options.donorIds.empty();
+    std::string conditions; // Joined with AND below.
+    auto addCondition = [&conditions](const std::string& condition) {
+        conditions += conditions.empty() ? " WHERE " : " AND ";
+        conditions += condition;
+    };
+
+    std::string sql;
+    std::vector<const char*> columns;
+    int centsColumn = -1; // Column written with addCents.
+    if (options.table == ExportTable::Donations) {
+        columns = {"id", "donor_id", "first_name", "last_name", "amount", "date", "payment_method"};
+        centsColumn = 4;
+        sql = "SELECT don.id, don.donor_id, d.first_name, d.last_name, don.amount_cents, don.date, don.payment_method "
+              "FROM donations don LEFT JOIN donors d ON d.id = don.donor_id";
+        if (byDonor) {
+            addCondition("don.donor_id IN (SELECT value FROM json_each(?3))");
+        }
+        if (!options.dateFrom.empty()) {
+            addCondition("don.date >= ?1");
+        }
+        if (!options.dateTo.empty()) {
+            addCondition("don.date <= ?2");
+        }
+        sql += conditions;
+        sql += byDonor ? " ORDER BY don.donor_id, don.date, don.id;" : " ORDER BY don.id;";
+    } else {
+        columns = {"id", "first_name", "last_name", "street", "city", "state", "zip", "country", "phone", "email"};
+        sql = "SELECT d.id, d.first_name, d.last_name, d.street, d.city, d.state, d.zip, d.country, d.phone, d.email "
+              "FROM donors d";
+        if (byDonor) {
+            addCondition("d.id IN (SELECT value FROM json_each(?3))");
+        }
+        // A date range on donors means "gave within the range".
+        if (!options.dateFrom.empty() || !options.dateTo.empty()) {
+            std::string exists = "EXISTS (SELECT 1 FROM donations don WHERE don.donor_id = d.id";
+            exists += options.dateFrom.empty() ? "" : " AND don.date >= ?1";
+            exists += options.dateTo.empty() ? "" : " AND don.date <= ?2";
+            addCondition(exists + ")");
+        }
+        sql += conditions;
+        sql += " ORDER BY d.id;";
+    }
+
+    sqlite3_stmt* stmt = prepareCached(sql);
+    if (!stmt) {
+        result.error = std::string("Failed to prepare export query: ") + sqlite3_errmsg(db);
+        return result;
+    }
+    if (!options.dateFrom.empty()) {
+        sqlite3_bind_text(stmt, 1, options.dateFrom.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    if (!options.dateTo.empty()) {
+        sqlite3_bind_text(stmt, 2, options.dateTo.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    if (byDonor) {
+        std::string ids = "["; // Bound as one JSON array, so any number of donors shares one statement.
+        for (std::size_t i = 0; i < options.donorIds.size(); ++i) {
+            ids += (i ? "," : "") + std::to_string(options.donorIds[i]);
+        }
+        ids += "]";
+        sqlite3_bind_text(stmt, 3, ids.c_str(), -1, SQLITE_TRANSIENT);
+    }
+
+    ExportWriter writer(options.format);
+    if (!writer.open(path, options.gzip, columns, &result.error)) {
+        sqlite3_reset(stmt);
+        return result;
+    }
+    int columnCount = static_cast<int>(columns.size());
+    SqliteRow values(stmt);
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        writer.beginRow();
+        for (int i = 0; i < columnCount; ++i) {
+            switch (sqlite3_column_type(stmt, i)) {
+            case SQLITE_NULL:
+                writer.addNull();
+                break;
+            case SQLITE_INTEGER:
+                if (i == centsColumn) {
+                    writer.addCents(sqlite3_column_int64(stmt, i));
+                } else {
+                    writer.addInt(sqlite3_column_int64(stmt, i));
+                }
+                break;
+            default: { // Text (and anything else, as its text form).
+                TextView text = values.text(i);
+                writer.addText(text.data, text.size);
+                break;
+            }
+            }
+        }
+        writer.endRow();
+    }
+    if (rc != SQLITE_DONE) {
+        result.error = canceledByCheck ? "Export canceled" : std::string("Failed to read export rows: ") + sqlite3_errmsg(db);
+    }
+    sqlite3_reset(stmt);
+
+    std::string closeError;
+    bool closed = writer.close(&closeError);
+    if (result.error.empty() && !closed) {
+        result.error = closeError;
+    }
+    result.ok = result.error.empty();
+    result.rows = writer.rowsWritten();
+    result.bytes = writer.bytesWritten();
+    return result;
+}
+
+/**
+ * @brief Writes the pending changes as changesets of at most batchSize lines, then trims
+ * them from the change log. Rows and log are read in one read transaction, so each line
+ * carries the row as of the pushed sequence.
+ */
+SyncResult DonationTracker::pushChanges(const std::string& outboxDirectory, const SyncOptions& options) {
+    SyncResult result;
+    QElapsedTimer timer;
+    timer.start();
+    QDir outbox(QString::fromStdString(outboxDirectory));
+    if (!outbox.mkpath(".")) {
+        result.error = "Cannot create " + outboxDirectory;
+        return result;
+    }
+    if (!executeCached("BEGIN;")) {
+        result.error = std::string("Failed to start push: ") + sqlite3_errmsg(db);
+        return result;
+    }
+
+    sqlite3_int64 sequence = 0; // Last change_log entry this push covers.
+    sqlite3_stmt* stmt = prepareCached("SELECT COALESCE(MAX(seq), 0) FROM change_log;");
+    if (stmt && sqlite3_step(stmt) == SQLITE_ROW) {
+        sequence = sqlite3_column_int64(stmt, 0);
+    } else {
+        result.error = std::string("Failed to read the change log: ") + sqlite3_errmsg(db);
+    }
+    sqlite3_reset(stmt);
+
+    int batchSize = std::max(1, options.batchSize);
+    ChangesetWriter writer;
+    bool fileOpen = false;
+    int linesInFile = 0;
+    for (const SyncTable& table : syncTables()) {
+        if (!result.error.empty() || sequence == 0) {
+            break;
+        }
+        stmt = prepareCached(pushChangesSql(table));
+        if (!stmt) {
+            result.error = std::string("Failed to prepare push query: ") + sqlite3_errmsg(db);
+            break;
+        }
+        sqlite3_bind_int64(stmt, 1, sequence);
+        SqliteRow row(stmt);
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            if (!fileOpen) {
+                std::string name = ChangeSync::changesetName(sequence, result.changesets, options.gzip);
+                if (!writer.open(outbox.filePath(QString::fromStdString(name)).toStdString(), options.gzip, &result.error)) {
+                    break;
+                }
+                fileOpen = true;
+            }
+            TextView line = row.text(0);
+            if (!writer.writeLine(line.data, line.size)) {
+                result.error = "Failed to write changeset";
+                break;
+            }
+            ++result.changes;
+            if (++linesInFile == batchSize) {
+                fileOpen = false;
+                linesInFile = 0;
+                if (!writer.commit(&result.error)) {
+                    break;
+                }
+                ++result.changesets;
+                result.bytes += writer.bytesWritten();
+            }
+        }
+        if (result.error.empty() && rc != SQLITE_DONE) {
+            result.error = std::string("Failed to read changes: ") + sqlite3_errmsg(db);
+        }
+        sqlite3_reset(stmt);
+    }
+    if (result.error.empty() && fileOpen) {
+        if (writer.commit(&result.error)) {
+            ++result.changesets;
+            result.bytes += writer.bytesWritten();
+        }
+    }
+    executeCached("COMMIT;"); // Ends the read transaction.
+
+    // Only entries up to the pushed sequence go: rows changed meanwhile were re-logged past it.
+    if (result.error.empty() && sequence > 0) {
+        stmt = prepareCached("DELETE FROM change_log WHERE seq <= ?1;");
+        if (stmt) {
+            sqlite3_bind_int64(stmt, 1, sequence);
+        }
+        if (!stmt || sqlite3_step(stmt) != SQLITE_DONE) {
+            // The changesets are out; they are sent again next time, which applying tolerates.
+            result.error = std::string("Failed to trim the change log: ") + sqlite3_errmsg(db);
+        }
+        sqlite3_reset(stmt);
+    }
+    result.ok = result.error.empty();
+    result.elapsedSeconds = timer.elapsed() / 1000.0;
+    return result;
+}
+
+/**
+ * @brief Applies one changeset in one transaction. Changesets from a push older than the
+ * last one applied are skipped, so a stale copy of an outbox cannot roll rows back; any
+ * changeset of the current push may be applied again, since every line overwrites or
+ * deletes a whole row. The change log entries the apply's own writes add are dropped: a
+ * central copy is the end of the line, not a source of further pushes.
+ */
+SyncResult DonationTracker::applyChangeset(const std::string& path) {
+    SyncResult result;
+    QElapsedTimer timer;
+    timer.start();
+    std::int64_t sequence = 0;
+    if (!ChangeSync::changesetSequence(path, sequence)) {
+        result.error = "Not a changeset: " + path;
+        return result;
+    }
+    ChangesetReader reader;
+    if (!reader.open(path, &result.error)) {
+        return result;
+    }
+    result.bytes = static_cast<std::uint64_t>(QFileInfo(QString::fromStdString(path)).size());
+    if (!executeCached("BEGIN IMMEDIATE;")) {
+        result.error = std::string("Failed to start apply: ") + sqlite3_errmsg(db);
+        return result;
+    }
+
+    sqlite3_int64 applied = 0;
+    sqlite3_int64 logged = 0;
+    sqlite3_stmt* stmt = prepareCached("SELECT COALESCE((SELECT value FROM sync_state WHERE name = 'applied_sequence'), 0), "
+                                       "COALESCE((SELECT MAX(seq) FROM change_log), 0);");
+    if (stmt && sqlite3_step(stmt) == SQLITE_ROW) {
+        applied = sqlite3_column_int64(stmt, 0);
+        logged = sqlite3_column_int64(stmt, 1);
+    } else {
+        result.error = std::string("Failed to read sync state: ") + sqlite3_errmsg(db);
+    }
+    sqlite3_reset(stmt);
+    if (result.error.empty() && sequence < applied) {
+        executeCached("ROLLBACK;");
+        reader.close();
+        result.ok = true;
+        result.skipped = 1;
+        result.elapsedSeconds = timer.elapsed() / 1000.0;
+        return result;
+    }
+
+    std::vector<SyncTable> tables = syncTables();
+    std::vector<std::string> applySql; // Upsert and delete statements of each table, in table order.
+    for (const SyncTable& table : tables) {
+        applySql.push_back(upsertChangeSql(table));
+        applySql.push_back(deleteChangeSql(table));
+    }
+    std::string line;
+    while (result.error.empty() && reader.readLine(line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::string name = changeTable(line);
+        std::size_t table = 0;
+        while (table < tables.size() && name != tables[table].name) {
+            ++table;
+        }
+        if (table == tables.size()) {
+            result.error = "Unrecognized change in " + path + " after " + std::to_string(result.changes) + " changes";
+            break;
+        }
+        // The upsert writes a present row; the delete removes a row recorded as deleted.
+        for (std::size_t step = 2 * table; step < 2 * table + 2; ++step) {
+            stmt = prepareCached(applySql[step]);
+            int rc = SQLITE_ERROR;
+            if (stmt) {
+                sqlite3_bind_text(stmt, 1, line.data(), static_cast<int>(line.size()), SQLITE_STATIC);
+                rc = sqlite3_step(stmt);
+            }
+            if (rc != SQLITE_DONE) {
+                result.error = std::string("Failed to apply change: ") + sqlite3_errmsg(db);
+            }
+            sqlite3_reset(stmt);
+            if (!result.error.empty()) {
+                break;
+            }
+        }
+        ++result.changes;
+    }
+    std::string readError;
+    if (!reader.close(&readError) && result.error.empty()) {
+        result.error = readError; // Truncated or corrupt: nothing of it is kept.
+    }
+
+    const char* finish[] = {
+        "DELETE FROM change_log WHERE seq > ?1;",
+        "INSERT INTO sync_state (name, value) VALUES ('applied_sequence', ?2) "
+        "ON CONFLICT (name) DO UPDATE SET value = excluded.value;",
+    };
+    for (int i = 0; i < 2 && result.error.empty(); ++i) {
+        stmt = prepareCached(finish[i]);
+        int rc = SQLITE_ERROR;
+        if (stmt) {
+            sqlite3_bind_int64(stmt, 1, logged);
+            sqlite3_bind_int64(stmt, 2, sequence);
+            rc = sqlite3_step(stmt);
+        }
+        if (rc != SQLITE_DONE) {
+            result.error = std::string("Failed to record the apply: ") + sqlite3_errmsg(db);
+        }
+        sqlite3_reset(stmt);
+    }
+    if (!result.error.empty() || !executeCached("COMMIT;")) {
+        if (result.error.empty()) {
+            result.error = std::string("Failed to commit changeset: ") + sqlite3_errmsg(db);
+        }
+        executeCached("ROLLBACK;");
+        result.changes = 0;
+        return result;
+    }
+
+    clearDonorCache();
+    emit donationsImported(static_cast<int>(result.changes)); // Views reload, as after an import.
+    result.ok = true;
+    result.changesets = 1;
+    result.elapsedSeconds = timer.elapsed() / 1000.0;
+    return result;
+}
+
+/**
+ * @brief Writes a snapshot of this tracker's database file through a separate connection.
+ */
+BackupResult DonationTracker::backupTo(const std::string& destinationPath, const BackupOptions& options,
+                                       const BackupProgress& progress) const {
+    return DatabaseBackup::write(dbPath, destinationPath, options, progress);
+}
+
+/**
+ * @brief Attaches a database file under a schema name, unless that schema exists already.
+ * Both the file and the schema name are bound parameters, so neither needs quoting.
+ */
+bool DonationTracker::attachDatabase(const std::string& schema, const std::string& path, std::string* error) {
+    sqlite3_stmt* stmt = prepareCached("SELECT 1 FROM pragma_database_list WHERE name = ?;");
+    bool attached = false;
+    if (stmt) {
+        sqlite3_bind_text(stmt, 1, schema.c_str(), -1, SQLITE_TRANSIENT);
+        attached = sqlite3_step(stmt) == SQLITE_ROW;
+    }
+    sqlite3_reset(stmt);
+    if (attached) {
+        return true;
+    }
+    if (!QFile::exists(QString::fromStdString(path))) {
+        // ATTACH would create an empty database instead.
+        if (error) {
+            *error = "No such database: " + path;
+        }
+        return false;
+    }
+
+    stmt = prepareCached("ATTACH DATABASE ?1 AS ?2;");
+    int rc = SQLITE_ERROR;
+    if (stmt) {
+        sqlite3_bind_text(stmt, 1, path.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, schema.c_str(), -1, SQLITE_TRANSIENT);
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE) {
+        if (error) {
+            *error = "Cannot attach " + path + ": " + sqlite3_errmsg(db);
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Detaches a schema added by attachDatabase.
+ */
+bool DonationTracker::detachDatabase(const std::string& schema) {
+    sqlite3_stmt* stmt = prepareCached("DETACH DATABASE ?;");
+    int rc = SQLITE_ERROR;
+    if (stmt) {
+        sqlite3_bind_text(stmt, 1, schema.c_str(), -1, SQLITE_TRANSIENT);
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_reset(stmt);
+    return rc == SQLITE_DONE;
+}
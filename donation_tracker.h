@@ -21,18 +21,168 @@
 #ifndef DONATION_TRACKER_H
 #define DONATION_TRACKER_H
 
-// Required Qt and standard library includes for UI elements, database interaction, and data structures.
+// Required Qt and standard library includes for database interaction and data structures.
+// Only QtCore is needed; the QTableWidget convenience methods are compiled out when
+// DONATION_TRACKER_HEADLESS is defined (CONFIG += headless in backend.pri).
 #include <QObject>
-#include <QDialog>
-#include <QMainWindow>
-#include <QTableWidget>
-#include <QLineEdit>
-#include <QLabel>
-#include <QDateEdit> // Include for QDateEdit
-#include <QDoubleValidator> // Include for QDoubleValidator (needed for DonationDialog)
+#include <QString>
 #include <sqlite3.h> // SQLite database library for data persistence.
 #include <string> // Standard C++ string manipulation.
 #include <vector> // Standard C++ dynamic array (used for donor IDs).
+#include <unordered_map> // Hash map used for the prepared-statement cache.
+#include <cstddef> // std::size_t for the statement cache counters.
+#include <functional> // Error sink and row visitors.
+#include <list> // Recency order of the donor cache.
+#include "money.h" // Cents: amounts are stored and summed as integer cents.
+#include "letter_sink.h" // LetterSinkKind for generateDonationLetters.
+#include "receipt_planner.h" // ReceiptSelection for generateDonationLetters.
+#include "row_batch.h" // RowBatch for fetchDonorBatch.
+#include "query_profiler.h" // Per-statement timing and the slow-query log.
+#include "donation_export.h" // ExportOptions and ExportResult for exportRows.
+#include "database_backup.h" // BackupOptions and BackupResult for backupTo.
+#include "donor_dedup.h" // DedupOptions and DedupResult for findDuplicateDonors.
+#include "change_sync.h" // SyncOptions and SyncResult for pushChanges/applyChangeset.
+
+struct DonationColumns; // Columnar copy of the donations table (donation_columns.h).
+class LetterTemplate; // Compiled letter text (letter_template.h).
+
+#ifndef DONATION_TRACKER_HEADLESS
+class QTableWidget; // Filled by searchDonors/getDonationsForDonor (donation_tracker_widgets.cpp).
+#endif
+
+/**
+ * @brief How serious a reported backend error is.
+ */
+enum class ErrorSeverity {
+    Warning, // A single operation failed; the tracker remains usable.
+    Critical // The connection or schema is unusable (e.g. the database could not be opened).
+};
+
+/**
+ * @brief Receives the backend's error reports in place of message boxes.
+ * The GUI installs a sink that shows a QMessageBox; headless tools print to stderr.
+ * A sink may be called from whichever thread is using the DonationTracker.
+ */
+using ErrorSink = std::function<void(ErrorSeverity severity, const std::string& title, const std::string& message)>;
+
+
+/**
+ * @brief Connection tuning presets applied to the SQLite connection after it is opened.
+ * All profiles use WAL journaling and enforce foreign keys; they differ in durability,
+ * cache sizing and whether writes are allowed.
+ */
+enum class ConnectionProfile {
+    Interactive, // Day-to-day GUI use: WAL, synchronous=NORMAL, moderate page cache and mmap.
+    BulkLoad, // Imports: large page cache and mmap, infrequent WAL checkpoints.
+    ReadOnlyReporting // Reports and letter runs: query_only, large cache and mmap.
+};
+
+// How DonationTracker opens its database file.
+enum class OpenMode {
+    ReadWrite, // Creates the file if needed, switches it to WAL and migrates its schema.
+    ReadOnly // SQLITE_OPEN_READONLY: never writes, and refuses files not at the current schema version.
+};
+
+/**
+ * @brief A donor row as returned by the paged and headless query APIs.
+ */
+struct DonorRecord {
+    int id = 0; // Donor ID.
+    std::string firstName;
+    std::string lastName;
+    std::string street;
+    std::string city;
+    std::string state;
+    std::string zip;
+    std::string country;
+    std::string phone;
+    std::string email;
+};
+
+/**
+ * @brief Position of a paged donor listing, advanced by DonationTracker::fetchDonorPage.
+ * Pages are ordered by (first_name, last_name, id) and resumed after the last row returned,
+ * so each page is an index range scan regardless of how deep the listing has been read.
+ */
+struct DonorPageCursor {
+    std::string searchTerm; // Filter; empty lists all donors.
+    bool started = false; // False until the first page has been fetched.
+    bool atEnd = false; // True once a short (final) page has been returned, or a page failed.
+    bool failed = false; // True if the listing was ended by a database error rather than exhausted.
+    std::string lastFirstName; // Sort key of the last row returned.
+    std::string lastLastName;
+    int lastId = 0;
+    bool ranked = false; // True for full-text searches, which are ordered by relevance.
+    int offset = 0; // Rows returned so far; ranked listings page by offset.
+};
+
+/**
+ * @brief A single donation row as passed to and from the bulk APIs.
+ */
+struct DonationRecord {
+    int id = 0; // Donation ID; 0 for rows that have not been stored yet.
+    int donorId = 0; // ID of the donor the donation belongs to.
+    Cents amountCents = 0; // Donation amount in cents.
+    std::string date; // Donation date as "YYYY-MM-DD".
+    std::string paymentMethod; // Method of payment (e.g., "Check", "Card").
+};
+
+/**
+ * @brief Describes one row rejected by a bulk import.
+ */
+struct ImportError {
+    std::size_t row; // 1-based record index (for CSV imports, the line number in the file).
+    std::string message; // Why the row was rejected.
+};
+
+/**
+ * @brief Outcome of a bulk import: counts, the rejected rows and throughput.
+ */
+struct ImportResult {
+    std::size_t rowsImported = 0; // Rows committed to the database.
+    std::size_t rowsFailed = 0; // Rows rejected; each has an entry in errors.
+    std::vector<ImportError> errors; // Rejected rows, in input order.
+    double elapsedSeconds = 0.0; // Wall-clock time spent importing.
+
+    // Committed rows per second of wall-clock time (0 if nothing was timed).
+    double rowsPerSecond() const { return elapsedSeconds > 0.0 ? rowsImported / elapsedSeconds : 0.0; }
+};
+
+/**
+ * @brief One donor's giving in a year, as returned by DonationTracker::visitDonorTotals.
+ */
+struct DonorTotal {
+    int donorId = 0;
+    std::string firstName;
+    std::string lastName;
+    int donations = 0; // Number of gifts in the year.
+    Cents totalCents = 0; // Sum of the gifts in the year.
+};
+
+/**
+ * @brief Totals for one year across all donors, as returned by DonationTracker::getYearSummaries.
+ */
+struct YearSummary {
+    int year = 0;
+    int donors = 0; // Distinct donors who gave in the year.
+    int donations = 0;
+    Cents totalCents = 0;
+};
+
+/**
+ * @brief A donation with the donor attributes reports group by, as streamed by
+ * DonationTracker::visitReportRows.
+ */
+struct ReportRow {
+    int donationId = 0;
+    int donorId = 0;
+    Cents amountCents = 0;
+    int year = 0; // 0 if the date is missing.
+    int month = 0; // 1-12, 0 if the date is missing.
+    std::string paymentMethod;
+    std::string state; // Donor's state (empty if the donor row is missing).
+    std::string country; // Donor's country.
+};
 
 /**
  * @brief The DonationTracker class manages all database interactions for donors, donations, and organization details.
@@ -43,15 +193,65 @@ class DonationTracker : public QObject {
 
 private:
     sqlite3* db; // Pointer to the SQLite database connection.
+    std::string dbPath; // Path of the database file behind db.
+    ConnectionProfile profile; // Profile currently applied to db.
+    OpenMode openMode; // How db was opened.
+    ErrorSink errorSink; // Where error reports go (copied from the default sink on construction).
+    void reportError(ErrorSeverity severity, const char* title, const QString& message); // Forwards to errorSink.
+    QueryProfiler queryProfiler; // Statement statistics and slow-query log (see setQueryProfiling).
+    std::function<bool()> cancelCheck; // Polled by progressCallback while statements run (see setCancelCheck).
+    bool canceledByCheck; // cancelCheck has interrupted a statement since it was installed.
+    static int progressCallback(void* context); // sqlite3_progress_handler hook.
+    bool ftsAvailable; // True when the donors_fts full-text index exists.
     void createTables(); // Private helper function to create necessary database tables if they don't exist.
+    void migrateSchema(); // Applies pending schema migrations, tracked via PRAGMA user_version.
+    void closeConnection(); // Finalizes cached statements and closes db (leaving it nullptr).
+    static const int currentSchemaVersion = 7; // The version of migrateSchema's last step.
+    bool applyMigration(int version, const char* sql); // Runs one migration step and bumps user_version atomically.
+    void ensureSearchIndex(); // Creates the FTS5 donor index and sync triggers if missing.
+    // Full-text search page, ordered by relevance.
+    void fetchRankedDonorBatch(DonorPageCursor& cursor, const std::vector<std::string>& tokens, int limit, RowBatch& batch);
+
+    // Prepared statements keyed by their SQL text. Each is prepared once and reused for the
+    // lifetime of db; all are finalized in the destructor.
+    std::unordered_map<std::string, sqlite3_stmt*> statementCache;
+    std::size_t statementCacheHits; // Lookups served from statementCache.
+    std::size_t statementCacheMisses; // Lookups that had to prepare a new statement.
+    sqlite3_stmt* prepareCached(const std::string& sql); // Returns a reset, unbound statement for sql (nullptr on error).
+    bool executeCached(const char* sql); // Steps a cached parameterless statement (e.g. BEGIN/COMMIT) to completion.
+    int queryInt(const char* sql, const int* param, int fallback); // First column of a one-row query (fallback if none/NULL).
+    // Recently used donors and their donation lists, most recent at the front of
+    // donorCacheOrder. Filled by getDonorRecord/fetchDonationsForDonor and invalidated by
+    // this tracker's own writes; see setDonorCacheCapacity for writes on other connections.
+    struct DonorCacheEntry {
+        DonorRecord donor;
+        bool hasDonor = false;
+        std::vector<DonationRecord> donations;
+        bool hasDonations = false;
+        std::list<int>::iterator position; // This entry's place in donorCacheOrder.
+    };
+    std::unordered_map<int, DonorCacheEntry> donorCache;
+    std::list<int> donorCacheOrder;
+    std::size_t donorCacheCapacity; // Maximum entries; 0 disables the cache.
+    std::size_t donorCacheHits;
+    std::size_t donorCacheMisses;
+    DonorCacheEntry* findCachedDonor(int id); // Marks the entry most recently used (nullptr if absent).
+    DonorCacheEntry* cacheDonorEntry(int id); // Finds or adds an entry, evicting the least recently used.
+    void invalidateCachedDonations(int donorId); // Keeps the donor record, drops its donation list.
+    // Inserts records[0..count) in one transaction, appending rejected rows to result.
+    void importDonationBatch(const DonationRecord* records, std::size_t count, std::size_t firstRow, ImportResult& result);
 
 public:
-    // Constructor initializes the database connection.
+    // Constructor initializes the database connection and applies the given connection profile.
     // No parent argument needed for DonationTracker, as it's a backend logic class.
-    DonationTracker();
+    explicit DonationTracker(ConnectionProfile profile = ConnectionProfile::Interactive,
+                             const std::string& dbPath = "donations.db", OpenMode openMode = OpenMode::ReadWrite);
     // Destructor closes the database connection.
     ~DonationTracker();
 
+    // False if the database could not be opened (or, read-only, was at another schema version).
+    bool isOpen() const { return db != nullptr; }
+
     /**
      * @brief Adds a new donor record to the database.
      * @param firstName The first name of the donor.
@@ -94,26 +294,70 @@ public:
      */
     bool deleteDonor(int id);
 
+    /**
+     * @brief Finds likely duplicate donors without comparing every pair.
+     * Donors are grouped by normalized blocking keys (e-mail, phone digits, last name + ZIP),
+     * each read in order from its expression index, and only donors sharing a key are
+     * compared, in parallel (see DonorMatcher). The cost grows with the number of donors
+     * plus the pairs inside each group rather than with the square of the donor count.
+     * @param options Similarity threshold, largest group compared and thread count.
+     * @return The pairs at or above the threshold, best first, with scan counters.
+     */
+    DedupResult findDuplicateDonors(const DedupOptions& options = DedupOptions());
+
+    /**
+     * @brief Folds a duplicate donor into another in one transaction.
+     * The duplicate's donations are re-pointed to keepId (the yearly totals follow through
+     * their triggers), fields that are empty on keepId are filled from the duplicate, and
+     * the duplicate row is deleted.
+     * @param keepId The donor that remains.
+     * @param duplicateId The donor merged into it and removed.
+     * @return True if both donors existed and the merge committed.
+     */
+    bool mergeDonors(int keepId, int duplicateId);
+
     /**
      * @brief Adds a new donation record to the database.
      * @param donorId The ID of the donor associated with this donation.
-     * @param amount The amount of the donation.
+     * @param amountCents The amount of the donation, in cents.
      * @param date The date of the donation (e.g., "YYYY-MM-DD").
      * @param paymentMethod The method of payment for the donation.
      * @return True if the donation was added successfully, false otherwise.
      */
-    bool addDonation(int donorId, double amount, const std::string& date, const std::string& paymentMethod);
+    bool addDonation(int donorId, Cents amountCents, const std::string& date, const std::string& paymentMethod);
+
+    /**
+     * @brief Inserts many donations using one prepared statement and explicit transactions.
+     * Rows are committed in transactions of batchSize rows, so the journal is synced once per
+     * batch instead of once per row. Invalid rows are skipped and reported in the result
+     * rather than shown to the user, and do not abort the rest of the import.
+     * @param records The donations to insert; their id fields are ignored.
+     * @param batchSize Number of rows per transaction.
+     * @return Counts, rejected rows and throughput for the import.
+     */
+    ImportResult importDonations(const std::vector<DonationRecord>& records, int batchSize = 5000);
+
+    /**
+     * @brief Streams donations from a CSV file into the database in batches.
+     * Expected columns: donor_id, amount, date (YYYY-MM-DD), payment_method. An optional
+     * header line is skipped. Fields may be double-quoted; quoted fields may not span lines.
+     * Only one batch is held in memory at a time, so file size is not limited by RAM.
+     * @param path Path of the CSV file to import.
+     * @param batchSize Number of rows per transaction.
+     * @return Counts, rejected rows (by line number) and throughput for the import.
+     */
+    ImportResult importDonationsCsv(const std::string& path, int batchSize = 5000);
 
     /**
      * @brief Updates an existing donation record in the database.
      * @param id The ID of the donation to update.
      * @param donorId The new donor ID associated with this donation.
-     * @param amount The new amount of the donation.
+     * @param amountCents The new amount of the donation, in cents.
      * @param date The new date of the donation.
      * @param paymentMethod The new method of payment for the donation.
      * @return True if the donation was updated successfully, false otherwise.
      */
-    bool updateDonation(int id, int donorId, double amount, const std::string& date, const std::string& paymentMethod);
+    bool updateDonation(int id, int donorId, Cents amountCents, const std::string& date, const std::string& paymentMethod);
 
     /**
      * @brief Deletes a donation record from the database.
@@ -139,13 +383,54 @@ public:
     bool setOrganizationDetails(const std::string& name, const std::string& address);
 
     /**
-     * @brief Generates donation letters for all donors for a specified year.
-     * Letters are saved as text files in a "letters" directory.
+     * @brief Generates donation letters for the donors of a specified year.
+     * Letters are saved in a "letters" directory, as one text file per donor or as a single
+     * file (see LetterSink::outputPath).
      * @param year The year for which to generate donation letters.
-     * @return True if letters were generated successfully for all donors, false otherwise.
+     * @param letterTemplate The letter to write; nullptr for the default thank-you letter.
+     * @param sinkKind Where the letters are written.
+     * @param selection Minimum total and letter order (see ReceiptPlanner). A template meant for
+     * lapsed donors restricts the run to them.
+     * @return True if letters were generated successfully for all selected donors, false otherwise.
+     */
+    bool generateDonationLetters(int year, const LetterTemplate* letterTemplate = nullptr,
+                                 LetterSinkKind sinkKind = LetterSinkKind::Directory,
+                                 const ReceiptSelection& selection = ReceiptSelection());
+
+    /**
+     * @brief Path of the database file, for components that open their own connection
+     * (e.g. LetterGenerator's producer thread).
+     */
+    const std::string& getDatabasePath() const { return dbPath; }
+
+    /**
+     * @brief Writes a consistent snapshot of the database file while it stays in use.
+     * Copies through a separate connection (see DatabaseBackup), so this tracker's statements
+     * and transactions are unaffected and other connections keep writing. Blocks until done;
+     * use DatabaseBackup::start to take the snapshot in the background.
+     * @param destinationPath File to write; replaced once the snapshot is complete.
+     * @param options Page-copy or compacting (VACUUM INTO) snapshot, and its pacing.
+     * @param progress Optional; called between steps, and may cancel.
+     */
+    BackupResult backupTo(const std::string& destinationPath, const BackupOptions& options = BackupOptions(),
+                          const BackupProgress& progress = nullptr) const;
+
+    /**
+     * @brief Attaches another database file to this connection as the given schema, so
+     * statements can name its tables as <schema>.donors etc. Does nothing if a database is
+     * already attached under that name.
+     * @param schema Schema name for the attached file (e.g. a chapter name).
+     * @param path Database file; it must exist.
+     * @return True if the schema is attached.
      */
-    bool generateDonationLetters(int year);
+    bool attachDatabase(const std::string& schema, const std::string& path, std::string* error = nullptr);
 
+    /**
+     * @brief Detaches a schema added by attachDatabase. Returns false if it was not attached.
+     */
+    bool detachDatabase(const std::string& schema);
+
+#ifndef DONATION_TRACKER_HEADLESS
     /**
      * @brief Searches for donors based on a search term across multiple fields and populates a QTableWidget.
      * @param searchTerm The string to search for.
@@ -153,6 +438,50 @@ public:
      * @param includeAll If true, all donors are returned regardless of searchTerm.
      */
     void searchDonors(const std::string& searchTerm, QTableWidget* table, bool includeAll = false);
+#endif
+
+    /**
+     * @brief Streams every donor matching searchTerm (all donors if empty) to a visitor.
+     * Rows arrive in the same order as searchDonors and the paged listing. Memory use is
+     * one page, however many donors match.
+     * @param searchTerm The string to search for.
+     * @param visitor Called once per donor; return false to stop early.
+     * @return The number of donors visited.
+     */
+    std::size_t visitDonors(const std::string& searchTerm, const std::function<bool(const DonorRecord&)>& visitor);
+
+    /**
+     * @brief Splits a search term into the lower-cased words used for full-text matching.
+     * Diacritics are folded as the index's remove_diacritics tokenizer does, so "José" and
+     * "jose" give the same word whether matched by FTS5 or client-side.
+     * @param searchTerm The raw search text.
+     * @return Runs of letters and digits; punctuation and spaces separate words.
+     */
+    static std::vector<std::string> searchTokens(const std::string& searchTerm);
+
+    /**
+     * @brief Fetches the next page of donors for a listing and advances the cursor.
+     * With a search term, every word must prefix-match a word in one of the searched
+     * fields and results come best match first (FTS5 bm25 rank). Without one, all donors
+     * are listed by name. If SQLite lacks FTS5, search falls back to substring matching.
+     * No statement stays open between pages, so paging never holds a read transaction
+     * across the event loop. A page that cannot be read is reported through the error sink
+     * and ends the listing with cursor.failed set.
+     * @param cursor The listing position; set searchTerm once and pass it back unchanged.
+     * @param limit Maximum number of rows to return.
+     * @return Up to limit donors; fewer (possibly none) when the listing is exhausted.
+     */
+    std::vector<DonorRecord> fetchDonorPage(DonorPageCursor& cursor, int limit);
+
+    /**
+     * @brief Fetches the same page as fetchDonorPage into a reusable batch, for readers that
+     * go through the rows and let them go. Columns are id, first_name, last_name, street,
+     * city, state, zip, country, phone and email.
+     * @param cursor The listing position, advanced as by fetchDonorPage.
+     * @param limit Maximum number of rows to fetch.
+     * @param batch Receives the page, replacing its rows; empty when the listing is exhausted.
+     */
+    void fetchDonorBatch(DonorPageCursor& cursor, int limit, RowBatch& batch);
 
     /**
      * @brief Retrieves all donor IDs from the database, ordered by ID.
@@ -160,6 +489,30 @@ public:
      */
     std::vector<int> getAllDonorIds();
 
+    // Donor navigation by ID order. Each step is one primary-key lookup, so nothing is
+    // loaded up front and the starting ID need not exist any more (e.g. just deleted).
+    // All of these return -1 when there is no such donor.
+    int firstDonorId(); // Smallest donor ID.
+    int lastDonorId(); // Largest donor ID.
+    int nextDonorId(int id); // Smallest donor ID greater than id.
+    int prevDonorId(int id); // Largest donor ID less than id.
+
+    /**
+     * @brief Returns the zero-based position of a donor ID in ID order.
+     * Counts the IDs before it, which walks the index up to that point: fine for an
+     * occasional "n of m" display, but use nextDonorId/prevDonorId for stepping.
+     * @return The number of donors with a smaller ID (whether or not id exists).
+     */
+    int donorPosition(int id);
+
+    /**
+     * @brief Returns the donor ID at a zero-based position in ID order (-1 if out of range).
+     * Like donorPosition, this skips over the preceding part of the index.
+     */
+    int donorIdAtPosition(int position);
+
+    int getDonorCount(); // Number of donors.
+
     /**
      * @brief Retrieves details for a specific donor by ID.
      * @param id The ID of the donor to retrieve.
@@ -178,186 +531,234 @@ public:
                                      std::string& state, std::string& zip, std::string& country,
                                      std::string& phone, std::string& email);
 
+    /**
+     * @brief Retrieves a single donor as a DonorRecord.
+     * @param id The ID of the donor to retrieve.
+     * @param donor Receives the donor's fields.
+     * @return True if the donor was found, false otherwise.
+     */
+    bool getDonorRecord(int id, DonorRecord& donor);
+
+#ifndef DONATION_TRACKER_HEADLESS
     /**
      * @brief Retrieves all donations for a given donor and populates a QTableWidget.
      * @param donorId The ID of the donor whose donations are to be retrieved.
      * @param table The QTableWidget to populate with donation records.
      */
     void getDonationsForDonor(int donorId, QTableWidget* table);
-};
 
-/**
- * @brief The DonorDialog class provides a dialog for adding or editing donor information.
- */
-class DonorDialog : public QDialog {
-    Q_OBJECT // Enables Qt's meta-object system.
+    /**
+     * @brief Fills a QTableWidget with donation records (ID, donor ID, amount, date, method).
+     * Used by getDonationsForDonor and by the GUI when donations arrive from DatabaseWorker.
+     */
+    static void fillDonationsTable(const std::vector<DonationRecord>& donations, QTableWidget* table);
+#endif
 
-public:
     /**
-     * @brief Constructor for DonorDialog.
-     * @param parent The parent widget.
+     * @brief Retrieves all donations for a given donor, newest first.
+     * @param donorId The ID of the donor whose donations are to be retrieved.
+     * @return The donations (empty if the donor has none or does not exist).
      */
-    DonorDialog(QWidget* parent = nullptr);
+    std::vector<DonationRecord> fetchDonationsForDonor(int donorId);
 
     /**
-     * @brief Validates the input fields in the dialog.
-     * @return True if all inputs are valid, false otherwise.
+     * @brief Streams a donor's donations, newest first, to a visitor.
+     * @param donorId The ID of the donor whose donations are to be visited.
+     * @param visitor Called once per donation; return false to stop early.
+     * @return The number of donations visited.
      */
-    bool validateInputs();
+    std::size_t visitDonationsForDonor(int donorId, const std::function<bool(const DonationRecord&)>& visitor);
 
-    // Public QLineEdit pointers to allow access to input fields from MainWindow for data retrieval.
-    QLineEdit* idEdit;
-    QLineEdit* firstNameEdit;
-    QLineEdit* lastNameEdit;
-    QLineEdit* streetEdit;
-    QLineEdit* cityEdit;
-    QLineEdit* stateEdit;
-    QLineEdit* zipEdit;
-    QLineEdit* countryEdit;
-    QLineEdit* phoneEdit;
-    QLineEdit* emailEdit;
+    /**
+     * @brief Streams per-donor totals for a year, largest total first.
+     * @param year The donation year.
+     * @param visitor Called once per donor; return false to stop early (e.g. after the top N).
+     * @return The number of donors visited.
+     */
+    std::size_t visitDonorTotals(int year, const std::function<bool(const DonorTotal&)>& visitor);
 
-signals:
-    // Signal emitted when a donor is successfully saved (added or updated).
-    void donorSaved(int id);
-};
+    /**
+     * @brief Returns donor count, gift count and total per year, oldest year first.
+     */
+    std::vector<YearSummary> getYearSummaries();
 
-/**
- * @brief The DonationDialog class provides a dialog for adding or editing donation information.
- */
-class DonationDialog : public QDialog {
-    Q_OBJECT // Enables Qt's meta-object system.
+    /**
+     * @brief Loads every donation into columns for in-process aggregation (replacing any
+     * previous contents). One sequential scan; afterwards the columns are independent of
+     * the database and any thread may aggregate over them.
+     * @return True if the whole table was read.
+     */
+    bool loadDonationColumns(DonationColumns& columns);
 
-public:
     /**
-     * @brief Constructor for DonationDialog.
-     * @param parent The parent widget.
+     * @brief Streams donations with ID greater than afterDonationId, in ID order, joined with
+     * the donor's state and country. Used to build and top up ReportingSnapshot.
+     * @param visitor Called once per donation; return false to stop early.
+     * @return The number of rows visited.
      */
-    DonationDialog(QWidget* parent = nullptr);
+    std::size_t visitReportRows(int afterDonationId, const std::function<bool(const ReportRow&)>& visitor);
 
     /**
-     * @brief Validates the input fields in the dialog.
-     * @return True if all inputs are valid, false otherwise.
+     * @brief Writes donors or donations to a CSV or NDJSON extract, optionally gzip-compressed.
+     * Rows are streamed from the cursor into a buffered writer, so memory stays constant
+     * however many rows are exported. Amounts are exact decimals ("1234.56").
+     * @param options Table, format, compression and date/donor filters.
+     * @param path Output file, or "-" for stdout.
+     * @return Row and byte counts, or the error that stopped the export.
      */
-    bool validateInputs();
+    ExportResult exportRows(const ExportOptions& options, const std::string& path);
 
-    // Public QLineEdit and QDateEdit pointers for input fields.
-    QLineEdit* idEdit;
-    QLineEdit* donorIdEdit;
-    QLineEdit* amountEdit;
-    QDateEdit* dateEdit; // Using QDateEdit for date input.
-    QLineEdit* paymentMethodEdit;
+    /**
+     * @brief Sends the rows changed since the last push to outboxDirectory as changesets
+     * (see ChangeSync), and trims them from the change log once written. A row changed many
+     * times between pushes is sent once, as it is now, so the size of a push follows the
+     * number of changed rows rather than the size of the database.
+     * @param outboxDirectory The chapter's outbox; created if missing.
+     * @param options Changeset size and compression.
+     * @return Change, file and byte counts, or the error that stopped the push.
+     */
+    SyncResult pushChanges(const std::string& outboxDirectory, const SyncOptions& options = SyncOptions());
 
-signals:
-    // Signal emitted when a donation is successfully saved (added or updated).
-    void donationSaved(int id);
-};
+    /**
+     * @brief Applies a chapter's changeset to this database, its central copy, in one transaction.
+     * @param path A changeset written by pushChanges.
+     * @return The number of changes applied; skipped is 1 for a changeset the copy already has.
+     */
+    SyncResult applyChangeset(const std::string& path);
 
-/**
- * @brief The OrganizationDialog class provides a dialog for setting or updating organization details.
- */
-class OrganizationDialog : public QDialog {
-    Q_OBJECT // Enables Qt's meta-object system.
+    /**
+     * @brief Sets the sink used for this tracker's error reports.
+     * @param sink The new sink; an empty function silences errors.
+     */
+    void setErrorSink(ErrorSink sink) { errorSink = std::move(sink); }
 
-public:
     /**
-     * @brief Constructor for OrganizationDialog.
-     * @param parent The parent widget.
+     * @brief Installs a check that can abandon the statements this tracker runs.
+     * While a check is installed SQLite polls it every few thousand virtual-machine steps;
+     * once it returns true the running statement fails with SQLITE_INTERRUPT, so a query
+     * whose result is no longer wanted (e.g. a search superseded by more typing) stops within
+     * microseconds instead of running to completion. Errors reported after an interruption
+     * are dropped: the caller asked for it. Must be called on the tracker's own thread; the
+     * check itself must be thread-safe if it reads state set elsewhere.
+     * @param check Returns true to interrupt; an empty function removes the check.
      */
-    OrganizationDialog(QWidget* parent = nullptr);
+    void setCancelCheck(std::function<bool()> check);
+    bool wasCanceled() const { return canceledByCheck; } // The installed check has interrupted a statement.
 
     /**
-     * @brief Validates the input fields in the dialog.
-     * @return True if all inputs are valid, false otherwise.
+     * @brief Sets the sink that newly constructed trackers start with (thread-safe).
+     * Install it before creating trackers so errors from the constructor are routed too.
+     * The initial default logs through qWarning().
      */
-    bool validateInputs();
+    static void setDefaultErrorSink(ErrorSink sink);
 
-    // Public QLineEdit pointers for organization details.
-    QLineEdit* nameEdit;
-    QLineEdit* streetEdit;
-    QLineEdit* cityEdit;
-    QLineEdit* stateEdit;
-    QLineEdit* zipEdit;
-    QLineEdit* countryEdit;
-};
+    /**
+     * @brief Returns a copy of the current default error sink.
+     */
+    static ErrorSink defaultErrorSink();
 
-/**
- * @brief The MainWindow class represents the main application window.
- * It orchestrates the UI, handles user interactions, and communicates with the DonationTracker backend.
- */
-class MainWindow : public QMainWindow {
-    Q_OBJECT // Enables Qt's meta-object system for signals and slots.
+    /**
+     * @brief Applies a connection profile (journal mode, sync level, cache, mmap, temp store).
+     * Can be switched at runtime, e.g. to BulkLoad around an import; must not be called
+     * inside an open transaction.
+     * @param newProfile The profile to apply.
+     * @return True if every pragma was applied.
+     */
+    bool applyConnectionProfile(ConnectionProfile newProfile);
 
-public:
     /**
-     * @brief Constructor for MainWindow.
-     * @param parent The parent widget.
-     */
-    MainWindow(QWidget* parent = nullptr);
-
-private slots:
-    // Slots for handling button clicks and other UI events.
-    void addDonor();
-    void editDonor();
-    void deleteDonor();
-    void addDonation();
-    void editDonation();
-    void deleteDonation();
-    void generateLetters();
-    void setOrganization();
-    void search(); // Slot for initiating a donor search.
-
-    // Slots for navigating through donor records.
-    void loadFirstDonor();
-    void loadPreviousDonor();
-    void loadNextDonor();
-    void loadLastDonor();
-
-    // Slots for handling item clicks in the donor and donation tables.
-    void onDonorTableItemClicked(QTableWidgetItem* item);
-    void onDonationTableItemClicked(QTableWidgetItem* item);
+     * @brief Returns the profile currently applied to the connection.
+     */
+    ConnectionProfile getConnectionProfile() const { return profile; }
 
-private:
-    DonationTracker* tracker; // Instance of the backend database tracker.
-    QLabel* orgDetailsLabel; // Label to display organization details.
-    void updateOrganizationDisplay(); // Helper to refresh the organization details display.
-
-    // Donor Details fields displayed in the main window.
-    QLineEdit* donorIdEdit;
-    QLineEdit* donorFirstNameEdit;
-    QLineEdit* donorLastNameEdit;
-    QLineEdit* donorStreetEdit;
-    QLineEdit* donorCityEdit;
-    QLineEdit* donorStateEdit;
-    QLineEdit* donorZipEdit;
-    QLineEdit* donorCountryEdit;
-    QLineEdit* donorPhoneEdit;
-    QLineEdit* donorEmailEdit;
-
-    // Table for displaying search results (donors).
-    QTableWidget* table;
-
-    // Table for displaying donations of a selected donor.
-    QTableWidget* donationsTable;
-
-    // Search fields for filtering donor records.
-    QLineEdit* searchField;
-    QLineEdit* searchValue;
-
-    // Navigation buttons for Browse donor records.
-    QPushButton* firstButton;
-    QPushButton* previousButton;
-    QPushButton* nextButton;
-    QPushButton* lastButton;
-
-    // Donor navigation logic.
-    std::vector<int> donorIds; // Stores IDs of all donors for navigation.
-    int currentDonorIndex; // Current index in the donorIds vector.
-    int currentDonorId; // Store the ID of the currently loaded donor.
-
-    void populateDonorIds(); // Populates the donorIds vector.
-    void loadDonor(int id); // Loads donor details and their donations into the UI.
-    void updateNavigationButtonStates(); // Enables/disables navigation buttons based on current position.
+    /**
+     * @brief Parses a profile name: "interactive", "bulk-load" or "read-only" (alias "reporting").
+     * @param name The name to parse (case-insensitive).
+     * @param result Set to the parsed profile on success.
+     * @return True if the name was recognised.
+     */
+    static bool connectionProfileFromString(const std::string& name, ConnectionProfile& result);
+
+    /**
+     * @brief Returns the canonical name of a profile, as accepted by connectionProfileFromString.
+     */
+    static const char* connectionProfileName(ConnectionProfile profile);
+
+    /**
+     * @brief Returns the schema version of the open database (PRAGMA user_version).
+     */
+    int getSchemaVersion();
+
+    /**
+     * @brief Number of statement lookups that reused an already-prepared statement.
+     */
+    std::size_t getStatementCacheHits() const { return statementCacheHits; }
+
+    /**
+     * @brief Number of statement lookups that had to call sqlite3_prepare.
+     * Once warmed up this should stay flat; a steadily growing count means SQL text is
+     * being built per call (e.g. with values inlined) instead of bound as parameters.
+     */
+    std::size_t getStatementCacheMisses() const { return statementCacheMisses; }
+
+    /**
+     * @brief Finalizes all cached prepared statements. They are re-prepared on next use.
+     */
+    void clearStatementCache();
+
+    /**
+     * @brief Sets how many donors (with their donation lists) the record cache keeps.
+     * The cache sees every write made through this tracker. Writes made through another
+     * connection (e.g. the GUI's tracker, seen from DatabaseWorker) must be reported with
+     * invalidateCachedDonor or clearDonorCache. 0 disables caching. Default: 256.
+     */
+    void setDonorCacheCapacity(std::size_t capacity);
+    void invalidateCachedDonor(int donorId); // Drops one donor and their donation list from the cache.
+    void clearDonorCache(); // Drops every cached donor.
+    std::size_t getDonorCacheHits() const { return donorCacheHits; } // Lookups answered from the cache.
+    std::size_t getDonorCacheMisses() const { return donorCacheMisses; } // Lookups that went to SQLite.
+
+    /**
+     * @brief Enables or disables statement statistics and the slow-query log on this connection.
+     * Every statement the tracker runs is timed by SQLite itself (sqlite3_trace_v2 profile
+     * events), including those inside imports and migrations. Collected statistics are kept
+     * when the options change; see resetQueryStats.
+     */
+    void setQueryProfiling(const QueryProfilingOptions& options);
+    const QueryProfilingOptions& getQueryProfiling() const { return queryProfiler.options(); }
+
+    /**
+     * @brief Sets the profiling options newly constructed trackers start with (thread-safe).
+     * Install them before creating trackers so schema migrations are profiled too. Trackers
+     * whose options name a statsPath append their statistics there when destroyed. The
+     * initial default profiles nothing.
+     */
+    static void setDefaultQueryProfiling(const QueryProfilingOptions& options);
+    static QueryProfilingOptions defaultQueryProfiling();
+
+    /**
+     * @brief Per-statement call counts, rows and latencies, slowest total time first.
+     */
+    std::vector<QueryStats> getQueryStats() const { return queryProfiler.stats(); }
+    void resetQueryStats() { queryProfiler.reset(); }
+
+    /**
+     * @brief Appends the statistics as a table, headed by the database path and profile.
+     * @param path File to append to, or "-" for stderr.
+     * @return True if the table was written.
+     */
+    bool dumpQueryStats(const std::string& path) const;
+
+signals:
+    // Change notifications emitted after a successful write, so views can patch the
+    // affected row instead of reloading everything.
+    void donorAdded(int id); // New donor ID (from sqlite3_last_insert_rowid).
+    void donorUpdated(int id);
+    void donorDeleted(int id); // Its donations were removed by ON DELETE CASCADE.
+    void donationAdded(int id, int donorId);
+    void donationUpdated(int id, int donorId);
+    void donationDeleted(int id);
+    void donationsImported(int count); // Emitted once per bulk import rather than per row.
 };
 
 #endif // DONATION_TRACKER_H
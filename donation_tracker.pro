@@ -17,8 +17,6 @@
 QT += core gui widgets sql
 TARGET = donation_tracker
 TEMPLATE = app
-SOURCES += main.cpp
-HEADERS += donation_tracker.h
-LIBS += -lsqlite3
-QMAKE_CXXFLAGS += -fPIC
-DEFINES += APP_VERSION=\\\"0.1.0\\\"
+include(backend.pri)
+SOURCES += main.cpp donor_table_model.cpp
+HEADERS += main_window.h donor_table_model.h
@@ -0,0 +1,100 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donation_tracker_widgets.cpp
+// DonationTracker methods that fill QTableWidgets. Kept out of donation_tracker.cpp so the
+// backend builds without QtWidgets (CONFIG += headless, e.g. the command-line tool).
+
+#include "donation_tracker.h"
+#include <QTableWidget> // Tables filled by these methods.
+#include <QHeaderView>  // For customizing table headers.
+
+/**
+ * @brief Searches for donors based on a given search term across multiple fields
+ * (first name, last name, email, phone, city, state, zip, country).
+ * Populates the provided QTableWidget with the search results, best matches first.
+ * If includeAll is true or searchTerm is empty, all donors are returned.
+ * @param searchTerm The words to search for (case-insensitive, each matching a word prefix).
+ * @param table Pointer to the QTableWidget to display results.
+ * @param includeAll If true, bypasses the search term and fetches all donors.
+ */
+void DonationTracker::searchDonors(const std::string& searchTerm, QTableWidget* table, bool includeAll) {
+    table->setRowCount(0); // Clear existing rows in the table.
+    table->setColumnCount(10); // Set the number of columns if not already set.
+    // Set header labels for the table.
+    table->setHorizontalHeaderLabels({"ID", "First Name", "Last Name", "Street", "City", "State", "ZIP", "Country", "Phone", "Email"});
+    table->horizontalHeader()->setStretchLastSection(true); // Make the last section stretch to fill available space.
+    table->setSelectionBehavior(QAbstractItemView::SelectRows); // Select entire rows.
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers); // Make table read-only.
+
+    // Same query path as the paged donor grid: full-text ranked search, or all donors by name.
+    // Each cell is decoded once, from the batch's UTF-8 text straight into its QString.
+    DonorPageCursor cursor;
+    cursor.searchTerm = includeAll ? std::string() : searchTerm;
+    RowBatch batch;
+    while (!cursor.atEnd) {
+        fetchDonorBatch(cursor, 1000, batch);
+        int first = table->rowCount();
+        table->setRowCount(first + batch.size());
+        for (int i = 0; i < batch.size(); ++i) {
+            table->setItem(first + i, 0, new QTableWidgetItem(QString::number(batch.integer(i, 0)))); // ID
+            for (int column = 1; column < 10; ++column) { // First name to email, in the header's order.
+                table->setItem(first + i, column, new QTableWidgetItem(batch.text(i, column).toQString()));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Retrieves all donations for a given donor and populates a QTableWidget.
+ * Thin synchronous wrapper over fetchDonationsForDonor and fillDonationsTable.
+ * @param donorId The ID of the donor whose donations are to be retrieved.
+ * @param table The QTableWidget to populate with donation records.
+ */
+void DonationTracker::getDonationsForDonor(int donorId, QTableWidget* table) {
+    fillDonationsTable(fetchDonationsForDonor(donorId), table);
+}
+
+/**
+ * @brief Fills a QTableWidget with donation records, replacing its previous contents.
+ * @param donations The donations to show, in display order.
+ * @param table The QTableWidget to populate.
+ */
+void DonationTracker::fillDonationsTable(const std::vector<DonationRecord>& donations, QTableWidget* table) {
+    table->clearContents(); // Clear existing content in the table.
+    table->setRowCount(0); // Reset row count.
+    table->setColumnCount(5); // Set the number of columns.
+    // Set header labels for the donations table.
+    table->setHorizontalHeaderLabels({"ID", "Donor ID", "Amount", "Date", "Payment Method"});
+    table->horizontalHeader()->setStretchLastSection(true);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    table->setRowCount(static_cast<int>(donations.size()));
+    int row = 0;
+    // Populate the table with donation data.
+    for (const DonationRecord& donation : donations) {
+        table->setItem(row, 0, new QTableWidgetItem(QString::number(donation.id))); // ID
+        table->setItem(row, 1, new QTableWidgetItem(QString::number(donation.donorId))); // Donor ID
+        table->setItem(row, 2, new QTableWidgetItem(QString::fromStdString(formatCents(donation.amountCents)))); // Amount (formatted)
+        table->setItem(row, 3, new QTableWidgetItem(QString::fromStdString(donation.date))); // Date
+        table->setItem(row, 4, new QTableWidgetItem(QString::fromStdString(donation.paymentMethod))); // Payment Method
+        row++;
+    }
+}
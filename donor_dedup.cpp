@@ -0,0 +1,255 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donor_dedup.cpp
+// Implementation of DonorMatcher, the field normalization and similarity scoring of duplicate detection.
+
+#include "donor_dedup.h"
+#include "donation_tracker.h" // DonorRecord.
+#include <QThread> // idealThreadCount for the comparison pool.
+#include <QThreadPool> // Scores chunks of pairs in parallel.
+#include <algorithm> // std::max, std::min, std::sort.
+
+// Weights of the similarity signals; only signals present on both records count.
+static const double nameWeight = 0.6;
+static const double streetWeight = 0.15;
+static const double zipWeight = 0.05;
+static const double emailWeight = 0.1;
+static const double phoneWeight = 0.1;
+
+/**
+ * @brief Donor fields in the form they are compared in, computed once per donor.
+ */
+struct MatchFields {
+    std::string name; // "first last", normalized.
+    std::string street;
+    std::string zip; // First five characters.
+    std::string email; // Lower case, trimmed.
+    std::string phone; // Last ten digits.
+};
+
+/**
+ * @brief Lower-cases ASCII letters, turns other ASCII punctuation into single spaces and
+ * trims, so "O'Brien,  Pat" and "o brien pat" compare equal. Non-ASCII bytes are kept.
+ */
+static std::string normalizeText(const std::string& text) {
+    std::string normalized;
+    normalized.reserve(text.size());
+    bool space = false;
+    for (unsigned char c : text) {
+        bool keep = c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        if (!keep) {
+            space = !normalized.empty();
+            continue;
+        }
+        if (space) {
+            normalized += ' ';
+            space = false;
+        }
+        normalized += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : static_cast<char>(c);
+    }
+    return normalized;
+}
+
+/**
+ * @brief The last ten digits of a phone number, or "" if it has fewer than seven.
+ * Same rule as the phone blocking key.
+ */
+static std::string phoneDigits(const std::string& phone) {
+    std::string digits;
+    for (char c : phone) {
+        if (c >= '0' && c <= '9') {
+            digits += c;
+        }
+    }
+    if (digits.size() < 7) {
+        return std::string();
+    }
+    return digits.size() > 10 ? digits.substr(digits.size() - 10) : digits;
+}
+
+/**
+ * @brief An e-mail address lower-cased and trimmed, like the e-mail blocking key.
+ */
+static std::string emailKey(const std::string& email) {
+    std::size_t first = email.find_first_not_of(' ');
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    std::string key = email.substr(first, email.find_last_not_of(' ') - first + 1);
+    for (char& c : key) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return key;
+}
+
+static MatchFields matchFields(const DonorRecord& donor) {
+    MatchFields fields;
+    fields.name = normalizeText(donor.firstName + " " + donor.lastName);
+    fields.street = normalizeText(donor.street);
+    fields.zip = normalizeText(donor.zip).substr(0, 5);
+    fields.email = emailKey(donor.email);
+    fields.phone = phoneDigits(donor.phone);
+    return fields;
+}
+
+/**
+ * @brief Weighted average of the signals both records have.
+ */
+static double compareFields(const MatchFields& a, const MatchFields& b) {
+    double score = 0.0;
+    double weight = 0.0;
+    if (!a.name.empty() && !b.name.empty()) {
+        score += nameWeight * DonorMatcher::jaroWinkler(a.name, b.name);
+        weight += nameWeight;
+    }
+    if (!a.street.empty() && !b.street.empty()) {
+        score += streetWeight * DonorMatcher::jaroWinkler(a.street, b.street);
+        weight += streetWeight;
+    }
+    if (!a.zip.empty() && !b.zip.empty()) {
+        score += a.zip == b.zip ? zipWeight : 0.0;
+        weight += zipWeight;
+    }
+    if (!a.email.empty() && !b.email.empty()) {
+        score += a.email == b.email ? emailWeight : 0.0;
+        weight += emailWeight;
+    }
+    if (!a.phone.empty() && !b.phone.empty()) {
+        score += a.phone == b.phone ? phoneWeight : 0.0;
+        weight += phoneWeight;
+    }
+    return weight > 0.0 ? score / weight : 0.0;
+}
+
+/**
+ * @brief Jaro similarity with the Winkler bonus for a common prefix of up to four characters.
+ */
+double DonorMatcher::jaroWinkler(const std::string& a, const std::string& b) {
+    if (a.empty() && b.empty()) {
+        return 1.0;
+    }
+    if (a.empty() || b.empty()) {
+        return 0.0;
+    }
+    const int lengthA = static_cast<int>(a.size());
+    const int lengthB = static_cast<int>(b.size());
+    const int window = std::max(0, std::max(lengthA, lengthB) / 2 - 1);
+    std::vector<char> matchedA(a.size(), 0);
+    std::vector<char> matchedB(b.size(), 0);
+
+    int matches = 0;
+    for (int i = 0; i < lengthA; ++i) {
+        int end = std::min(i + window + 1, lengthB);
+        for (int j = std::max(0, i - window); j < end; ++j) {
+            if (!matchedB[j] && a[i] == b[j]) {
+                matchedA[i] = matchedB[j] = 1;
+                ++matches;
+                break;
+            }
+        }
+    }
+    if (matches == 0) {
+        return 0.0;
+    }
+
+    int transpositions = 0; // Matched characters that appear in a different order, counted twice.
+    for (int i = 0, j = 0; i < lengthA; ++i) {
+        if (!matchedA[i]) {
+            continue;
+        }
+        while (!matchedB[j]) {
+            ++j;
+        }
+        if (a[i] != b[j]) {
+            ++transpositions;
+        }
+        ++j;
+    }
+    double m = matches;
+    double jaro = (m / lengthA + m / lengthB + (m - transpositions / 2.0) / m) / 3.0;
+
+    int prefix = 0;
+    while (prefix < 4 && prefix < lengthA && prefix < lengthB && a[prefix] == b[prefix]) {
+        ++prefix;
+    }
+    return jaro + prefix * 0.1 * (1.0 - jaro);
+}
+
+double DonorMatcher::similarity(const DonorRecord& a, const DonorRecord& b) {
+    return compareFields(matchFields(a), matchFields(b));
+}
+
+/**
+ * @brief Normalizes each candidate donor once, then scores the pairs in chunks on a thread pool.
+ * Every chunk writes to its own result vector, so the threads share nothing but read-only input.
+ */
+std::vector<DuplicatePair> DonorMatcher::scorePairs(const std::unordered_map<int, DonorRecord>& donors,
+                                                   const std::vector<CandidatePair>& pairs, const DedupOptions& options) {
+    std::unordered_map<int, MatchFields> fields;
+    fields.reserve(donors.size());
+    for (const auto& donor : donors) {
+        fields.emplace(donor.first, matchFields(donor.second));
+    }
+
+    int threads = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+    // A few chunks per thread evens out blocks that are slower to compare than others.
+    std::size_t chunkSize = std::max<std::size_t>(1024, pairs.size() / (static_cast<std::size_t>(threads) * 4) + 1);
+    std::size_t chunkCount = (pairs.size() + chunkSize - 1) / chunkSize;
+    std::vector<std::vector<DuplicatePair>> chunkResults(chunkCount);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        pool.start([&, chunk]() {
+            std::size_t end = std::min(pairs.size(), (chunk + 1) * chunkSize);
+            for (std::size_t i = chunk * chunkSize; i < end; ++i) {
+                auto first = fields.find(pairs[i].firstId);
+                auto second = fields.find(pairs[i].secondId);
+                if (first == fields.end() || second == fields.end()) {
+                    continue; // Deleted since the blocks were read.
+                }
+                double score = compareFields(first->second, second->second);
+                if (score >= options.threshold) {
+                    DuplicatePair match;
+                    match.keepId = pairs[i].firstId;
+                    match.duplicateId = pairs[i].secondId;
+                    match.score = score;
+                    match.blocks = pairs[i].blocks;
+                    chunkResults[chunk].push_back(match);
+                }
+            }
+        });
+    }
+    pool.waitForDone();
+
+    std::vector<DuplicatePair> matches;
+    for (const std::vector<DuplicatePair>& chunk : chunkResults) {
+        matches.insert(matches.end(), chunk.begin(), chunk.end());
+    }
+    std::sort(matches.begin(), matches.end(), [](const DuplicatePair& a, const DuplicatePair& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        return a.keepId != b.keepId ? a.keepId < b.keepId : a.duplicateId < b.duplicateId;
+    });
+    return matches;
+}
@@ -0,0 +1,109 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donor_dedup.h
+#ifndef DONOR_DEDUP_H
+#define DONOR_DEDUP_H
+
+#include <cstddef> // std::size_t.
+#include <string> // Donor fields and match reasons.
+#include <unordered_map> // Candidate donors by ID.
+#include <vector> // Candidate and duplicate pairs.
+
+struct DonorRecord;
+
+// Blocking keys two donors can share; a pair is only compared if it shares at least one.
+enum DuplicateBlock : unsigned {
+    BlockEmail = 1u << 0, // Same e-mail address, ignoring case and surrounding spaces.
+    BlockPhone = 1u << 1, // Same last ten phone digits.
+    BlockNameZip = 1u << 2 // Same last name and five-digit ZIP.
+};
+
+/**
+ * @brief Tuning of DonationTracker::findDuplicateDonors.
+ */
+struct DedupOptions {
+    double threshold = 0.85; // Minimum similarity (0-1) for a pair to be reported.
+    // Blocks larger than this are skipped rather than compared pairwise; they are placeholder
+    // values ("none@none.com", a shared office phone) that would make detection quadratic.
+    int maxBlockSize = 200;
+    int threads = 0; // Comparison threads; 0 means one per core.
+};
+
+/**
+ * @brief Two donors that share a blocking key, before scoring.
+ */
+struct CandidatePair {
+    int firstId = 0; // The lower ID.
+    int secondId = 0;
+    unsigned blocks = 0; // DuplicateBlock bits the two share.
+};
+
+/**
+ * @brief A likely duplicate: merging would keep keepId and fold duplicateId into it.
+ */
+struct DuplicatePair {
+    int keepId = 0; // The older (lower) ID.
+    int duplicateId = 0;
+    double score = 0.0; // Similarity, 0-1.
+    unsigned blocks = 0; // DuplicateBlock bits the two share.
+};
+
+/**
+ * @brief Outcome of a duplicate scan.
+ */
+struct DedupResult {
+    std::vector<DuplicatePair> pairs; // Highest score first.
+    std::size_t blocks = 0; // Blocking-key groups with two or more donors.
+    std::size_t skippedBlocks = 0; // Groups over maxBlockSize, not compared.
+    std::size_t candidatePairs = 0; // Distinct pairs compared.
+    double elapsedSeconds = 0.0;
+};
+
+/**
+ * @brief The similarity kernel behind DonationTracker::findDuplicateDonors.
+ * Fields are normalized (ASCII case folding, punctuation to spaces), names and streets are
+ * compared with Jaro-Winkler, and ZIP, e-mail and phone by equality. A field missing on
+ * either side is left out of the weighted average instead of counting as a mismatch, so a
+ * record typed without an e-mail still matches its complete twin.
+ */
+class DonorMatcher {
+public:
+    /**
+     * @brief Jaro-Winkler similarity of two strings (1 = identical, 0 = nothing in common).
+     */
+    static double jaroWinkler(const std::string& a, const std::string& b);
+
+    /**
+     * @brief Similarity of two donor records, 0-1.
+     */
+    static double similarity(const DonorRecord& a, const DonorRecord& b);
+
+    /**
+     * @brief Scores candidate pairs in parallel and keeps those at or above the threshold.
+     * @param donors Every donor named by a pair.
+     * @param pairs Pairs to score.
+     * @param options Threshold and thread count.
+     * @return The matching pairs, highest score first.
+     */
+    static std::vector<DuplicatePair> scorePairs(const std::unordered_map<int, DonorRecord>& donors,
+                                                 const std::vector<CandidatePair>& pairs, const DedupOptions& options);
+};
+
+#endif // DONOR_DEDUP_H
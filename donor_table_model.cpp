@@ -0,0 +1,350 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donor_table_model.cpp
+// Implementation of DonorTableModel, the paged model behind the main donor table.
+
+#include "donor_table_model.h"
+#include <QFutureWatcher> // Delivers worker pages back on the GUI thread.
+#include <algorithm> // std::lower_bound, std::find_if.
+#include <tuple> // std::tie for comparing listing keys.
+
+/**
+ * @brief Orders donors the way the listing does: (first_name, last_name, id).
+ * std::string compares bytes like SQLite's default BINARY collation.
+ */
+static bool listingLess(const DonorRecord& a, const DonorRecord& b) {
+    return std::tie(a.firstName, a.lastName, a.id) < std::tie(b.firstName, b.lastName, b.id);
+}
+
+/**
+ * @brief Constructor for DonorTableModel.
+ * The model starts empty; call setSearchTerm() to load the first page.
+ * @param tracker The GUI-thread backend, used for single-donor reads.
+ * @param worker The worker thread that fetches listing pages.
+ * @param parent The parent object.
+ */
+DonorTableModel::DonorTableModel(DonationTracker* tracker, DatabaseWorker* worker, QObject* parent)
+    : QAbstractTableModel(parent), tracker(tracker), worker(worker), fetchPending(false), listingGeneration(0) {
+    cursor.atEnd = true; // Nothing to fetch until a listing is started.
+}
+
+/**
+ * @brief Returns the number of rows loaded so far (not the total number of matches).
+ */
+int DonorTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+/**
+ * @brief Returns the number of columns: ID plus the nine donor fields.
+ */
+int DonorTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : 10;
+}
+
+/**
+ * @brief Returns the display text for a cell.
+ */
+QVariant DonorTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole || index.row() >= static_cast<int>(rows.size())) {
+        return QVariant();
+    }
+
+    const DonorRecord& donor = rows[index.row()];
+    switch (index.column()) {
+    case 0: return donor.id;
+    case 1: return QString::fromStdString(donor.firstName);
+    case 2: return QString::fromStdString(donor.lastName);
+    case 3: return QString::fromStdString(donor.street);
+    case 4: return QString::fromStdString(donor.city);
+    case 5: return QString::fromStdString(donor.state);
+    case 6: return QString::fromStdString(donor.zip);
+    case 7: return QString::fromStdString(donor.country);
+    case 8: return QString::fromStdString(donor.phone);
+    case 9: return QString::fromStdString(donor.email);
+    default: return QVariant();
+    }
+}
+
+/**
+ * @brief Returns the column titles for the horizontal header.
+ */
+QVariant DonorTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    static const char* const titles[] = {"ID", "First Name", "Last Name", "Street", "City", "State", "ZIP", "Country", "Phone", "Email"};
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Horizontal) {
+        return (section >= 0 && section < 10) ? QVariant(titles[section]) : QVariant();
+    }
+    return section + 1; // Row numbers down the side.
+}
+
+/**
+ * @brief True while the current listing has rows that have not been requested yet.
+ */
+bool DonorTableModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !cursor.atEnd && !fetchPending;
+}
+
+/**
+ * @brief Requests the next page of the listing from the worker thread.
+ * Returns at once; the rows are appended by appendPage() when they arrive.
+ */
+void DonorTableModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || cursor.atEnd || fetchPending) {
+        return;
+    }
+
+    fetchPending = true;
+    int generation = listingGeneration;
+    auto* watcher = new QFutureWatcher<DonorPage>(this);
+    connect(watcher, &QFutureWatcher<DonorPage>::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != listingGeneration || watcher->isCanceled()) {
+            return; // Superseded by a new search.
+        }
+        fetchPending = false;
+        appendPage(watcher->result());
+    });
+    pendingPage = worker->searchDonors(cursor, pageSize);
+    watcher->setFuture(pendingPage);
+}
+
+/**
+ * @brief Appends a page delivered by the worker and adopts its advanced cursor.
+ */
+void DonorTableModel::appendPage(DonorPage&& page) {
+    cursor = std::move(page.cursor);
+    if (page.rows.empty()) {
+        return;
+    }
+
+    int first = static_cast<int>(rows.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(page.rows.size()) - 1);
+    rows.insert(rows.end(), std::make_move_iterator(page.rows.begin()), std::make_move_iterator(page.rows.end()));
+    endInsertRows();
+}
+
+/**
+ * @brief Discards the loaded rows and starts a new listing for searchTerm.
+ * A page still in flight for the previous listing is canceled (or dropped on arrival).
+ */
+void DonorTableModel::setSearchTerm(const std::string& searchTerm) {
+    if (refineSearch(searchTerm)) {
+        return;
+    }
+    if (fetchPending) {
+        pendingPage.cancel(); // The worker skips it if it has not started yet.
+    }
+    ++listingGeneration;
+    fetchPending = false;
+
+    beginResetModel();
+    rows.clear();
+    rows.shrink_to_fit(); // Give back memory from a long previous listing.
+    cursor = DonorPageCursor();
+    cursor.searchTerm = searchTerm;
+    endResetModel();
+    fetchMore(QModelIndex()); // Request the first page straight away.
+}
+
+/**
+ * @brief Checks a donor against already tokenized search words with the same rule as the
+ * full-text search: every word must start a word in one of the searched fields, with
+ * diacritics folded on both sides (see DonationTracker::searchTokens). With the LIKE
+ * fallback this is slightly stricter than the SQL, which only costs a missed live insert
+ * until the next search.
+ * @param terms The search words, from DonationTracker::searchTokens; empty matches everyone.
+ */
+static bool matchesTokens(const DonorRecord& donor, const std::vector<std::string>& terms) {
+    if (terms.empty()) {
+        return true;
+    }
+    std::vector<std::string> words;
+    for (const std::string* field : {&donor.firstName, &donor.lastName, &donor.email, &donor.phone,
+                                     &donor.city, &donor.state, &donor.zip, &donor.country}) {
+        std::vector<std::string> fieldWords = DonationTracker::searchTokens(*field);
+        words.insert(words.end(), fieldWords.begin(), fieldWords.end());
+    }
+    for (const std::string& term : terms) {
+        bool found = std::any_of(words.begin(), words.end(),
+                                 [&term](const std::string& word) { return word.compare(0, term.size(), term) == 0; });
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Narrows a complete full-text listing to searchTerm without a query.
+ * Every word of the old term must be a prefix of a word of the new one: then a donor
+ * matching the new term also matches the old, so it is already loaded. Only complete
+ * ranked listings qualify, not one ended by a read error. A keyset page would miss matches
+ * beyond the last loaded row, and the LIKE fallback matches substrings, which matchesTokens
+ * does not reproduce.
+ * @return True if the rows were filtered; false if a new listing is needed.
+ */
+bool DonorTableModel::refineSearch(const std::string& searchTerm) {
+    if (!cursor.started || !cursor.atEnd || cursor.failed || !cursor.ranked || fetchPending) {
+        return false;
+    }
+    std::vector<std::string> oldTerms = DonationTracker::searchTokens(cursor.searchTerm);
+    std::vector<std::string> newTerms = DonationTracker::searchTokens(searchTerm);
+    if (oldTerms.empty() || newTerms.empty()) {
+        return false;
+    }
+    for (const std::string& oldTerm : oldTerms) {
+        bool narrowed = std::any_of(newTerms.begin(), newTerms.end(),
+                                    [&oldTerm](const std::string& term) { return term.compare(0, oldTerm.size(), oldTerm) == 0; });
+        if (!narrowed) {
+            return false;
+        }
+    }
+
+    cursor.searchTerm = searchTerm;
+    // Remove runs of rows that no longer match, from the bottom so row numbers stay valid.
+    int end = static_cast<int>(rows.size());
+    while (end > 0) {
+        if (matchesTokens(rows[end - 1], newTerms)) {
+            --end;
+            continue;
+        }
+        int start = end - 1;
+        while (start > 0 && !matchesTokens(rows[start - 1], newTerms)) {
+            --start;
+        }
+        beginRemoveRows(QModelIndex(), start, end - 1);
+        rows.erase(rows.begin() + start, rows.begin() + end);
+        endRemoveRows();
+        end = start;
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the donor ID for a loaded row, or -1 if out of range.
+ */
+int DonorTableModel::donorIdAt(int row) const {
+    return (row >= 0 && row < static_cast<int>(rows.size())) ? rows[row].id : -1;
+}
+
+/**
+ * @brief Checks a single donor against the current search term (see matchesTokens).
+ */
+bool DonorTableModel::matchesSearch(const DonorRecord& donor) const {
+    return matchesTokens(donor, DonationTracker::searchTokens(cursor.searchTerm));
+}
+
+/**
+ * @brief Inserts a donor at its sorted position among the loaded rows.
+ * A donor that sorts after the last loaded row while more pages remain is skipped:
+ * the cursor resumes after that row, so the donor will arrive with a later page.
+ * Relevance-ranked search results have no position to compute, so a new match is
+ * appended once the listing is complete and otherwise left to the next search.
+ */
+void DonorTableModel::placeDonor(DonorRecord&& donor) {
+    if (cursor.ranked) {
+        if (cursor.atEnd) {
+            int row = static_cast<int>(rows.size());
+            beginInsertRows(QModelIndex(), row, row);
+            rows.push_back(std::move(donor));
+            endInsertRows();
+        }
+        return;
+    }
+    auto it = std::lower_bound(rows.begin(), rows.end(), donor, listingLess);
+    if (it == rows.end() && !cursor.atEnd) {
+        return;
+    }
+    int row = static_cast<int>(it - rows.begin());
+    beginInsertRows(QModelIndex(), row, row);
+    rows.insert(it, std::move(donor));
+    endInsertRows();
+}
+
+/**
+ * @brief Returns the row showing the given donor, or -1 if it is not loaded.
+ */
+int DonorTableModel::rowOfDonor(int id) const {
+    auto it = std::find_if(rows.begin(), rows.end(), [id](const DonorRecord& donor) { return donor.id == id; });
+    return it == rows.end() ? -1 : static_cast<int>(it - rows.begin());
+}
+
+/**
+ * @brief Adds a newly created donor to the loaded rows if it matches the current search.
+ * @param id The ID of the new donor.
+ */
+void DonorTableModel::insertDonor(int id) {
+    DonorRecord donor;
+    if (!cursor.started || !tracker->getDonorRecord(id, donor) || !matchesSearch(donor)) {
+        return;
+    }
+    placeDonor(std::move(donor));
+}
+
+/**
+ * @brief Re-reads an edited donor and updates its row in place, or moves it if its
+ * sort key changed, or removes it if it no longer matches the search.
+ * @param id The ID of the edited donor.
+ */
+void DonorTableModel::refreshDonor(int id) {
+    if (!cursor.started) {
+        return;
+    }
+    DonorRecord donor;
+    bool exists = tracker->getDonorRecord(id, donor);
+    bool matches = exists && matchesSearch(donor);
+    int row = rowOfDonor(id);
+
+    if (row >= 0 && matches) {
+        // Same slot if it still sorts between its neighbours (ranked lists keep their order):
+        // patch the cells only.
+        bool afterPrev = row == 0 || listingLess(rows[row - 1], donor);
+        bool beforeNext = row + 1 == static_cast<int>(rows.size()) || listingLess(donor, rows[row + 1]);
+        if (cursor.ranked || (afterPrev && beforeNext)) {
+            rows[row] = std::move(donor);
+            emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+            return;
+        }
+    }
+    if (row >= 0) {
+        beginRemoveRows(QModelIndex(), row, row);
+        rows.erase(rows.begin() + row);
+        endRemoveRows();
+    }
+    if (matches) {
+        placeDonor(std::move(donor));
+    }
+}
+
+/**
+ * @brief Removes a deleted donor's row, if loaded.
+ * @param id The ID of the deleted donor.
+ */
+void DonorTableModel::removeDonor(int id) {
+    int row = rowOfDonor(id);
+    if (row >= 0) {
+        beginRemoveRows(QModelIndex(), row, row);
+        rows.erase(rows.begin() + row);
+        endRemoveRows();
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// donor_table_model.h
+#ifndef DONOR_TABLE_MODEL_H
+#define DONOR_TABLE_MODEL_H
+
+#include "database_worker.h" // Pages are fetched off the GUI thread; also DonationTracker and the record types.
+#include <QAbstractTableModel> // Base class for table models used by QTableView.
+#include <vector> // Rows fetched so far.
+
+/**
+ * @brief The DonorTableModel class exposes donors to a QTableView, fetching them in pages.
+ * Only the rows the view has scrolled to are ever read from the database: the view asks for
+ * more through canFetchMore()/fetchMore() as it approaches the end of the loaded rows.
+ * Pages are read by a DatabaseWorker and appended when they arrive, so scrolling and typing
+ * never wait on a query. Resetting the search term discards the loaded rows and any page
+ * still in flight, and starts a new listing.
+ */
+class DonorTableModel : public QAbstractTableModel {
+    Q_OBJECT // Enables Qt's meta-object system.
+
+public:
+    /**
+     * @brief Constructor for DonorTableModel.
+     * @param tracker The GUI-thread backend, used to re-read single donors on change signals (not owned).
+     * @param worker The worker thread that fetches listing pages (not owned).
+     * @param parent The parent object.
+     */
+    DonorTableModel(DonationTracker* tracker, DatabaseWorker* worker, QObject* parent = nullptr);
+
+    // QAbstractTableModel interface.
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    /**
+     * @brief Starts a new listing filtered by searchTerm (empty lists all donors).
+     * The first page is requested immediately; later pages as the view scrolls. A page
+     * still being read for the previous term is canceled, interrupting its query.
+     * When the previous listing was a complete full-text search and searchTerm only narrows
+     * it (e.g. "smi" becomes "smith"), the loaded rows are filtered in place instead: no
+     * query runs, and the rows keep the previous relevance order.
+     * @param searchTerm The term to filter donors by.
+     */
+    void setSearchTerm(const std::string& searchTerm);
+
+    /**
+     * @brief Returns the donor ID shown in the given row, or -1 if the row is not loaded.
+     */
+    int donorIdAt(int row) const;
+
+public slots:
+    // Incremental updates, connected to DonationTracker's change signals. Each reads at most
+    // one donor row and patches the loaded rows in place.
+    void insertDonor(int id); // Adds a new donor if it falls within the loaded rows.
+    void refreshDonor(int id); // Re-reads a donor and moves/updates/removes its row.
+    void removeDonor(int id); // Drops a deleted donor's row.
+
+    static const int pageSize = 256; // Rows fetched per fetchMore() call.
+
+private:
+    bool matchesSearch(const DonorRecord& donor) const; // Client-side equivalent of the listing filter.
+    bool refineSearch(const std::string& searchTerm); // Filters a complete listing in place; false if it cannot.
+    void placeDonor(DonorRecord&& donor); // Inserts donor at its sorted position if that is within the loaded rows.
+    int rowOfDonor(int id) const; // Row of a loaded donor, or -1.
+    void appendPage(DonorPage&& page); // Adds a page delivered by the worker.
+
+    DonationTracker* tracker; // Backend used for single-donor reads.
+    DatabaseWorker* worker; // Fetches listing pages.
+    DonorPageCursor cursor; // Position of the current listing.
+    std::vector<DonorRecord> rows; // Rows fetched so far, in listing order.
+    QFuture<DonorPage> pendingPage; // Page request in flight, if any.
+    bool fetchPending; // True while pendingPage has not been delivered.
+    int listingGeneration; // Bumped by setSearchTerm() so stale pages are dropped.
+};
+
+#endif // DONOR_TABLE_MODEL_H
@@ -0,0 +1,266 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// letter_generator.cpp
+// This file contains the implementation of the LetterGenerator class, which writes
+// donation letters on a producer thread plus a pool of worker threads.
+
+#include "letter_generator.h"
+#include "sqlite_row.h" // Column text of the organization row.
+#include <QThread>      // Producer thread.
+#include <QThreadPool>  // Worker threads that format and write letters.
+#include <QMutexLocker> // Scoped locking of the error list.
+#include <QDate>        // For the letter date line.
+#include <sqlite3.h>    // The producer reads through its own connection.
+
+static const int maxReportedErrors = 10; // Errors kept for the finished() summary.
+
+/**
+ * @brief Constructor for LetterGenerator.
+ * The worker pool uses one thread per core; up to two batches per worker may be queued
+ * ahead, so workers never wait on the producer and the producer never runs far ahead.
+ */
+LetterGenerator::LetterGenerator(const std::string& dbPath, QObject* parent)
+    : QObject(parent), dbPath(dbPath), producerThread(nullptr), workers(new QThreadPool(this)),
+      queueSlots(2 * QThread::idealThreadCount()), nextBatch(0), running(false), canceled(false), total(0), written(0),
+      failed(0) {
+    workers->setMaxThreadCount(QThread::idealThreadCount());
+}
+
+/**
+ * @brief Destructor for LetterGenerator.
+ * Cancels any running job and waits for the producer and workers to finish.
+ */
+LetterGenerator::~LetterGenerator() {
+    cancel();
+    if (producerThread) {
+        producerThread->wait(); // The producer itself waits for the workers before exiting.
+        delete producerThread;
+    }
+}
+
+/**
+ * @brief Starts generating letters for the given year on the producer thread.
+ * @param year The year for which to aggregate donations.
+ * @param outputDir Directory the letters are written to; created if missing.
+ * @param letterTemplate The letter to write.
+ * @param sinkKind Where the letters go.
+ * @param selection Minimum total, letter order and batch size. A template meant for lapsed
+ * donors restricts the run to them.
+ * @return True if the run was started, false if one is already in progress.
+ */
+bool LetterGenerator::start(int year, const QString& outputDir, const LetterTemplate& letterTemplate, LetterSinkKind sinkKind,
+                            const ReceiptSelection& selection) {
+    if (running.exchange(true)) {
+        return false; // Only one run at a time.
+    }
+    if (producerThread) {
+        producerThread->wait(); // The previous run has emitted finished() and is about to exit.
+        delete producerThread;
+    }
+    canceled = false;
+    total = 0;
+    written = 0;
+    failed = 0;
+    errors.clear();
+    this->letterTemplate = letterTemplate; // No worker is running, so this cannot race.
+    this->selection = selection;
+    this->selection.lapsedOnly = selection.lapsedOnly || letterTemplate.lapsedDonorsOnly();
+    nextBatch = 0;
+
+    producerThread = QThread::create([this, year, outputDir, sinkKind]() { produce(year, outputDir, sinkKind); });
+    producerThread->start();
+    return true;
+}
+
+/**
+ * @brief Asks a running job to stop. Safe to call from any thread.
+ */
+void LetterGenerator::cancel() {
+    canceled = true;
+}
+
+/**
+ * @brief Producer thread body: reads one row per donor and feeds batches to the workers.
+ * The count and the rows are read inside one read transaction so they agree with each
+ * other; under WAL this does not block writers on the GUI connection.
+ */
+void LetterGenerator::produce(int year, const QString& outputDir, LetterSinkKind sinkKind) {
+    std::unique_ptr<LetterSink> sink = LetterSink::create(sinkKind, LetterSink::outputPath(sinkKind, outputDir, year));
+    std::string sinkError;
+    bool sinkOpen = sink->open(&sinkError);
+
+    sqlite3* db = nullptr;
+    if (!sinkOpen) {
+        recordError(QString::fromStdString(sinkError));
+    } else if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        recordError(QString("Cannot open database: %1").arg(sqlite3_errmsg(db)));
+    } else {
+        // Same tuning as the read-only reporting profile: the aggregate is one long scan.
+        sqlite3_exec(db, "PRAGMA query_only=ON; PRAGMA cache_size=-65536; PRAGMA mmap_size=1073741824; "
+                         "PRAGMA temp_store=MEMORY; BEGIN;", nullptr, nullptr, nullptr);
+
+        LetterContext context;
+        context.year = year;
+        context.dateLine = QDate::currentDate().toString("MMMM d, yyyy").toStdString(); // Current date.
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db, "SELECT name, address FROM organization WHERE id=1;", -1, &stmt, nullptr) == SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW) {
+            SqliteRow columns(stmt);
+            columns.copyText(0, context.orgName);
+            columns.copyText(1, context.orgAddress);
+        }
+        sqlite3_finalize(stmt);
+
+        // Number of letters, for the progress range: one donor_year_totals row per selected donor.
+        std::string planError;
+        int count = ReceiptPlanner::countLetters(db, year, selection, &planError);
+        total = count < 0 ? 0 : count;
+        emit started(total);
+
+        // Same selection as DonationTracker::generateDonationLetters. A directory takes its
+        // files in any order; single-file sinks keep the planned order.
+        bool ordered = sinkKind != LetterSinkKind::Directory;
+        bool planned = planError.empty() &&
+                       ReceiptPlanner::plan(db, year, selection, [this, &context, &sink, ordered](ReceiptBatch& batch) {
+                           if (canceled) {
+                               return false;
+                           }
+                           queueSlots.acquire(); // Wait until a worker has room for another batch.
+                           workers->start([this, batch = std::move(batch), context, &sink, ordered]() {
+                               writeBatch(batch, context, *sink, ordered);
+                               queueSlots.release();
+                           });
+                           return true;
+                       }, &planError);
+        if (!planned && !canceled) {
+            recordError(QString::fromStdString(planError));
+        }
+        sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+    }
+    sqlite3_close(db);
+
+    workers->waitForDone(); // Let queued batches finish (they return early once canceled).
+    // Single-file sinks write their index or trailer here; letters kept on cancel stay readable.
+    if (sinkOpen && !sink->close(&sinkError)) {
+        recordError(QString::fromStdString(sinkError));
+    }
+
+    QStringList reported;
+    {
+        QMutexLocker locker(&errorsMutex);
+        reported = errors;
+    }
+    running = false;
+    emit finished(written, failed, canceled, reported);
+}
+
+/**
+ * @brief Worker body: formats one batch of letters into the sink, then reports progress.
+ * With ordered set, the batch is rendered first and written once the batch before it has
+ * been; every batch takes its turn, even when canceled, so no later batch waits forever.
+ * The pool starts batches in sequence order, so the batch whose turn it is always has a thread.
+ */
+void LetterGenerator::writeBatch(const ReceiptBatch& batch, const LetterContext& context, LetterSink& sink, bool ordered) {
+    int batchWritten = 0;
+    int batchFailed = 0;
+    // Letter buffers of this worker thread, kept across batches so their capacity is reused.
+    // Ordered batches render every letter ahead; otherwise one buffer serves the whole batch.
+    static thread_local std::vector<std::string> letters;
+    std::size_t buffers = ordered ? static_cast<std::size_t>(batch.size()) : 1;
+    if (letters.size() < buffers) {
+        letters.resize(buffers);
+    }
+    LetterRow row; // Reused for every letter of the batch, so its fields keep their capacity.
+    if (ordered) {
+        for (int i = 0; i < batch.size() && !canceled; ++i) {
+            batch.letter(i, row);
+            letterTemplate.render(row, context, letters[i]);
+        }
+        QMutexLocker locker(&turnMutex);
+        while (nextBatch != batch.sequence) {
+            turnChanged.wait(&turnMutex);
+        }
+    }
+    for (int i = 0; i < batch.size(); ++i) {
+        if (canceled) {
+            break; // Remaining rows in the batch are skipped, not counted as failures.
+        }
+        batch.letter(i, row);
+        std::string& letter = letters[ordered ? i : 0];
+        if (!ordered) {
+            letterTemplate.render(row, context, letter);
+        }
+        std::string error;
+        if (sink.write(letterFileName(row, context.year, letterTemplate.fileSuffix()), letter, &error)) {
+            ++batchWritten;
+        } else {
+            recordError(QString::fromStdString(error));
+            ++batchFailed;
+        }
+    }
+    if (ordered) {
+        QMutexLocker locker(&turnMutex);
+        ++nextBatch;
+        turnChanged.wakeAll();
+    }
+    // One signal per batch keeps the GUI event queue short on large runs.
+    int done = (written += batchWritten) + (failed += batchFailed);
+    emit progress(done, total);
+}
+
+/**
+ * @brief Keeps the first few failure messages for the finished() summary.
+ */
+void LetterGenerator::recordError(const QString& message) {
+    QMutexLocker locker(&errorsMutex);
+    if (errors.size() < maxReportedErrors) {
+        errors << message;
+    }
+}
+
+/**
+ * @brief Formats a single donation letter with the default template.
+ * @param row The donor's name, address and total for the year.
+ * @param context Letterhead, date line and year shared by the whole run.
+ * @return The letter text, ready to be written to its file.
+ */
+std::string LetterGenerator::formatLetter(const LetterRow& row, const LetterContext& context) {
+    std::string out;
+    LetterTemplate::thankYou().render(row, context, out);
+    return out;
+}
+
+/**
+ * @brief File name (without directory) used for a donor's letter.
+ * Built as UTF-8 directly, instead of three QString::arg passes per letter.
+ */
+std::string LetterGenerator::letterFileName(const LetterRow& row, int year, const std::string& suffix) {
+    std::string name;
+    name.reserve(row.firstName.size() + row.lastName.size() + suffix.size() + 16);
+    name += row.firstName;
+    name += '_';
+    name += row.lastName;
+    name += '_';
+    name += std::to_string(year);
+    name += '_';
+    name += suffix;
+    name += ".txt";
+    return name;
+}
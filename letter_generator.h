@@ -0,0 +1,133 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// letter_generator.h
+#ifndef LETTER_GENERATOR_H
+#define LETTER_GENERATOR_H
+
+#include <QObject> // Base class; progress is reported through signals.
+#include <QString> // Output directory and error messages.
+#include <QMutex> // Guards the collected error messages.
+#include <QSemaphore> // Bounds the number of letter batches waiting for a worker.
+#include <QWaitCondition> // Ordered sinks: batches wait for their turn to write.
+#include <QStringList> // Collected error messages.
+#include <atomic> // Cancel flag and progress counters shared with the workers.
+#include <string> // Donor and organization fields.
+#include <vector> // Batches of letter rows.
+#include "letter_template.h" // LetterRow, LetterContext and the compiled letter text.
+#include "letter_sink.h" // Where the letters are written.
+#include "receipt_planner.h" // Which donors get a letter, in what order and batches.
+
+class QThread;
+class QThreadPool;
+
+/**
+ * @brief The LetterGenerator class writes a year's donation letters in the background.
+ * A producer thread streams the aggregated (donor, total) rows from its own read-only
+ * connection and hands them out in batches to a pool of worker threads, which format
+ * the letters and pass them to the run's LetterSink. The number of queued batches is bounded, so memory stays flat
+ * however many donors there are, and the GUI thread only ever sees progress signals.
+ * Batches are planned by ReceiptPlanner. Single-file sinks receive them in the planned
+ * order: workers render in parallel, then write when every earlier batch has been written.
+ */
+class LetterGenerator : public QObject {
+    Q_OBJECT // Enables Qt's meta-object system.
+
+public:
+    /**
+     * @brief Constructor for LetterGenerator.
+     * @param dbPath Path of the database file to read; a separate connection is opened per run.
+     * @param parent The parent object.
+     */
+    explicit LetterGenerator(const std::string& dbPath, QObject* parent = nullptr);
+    // Destructor cancels a running job and waits for its threads to finish.
+    ~LetterGenerator();
+
+    /**
+     * @brief Starts generating letters for the given year. Returns immediately.
+     * Does nothing (and returns false) if a run is already in progress.
+     * @param year The year for which to aggregate donations.
+     * @param outputDir Directory the letters are written to; created if missing.
+     * @param letterTemplate The letter to write; copied, so the caller may discard it.
+     * @param sinkKind One file per donor, or a single file in outputDir (see LetterSink::outputPath).
+     * @param selection Minimum total, letter order and batch size. A template meant for lapsed
+     * donors restricts the run to them.
+     * @return True if the run was started.
+     */
+    bool start(int year, const QString& outputDir = "letters", const LetterTemplate& letterTemplate = LetterTemplate::thankYou(),
+               LetterSinkKind sinkKind = LetterSinkKind::Directory, const ReceiptSelection& selection = ReceiptSelection());
+
+    /**
+     * @brief True between start() and the matching finished() signal.
+     */
+    bool isRunning() const { return running.load(); }
+
+    /**
+     * @brief Formats a single donation letter with the default (thank-you) template.
+     */
+    static std::string formatLetter(const LetterRow& row, const LetterContext& context);
+
+    /**
+     * @brief File name (without directory) used for a donor's letter.
+     * @param suffix The template's file suffix, e.g. "donation_letter".
+     */
+    static std::string letterFileName(const LetterRow& row, int year, const std::string& suffix = "donation_letter");
+
+public slots:
+    /**
+     * @brief Asks a running job to stop. Letters already written are kept.
+     * finished() is still emitted once the threads have wound down.
+     */
+    void cancel();
+
+signals:
+    // Emitted once the number of letters to write is known (before the first letter).
+    void started(int total);
+    // Emitted from worker threads after each batch; delivered queued to GUI receivers.
+    void progress(int done, int total);
+    // Emitted once per run. errors holds the first few failure messages.
+    void finished(int written, int failed, bool canceled, const QStringList& errors);
+
+private:
+    void produce(int year, const QString& outputDir, LetterSinkKind sinkKind); // Producer thread body.
+    void writeBatch(const ReceiptBatch& batch, const LetterContext& context, LetterSink& sink, bool ordered);
+    void recordError(const QString& message); // Keeps the first few errors for finished().
+
+    std::string dbPath; // Database file opened by the producer.
+    QThread* producerThread; // Runs produce() for the current job (nullptr when idle).
+    QThreadPool* workers; // Formats and writes letter batches.
+    QSemaphore queueSlots; // One slot per batch allowed to wait for a worker.
+    LetterTemplate letterTemplate; // Template of the current run; written by start() only while idle.
+    ReceiptSelection selection; // Selection of the current run; likewise.
+
+    QMutex turnMutex; // Guards nextBatch.
+    QWaitCondition turnChanged; // Signaled when nextBatch advances.
+    int nextBatch; // Sequence of the batch an ordered sink takes next.
+
+    std::atomic<bool> running; // A job is in progress.
+    std::atomic<bool> canceled; // Set by cancel(); polled by the producer and the workers.
+    std::atomic<int> total; // Letters in the current job.
+    std::atomic<int> written; // Letters successfully written.
+    std::atomic<int> failed; // Letters that could not be written.
+
+    QMutex errorsMutex; // Guards errors.
+    QStringList errors; // First few failure messages of the current job.
+};
+
+#endif // LETTER_GENERATOR_H
@@ -0,0 +1,416 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// letter_sink.cpp
+// Implementation of the letter output sinks: a directory of files, one concatenated file
+// with an offset index, a tar archive and a combined PDF.
+
+#include "letter_sink.h"
+#include "buffered_output.h" // Block-buffered output files.
+#include <QDateTime> // Archive member timestamps.
+#include <QDir> // Output directories.
+#include <QFile> // Per-letter files of DirectorySink.
+#include <QFileInfo> // Base name of an output file.
+#include <QMutexLocker> // Scoped locking in write().
+#include <algorithm> // std::min.
+#include <cstdio> // snprintf for octal and offset fields.
+#include <cstring> // memcpy and memset for tar headers.
+#include <vector> // PDF object offsets.
+
+/**
+ * @brief Stores an error message (if wanted) and returns false.
+ */
+static bool fail(std::string* error, const std::string& message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+/**
+ * @brief One file per letter in the output directory, written concurrently by the workers.
+ */
+class DirectorySink : public LetterSink {
+public:
+    explicit DirectorySink(const QString& path) : dir(path) {}
+
+    bool open(std::string* error) override {
+        if (!QDir().mkpath(dir.path())) {
+            return fail(error, "Could not create directory: " + dir.path().toStdString());
+        }
+        return true;
+    }
+
+    bool close(std::string*) override { return true; }
+
+protected:
+    bool writeLetter(const std::string& name, const std::string& text, std::string* error) override {
+        QString fileName = dir.filePath(QString::fromStdString(name));
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text) ||
+            file.write(text.data(), static_cast<qint64>(text.size())) != static_cast<qint64>(text.size())) {
+            return fail(error, "Could not open file for writing: " + fileName.toStdString());
+        }
+        return true;
+    }
+
+    bool concurrent() const override { return true; }
+
+private:
+    QDir dir;
+};
+
+/**
+ * @brief Every letter in one text file, separated by form feeds so each prints on a new
+ * page. A tab-separated index (<base>.index.tsv) records the byte offset, length and name
+ * of each letter, so single letters can be cut out again without scanning the file.
+ */
+class ConcatenatedFileSink : public LetterSink {
+public:
+    explicit ConcatenatedFileSink(const QString& path) : path(path), letters(0) {}
+
+    bool open(std::string* error) override {
+        QFileInfo info(path);
+        QString indexPath = info.dir().filePath(info.completeBaseName() + ".index.tsv");
+        if (!output.open(path, false, error) || !index.open(indexPath, false, error)) {
+            return false;
+        }
+        index.append("offset\tlength\tname\n");
+        return true;
+    }
+
+    bool close(std::string* error) override {
+        bool outputClosed = output.close(error);
+        return index.close(error) && outputClosed;
+    }
+
+protected:
+    bool writeLetter(const std::string& name, const std::string& text, std::string*) override {
+        if (letters++ > 0) {
+            output.append("\f", 1);
+        }
+        char offsets[48];
+        int length = std::snprintf(offsets, sizeof(offsets), "%lld\t%llu\t",
+                                   static_cast<long long>(output.offset()), static_cast<unsigned long long>(text.size()));
+        index.append(offsets, static_cast<std::size_t>(length));
+        index.append(name);
+        index.append("\n", 1);
+        output.append(text);
+        return true; // Write errors surface from close().
+    }
+
+private:
+    QString path;
+    BufferedOutput output; // The letters.
+    BufferedOutput index; // offset, length and name per letter.
+    long long letters; // Letters written so far.
+};
+
+/**
+ * @brief A POSIX ustar archive with one member per letter. Names longer than the 100-byte
+ * ustar field are carried in a pax extended header, which every current tar reads.
+ */
+class TarSink : public LetterSink {
+public:
+    static const std::size_t blockSize = 512; // Tar record size.
+
+    explicit TarSink(const QString& path) : path(path), mtime(0) {}
+
+    bool open(std::string* error) override {
+        mtime = QDateTime::currentDateTime().toSecsSinceEpoch();
+        return output.open(path, false, error);
+    }
+
+    bool close(std::string* error) override {
+        output.appendZeros(2 * blockSize); // End-of-archive marker.
+        return output.close(error);
+    }
+
+protected:
+    bool writeLetter(const std::string& name, const std::string& text, std::string*) override {
+        if (name.size() > 100) {
+            std::string record = paxRecord("path", name);
+            writeMember("PaxHeader/" + name.substr(0, 90), 'x', record);
+        }
+        writeMember(name, '0', text);
+        return true; // Write errors surface from close().
+    }
+
+private:
+    // One "<length> key=value\n" record; the length counts its own digits.
+    static std::string paxRecord(const std::string& key, const std::string& value) {
+        std::size_t body = key.size() + value.size() + 3; // ' ', '=' and '\n'.
+        std::size_t length = body + std::to_string(body).size();
+        if (std::to_string(length).size() != std::to_string(body).size()) {
+            length = body + std::to_string(length).size();
+        }
+        return std::to_string(length) + " " + key + "=" + value + "\n";
+    }
+
+    static void putOctal(char* field, std::size_t width, unsigned long long value) {
+        std::snprintf(field, width, "%0*llo", static_cast<int>(width - 1), value); // Zero-padded, NUL-terminated.
+    }
+
+    void writeMember(const std::string& name, char type, const std::string& data) {
+        char header[blockSize];
+        std::memset(header, 0, sizeof(header));
+        std::memcpy(header, name.data(), std::min<std::size_t>(name.size(), 100));
+        putOctal(header + 100, 8, 0644); // mode
+        putOctal(header + 108, 8, 0); // uid
+        putOctal(header + 116, 8, 0); // gid
+        putOctal(header + 124, 12, data.size());
+        putOctal(header + 136, 12, static_cast<unsigned long long>(mtime));
+        header[156] = type;
+        std::memcpy(header + 257, "ustar", 6); // Magic, NUL-terminated.
+        std::memcpy(header + 263, "00", 2); // Version.
+
+        // The checksum is computed with its own field filled with spaces.
+        std::memset(header + 148, ' ', 8);
+        unsigned int checksum = 0;
+        for (unsigned char byte : header) {
+            checksum += byte;
+        }
+        std::snprintf(header + 148, 8, "%06o", checksum);
+        header[155] = ' ';
+
+        output.append(header, sizeof(header));
+        output.append(data);
+        output.appendZeros((blockSize - data.size() % blockSize) % blockSize);
+    }
+
+    QString path;
+    BufferedOutput output;
+    qint64 mtime; // Timestamp of every member: the start of the run.
+};
+
+/**
+ * @brief One PDF document with each letter starting on a new Letter-size page. Text is set
+ * in the standard Courier font, so no font is embedded and the layout matches the plain
+ * text letters; long lines are wrapped and long letters continue onto further pages.
+ * Objects are streamed out as letters arrive: only their offsets are kept for the
+ * cross-reference table written by close().
+ */
+class PdfSink : public LetterSink {
+public:
+    explicit PdfSink(const QString& path) : path(path), offsets(4, 0), pages(0) {}
+
+    bool open(std::string* error) override {
+        if (!output.open(path, false, error)) {
+            return false;
+        }
+        output.append("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n"); // Binary marker line.
+        offsets[1] = output.offset();
+        output.append("1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+        offsets[3] = output.offset(); // Object 2, the page tree, is written by close().
+        output.append("3 0 obj\n<< /Type /Font /Subtype /Type1 /BaseFont /Courier /Encoding /WinAnsiEncoding >>\nendobj\n");
+        return true;
+    }
+
+    bool close(std::string* error) override {
+        offsets[2] = output.offset();
+        output.append("2 0 obj\n<< /Type /Pages /Kids [");
+        output.append(kids);
+        output.append("] /Count " + std::to_string(pages) + " >>\nendobj\n");
+
+        qint64 xref = output.offset();
+        output.append("xref\n0 " + std::to_string(offsets.size()) + "\n0000000000 65535 f \n");
+        char entry[24];
+        for (std::size_t i = 1; i < offsets.size(); ++i) {
+            std::snprintf(entry, sizeof(entry), "%010lld 00000 n \n", static_cast<long long>(offsets[i]));
+            output.append(entry, 20);
+        }
+        output.append("trailer\n<< /Size " + std::to_string(offsets.size()) + " /Root 1 0 R >>\nstartxref\n" +
+                      std::to_string(xref) + "\n%%EOF\n");
+        return output.close(error);
+    }
+
+protected:
+    bool writeLetter(const std::string&, const std::string& text, std::string*) override {
+        // WinAnsi is Latin-1 for the characters letters use; anything else prints as '?'.
+        QByteArray latin1 = QString::fromUtf8(text.data(), static_cast<int>(text.size())).toLatin1();
+        std::string content;
+        int lines = 0;
+        int start = 0;
+        while (start <= latin1.size()) {
+            int end = latin1.indexOf('\n', start);
+            if (end < 0) {
+                end = latin1.size();
+            }
+            if (end == latin1.size() && start == end && lines > 0) {
+                break; // Trailing newline.
+            }
+            // Wrap at the last space that fits, or hard-wrap a single long word.
+            int lineStart = start;
+            do {
+                int lineEnd = end;
+                if (lineEnd - lineStart > charsPerLine) {
+                    lineEnd = lineStart + charsPerLine;
+                    int space = latin1.lastIndexOf(' ', lineEnd);
+                    if (space > lineStart) {
+                        lineEnd = space;
+                    }
+                }
+                if (lines == linesPerPage) {
+                    writePage(content);
+                    lines = 0;
+                }
+                appendLine(content, latin1.constData() + lineStart, lineEnd - lineStart);
+                ++lines;
+                lineStart = lineEnd;
+                while (lineStart < end && latin1[lineStart] == ' ' && lineEnd != end) {
+                    ++lineStart; // The space a line was wrapped at is not carried to the next.
+                }
+            } while (lineStart < end);
+            start = end + 1;
+        }
+        writePage(content);
+        return true; // Write errors surface from close().
+    }
+
+private:
+    static const int charsPerLine = 84; // 504pt of text width at 6pt per Courier character.
+    static const int linesPerPage = 57; // 684pt of text height at 12pt leading.
+
+    // Adds one line as a string operand of the ' (next line and show) operator.
+    static void appendLine(std::string& content, const char* text, int size) {
+        content += '(';
+        for (int i = 0; i < size; ++i) {
+            char c = text[i];
+            if (c == '(' || c == ')' || c == '\\') {
+                content += '\\';
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                c = ' '; // Tabs, carriage returns and other controls.
+            }
+            content += c;
+        }
+        content += ") '\n";
+    }
+
+    // Writes the page's content stream and page object, then clears content for the next page.
+    void writePage(std::string& content) {
+        content = "BT\n/F1 10 Tf\n12 TL\n54 750 Td\n" + content + "ET\n";
+        std::size_t contentObject = offsets.size();
+        offsets.push_back(output.offset());
+        output.append(std::to_string(contentObject) + " 0 obj\n<< /Length " + std::to_string(content.size()) + " >>\nstream\n");
+        output.append(content);
+        output.append("endstream\nendobj\n");
+
+        std::size_t pageObject = offsets.size();
+        offsets.push_back(output.offset());
+        output.append(std::to_string(pageObject) + " 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] "
+                      "/Resources << /Font << /F1 3 0 R >> >> /Contents " + std::to_string(contentObject) + " 0 R >>\nendobj\n");
+        kids += std::to_string(pageObject) + " 0 R ";
+        ++pages;
+        content.clear();
+    }
+
+    QString path;
+    BufferedOutput output;
+    std::vector<qint64> offsets; // File offset of every object, by object number (0 unused).
+    std::string kids; // Page references for the page tree.
+    long long pages; // Pages written so far.
+};
+
+/**
+ * @brief Creates the sink of the given kind writing to path.
+ */
+std::unique_ptr<LetterSink> LetterSink::create(LetterSinkKind kind, const QString& path) {
+    switch (kind) {
+    case LetterSinkKind::ConcatenatedFile:
+        return std::unique_ptr<LetterSink>(new ConcatenatedFileSink(path));
+    case LetterSinkKind::Tar:
+        return std::unique_ptr<LetterSink>(new TarSink(path));
+    case LetterSinkKind::Pdf:
+        return std::unique_ptr<LetterSink>(new PdfSink(path));
+    case LetterSinkKind::Directory:
+        break;
+    }
+    return std::unique_ptr<LetterSink>(new DirectorySink(path));
+}
+
+/**
+ * @brief The directory itself for Directory, otherwise donation_letters_<year>.<ext> in it.
+ */
+QString LetterSink::outputPath(LetterSinkKind kind, const QString& outputDir, int year) {
+    const char* extension = nullptr;
+    switch (kind) {
+    case LetterSinkKind::Directory:
+        return outputDir;
+    case LetterSinkKind::ConcatenatedFile:
+        extension = ".txt";
+        break;
+    case LetterSinkKind::Tar:
+        extension = ".tar";
+        break;
+    case LetterSinkKind::Pdf:
+        extension = ".pdf";
+        break;
+    }
+    return QDir(outputDir).filePath(QString("donation_letters_%1%2").arg(year).arg(extension));
+}
+
+bool LetterSink::kindFromString(const std::string& name, LetterSinkKind& kind) {
+    if (name == "dir") {
+        kind = LetterSinkKind::Directory;
+    } else if (name == "file") {
+        kind = LetterSinkKind::ConcatenatedFile;
+    } else if (name == "tar") {
+        kind = LetterSinkKind::Tar;
+    } else if (name == "pdf") {
+        kind = LetterSinkKind::Pdf;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Claims a unique name under the lock, then stores the letter; single-file sinks
+ * keep the lock for the write so their output is never interleaved.
+ */
+bool LetterSink::write(const std::string& name, const std::string& text, std::string* error) {
+    QMutexLocker locker(&mutex);
+    std::string unique = uniqueName(name);
+    if (concurrent()) {
+        locker.unlock();
+    }
+    return writeLetter(unique, text, error);
+}
+
+/**
+ * @brief Returns name, or name with "_2", "_3", ... before its extension if already used.
+ */
+std::string LetterSink::uniqueName(const std::string& name) {
+    int& seen = usedNames[name];
+    if (seen++ == 0) {
+        return name;
+    }
+    std::size_t dot = name.rfind('.');
+    std::string stem = dot == std::string::npos ? name : name.substr(0, dot);
+    std::string extension = dot == std::string::npos ? std::string() : name.substr(dot);
+    for (;;) {
+        std::string candidate = stem + "_" + std::to_string(seen) + extension;
+        int& candidateSeen = usedNames[candidate];
+        if (candidateSeen == 0) {
+            candidateSeen = 1;
+            return candidate;
+        }
+        ++seen;
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// letter_sink.h
+#ifndef LETTER_SINK_H
+#define LETTER_SINK_H
+
+#include <QMutex> // Serializes writes and guards the used-name table.
+#include <QString> // Output paths.
+#include <memory> // std::unique_ptr from create().
+#include <string> // Letter names and text.
+#include <unordered_map> // Used letter names, for collision suffixes.
+
+// Where a letter run's output goes.
+enum class LetterSinkKind {
+    Directory, // One text file per donor (the original layout).
+    ConcatenatedFile, // One text file with every letter, plus a tab-separated offset index.
+    Tar, // One ustar archive with a text file per donor.
+    Pdf // One PDF document, each letter starting on a new page.
+};
+
+/**
+ * @brief The LetterSink class receives the letters of a run and stores them.
+ * write() may be called from several letter workers at once. Single-file sinks serialize
+ * the calls and append to one file through a large buffer, so a run is a stream of big
+ * sequential writes instead of one create/write/close per donor. Letter names that repeat
+ * within a run (two donors with the same name) get a "_2", "_3", ... suffix before the
+ * extension, so no letter overwrites another.
+ */
+class LetterSink {
+public:
+    /**
+     * @brief Creates the sink of the given kind.
+     * @param path The output directory for Directory, otherwise the output file.
+     */
+    static std::unique_ptr<LetterSink> create(LetterSinkKind kind, const QString& path);
+
+    /**
+     * @brief The path a run writes to: the directory itself for Directory, otherwise
+     * donation_letters_<year> with the sink's extension inside the directory.
+     */
+    static QString outputPath(LetterSinkKind kind, const QString& outputDir, int year);
+
+    static bool kindFromString(const std::string& name, LetterSinkKind& kind); // "dir", "file", "tar", "pdf".
+
+    virtual ~LetterSink() = default;
+
+    /**
+     * @brief Creates the output (and its directory). Must succeed before write().
+     * @param error Receives a message on failure (optional).
+     */
+    virtual bool open(std::string* error = nullptr) = 0;
+
+    /**
+     * @brief Stores one letter. Thread-safe.
+     * @param name File name of the letter, e.g. from LetterGenerator::letterFileName.
+     * @param text The rendered letter.
+     * @param error Receives a message on failure (optional).
+     */
+    bool write(const std::string& name, const std::string& text, std::string* error = nullptr);
+
+    /**
+     * @brief Flushes and finishes the output (index, archive trailer, PDF cross-reference).
+     * Nothing written is complete until close() has returned true.
+     */
+    virtual bool close(std::string* error = nullptr) = 0;
+
+protected:
+    // Stores one letter under its unique name; called under the sink's lock unless concurrent().
+    virtual bool writeLetter(const std::string& name, const std::string& text, std::string* error) = 0;
+    // True if writeLetter may run on several threads at once.
+    virtual bool concurrent() const { return false; }
+
+private:
+    std::string uniqueName(const std::string& name); // Appends a collision suffix; caller holds mutex.
+
+    QMutex mutex; // Guards usedNames and, for non-concurrent sinks, writeLetter.
+    std::unordered_map<std::string, int> usedNames; // Name -> times seen in this run.
+};
+
+#endif // LETTER_SINK_H
@@ -0,0 +1,213 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// letter_template.cpp
+// Compilation and rendering of letter templates, and the built-in letters.
+
+#include "letter_template.h"
+#include <QFile> // Template files.
+#include <QFileInfo> // File suffix from the template's name.
+
+struct BuiltInTemplate {
+    const char* name;
+    const char* fileSuffix;
+    bool lapsedDonorsOnly; // Written only to donors who have not given since the letter year.
+    const char* text;
+};
+
+// The thank-you text is the letter the application has always written.
+static const BuiltInTemplate builtInTemplates[] = {
+    {"thank-you", "donation_letter", false,
+     "{{org_name}}\n"
+     "{{org_address}}\n\n"
+     "{{date}}\n\n"
+     "{{first_name}} {{last_name}}\n"
+     "{{street}}\n"
+     "{{city}}, {{state}} {{zip}}\n"
+     "{{country}}\n\n"
+     "Dear {{first_name}},\n\n"
+     "Thank you for your generous total donation of ${{total}} to {{org_name}} in {{year}}.\n"
+     "Your support makes a significant difference to our mission.\n\n"
+     "Sincerely,\n"
+     "{{org_name}}\n"},
+    {"year-end-receipt", "year_end_receipt", false,
+     "{{org_name}}\n"
+     "{{org_address}}\n\n"
+     "OFFICIAL DONATION RECEIPT FOR {{year}}\n"
+     "Issued {{date}}\n\n"
+     "Donor: {{first_name}} {{last_name}}\n"
+     "{{street}}\n"
+     "{{city}}, {{state}} {{zip}}\n"
+     "{{country}}\n\n"
+     "Total of gifts received in {{year}}: ${{total}}\n\n"
+     "No goods or services were provided in exchange for these contributions.\n"
+     "Please keep this receipt for your tax records.\n\n"
+     "{{org_name}}\n"},
+    {"lapsed-donor", "lapsed_donor_letter", true,
+     "{{org_name}}\n"
+     "{{org_address}}\n\n"
+     "{{date}}\n\n"
+     "{{first_name}} {{last_name}}\n"
+     "{{street}}\n"
+     "{{city}}, {{state}} {{zip}}\n"
+     "{{country}}\n\n"
+     "Dear {{first_name}},\n\n"
+     "In {{year}} your gifts of ${{total}} helped {{org_name}} do its work, and we have missed you since.\n"
+     "We would be grateful if you would consider renewing your support this year.\n\n"
+     "With thanks,\n"
+     "{{org_name}}\n"},
+};
+
+struct FieldName {
+    const char* name;
+    LetterTemplate::Field field;
+};
+
+static const FieldName fieldNames[] = {
+    {"org_name", LetterTemplate::Field::OrgName},
+    {"org_address", LetterTemplate::Field::OrgAddress},
+    {"date", LetterTemplate::Field::Date},
+    {"year", LetterTemplate::Field::Year},
+    {"first_name", LetterTemplate::Field::FirstName},
+    {"last_name", LetterTemplate::Field::LastName},
+    {"street", LetterTemplate::Field::Street},
+    {"city", LetterTemplate::Field::City},
+    {"state", LetterTemplate::Field::State},
+    {"zip", LetterTemplate::Field::Zip},
+    {"country", LetterTemplate::Field::Country},
+    {"total", LetterTemplate::Field::Total},
+};
+
+/**
+ * @brief Splits the text into literal runs and placeholders.
+ */
+bool LetterTemplate::compile(const std::string& text, std::string* error) {
+    std::vector<Segment> compiled;
+    std::string pool;
+    std::size_t position = 0;
+    while (position < text.size()) {
+        std::size_t open = text.find("{{", position);
+        std::size_t literalEnd = open == std::string::npos ? text.size() : open;
+        if (literalEnd > position) {
+            compiled.push_back({Field::Literal, pool.size(), literalEnd - position});
+            pool.append(text, position, literalEnd - position);
+        }
+        if (open == std::string::npos) {
+            break;
+        }
+        std::size_t close = text.find("}}", open + 2);
+        if (close == std::string::npos) {
+            if (error) {
+                *error = "Unterminated placeholder at offset " + std::to_string(open);
+            }
+            return false;
+        }
+        std::string name = text.substr(open + 2, close - open - 2);
+        const FieldName* match = nullptr;
+        for (const FieldName& candidate : fieldNames) {
+            if (name == candidate.name) {
+                match = &candidate;
+                break;
+            }
+        }
+        if (!match) {
+            if (error) {
+                *error = "Unknown placeholder {{" + name + "}}";
+            }
+            return false;
+        }
+        compiled.push_back({match->field, 0, 0});
+        position = close + 2;
+    }
+    segments.swap(compiled);
+    literals.swap(pool);
+    lapsedOnly = false;
+    sizeHint = literals.size();
+    return true;
+}
+
+bool LetterTemplate::loadFile(const QString& path, std::string* error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = "Cannot open template " + path.toStdString() + ": " + file.errorString().toStdString();
+        }
+        return false;
+    }
+    QByteArray text = file.readAll();
+    if (!compile(std::string(text.constData(), static_cast<std::size_t>(text.size())), error)) {
+        return false;
+    }
+    suffix = QFileInfo(path).completeBaseName().toStdString();
+    return true;
+}
+
+/**
+ * @brief Appends each segment in turn; only the total and the year need formatting.
+ */
+void LetterTemplate::render(const LetterRow& row, const LetterContext& context, std::string& out) const {
+    out.clear();
+    out.reserve(sizeHint + 256);
+    for (const Segment& segment : segments) {
+        switch (segment.field) {
+        case Field::Literal: out.append(literals, segment.offset, segment.length); break;
+        case Field::OrgName: out += context.orgName; break;
+        case Field::OrgAddress: out += context.orgAddress; break;
+        case Field::Date: out += context.dateLine; break;
+        case Field::Year: out += std::to_string(context.year); break;
+        case Field::FirstName: out += row.firstName; break;
+        case Field::LastName: out += row.lastName; break;
+        case Field::Street: out += row.street; break;
+        case Field::City: out += row.city; break;
+        case Field::State: out += row.state; break;
+        case Field::Zip: out += row.zip; break;
+        case Field::Country: out += row.country; break;
+        case Field::Total: out += formatCents(row.totalCents); break;
+        }
+    }
+}
+
+bool LetterTemplate::builtIn(const std::string& name, LetterTemplate& result) {
+    for (const BuiltInTemplate& candidate : builtInTemplates) {
+        if (name == candidate.name) {
+            result.compile(candidate.text); // Built-in texts always compile.
+            result.suffix = candidate.fileSuffix;
+            result.lapsedOnly = candidate.lapsedDonorsOnly;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> LetterTemplate::builtInNames() {
+    std::vector<std::string> names;
+    for (const BuiltInTemplate& candidate : builtInTemplates) {
+        names.push_back(candidate.name);
+    }
+    return names;
+}
+
+const LetterTemplate& LetterTemplate::thankYou() {
+    static const LetterTemplate compiled = []() {
+        LetterTemplate result;
+        builtIn("thank-you", result);
+        return result;
+    }();
+    return compiled;
+}
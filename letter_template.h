@@ -0,0 +1,115 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// letter_template.h
+#ifndef LETTER_TEMPLATE_H
+#define LETTER_TEMPLATE_H
+
+#include "money.h" // Cents.
+#include <QString> // Template file paths.
+#include <cstddef> // std::size_t.
+#include <string> // Template text and rendered letters.
+#include <vector> // Compiled segments.
+
+/**
+ * @brief One donor's aggregated giving for the letter year, as read by the producer.
+ */
+struct LetterRow {
+    std::string firstName;
+    std::string lastName;
+    std::string street;
+    std::string city;
+    std::string state;
+    std::string zip;
+    std::string country;
+    Cents totalCents = 0; // Sum of the donor's gifts in the letter year.
+};
+
+/**
+ * @brief Values shared by every letter of a run (letterhead, date line and year).
+ */
+struct LetterContext {
+    std::string orgName;
+    std::string orgAddress;
+    std::string dateLine; // Formatted once per run, e.g. "January 5, 2026".
+    int year = 0;
+};
+
+/**
+ * @brief A letter template compiled into a flat list of literal and placeholder segments.
+ * Template text uses {{name}} placeholders: org_name, org_address, date, year, first_name,
+ * last_name, street, city, state, zip, country and total (the year's total, e.g. 1234.56).
+ * Compiling once per run means rendering a letter is a sequence of appends into a reused
+ * buffer, with no parsing or formatting beyond the total. A compiled template is immutable,
+ * so letter workers can share one without locking.
+ */
+class LetterTemplate {
+public:
+    // Placeholder fields; Literal marks a segment of fixed text.
+    enum class Field { Literal, OrgName, OrgAddress, Date, Year, FirstName, LastName, Street, City, State, Zip, Country, Total };
+
+    LetterTemplate() = default;
+
+    /**
+     * @brief Compiles template text, replacing any previous contents.
+     * @param text The template, with {{name}} placeholders.
+     * @param error Receives a message when compilation fails (optional).
+     * @return False on an unknown or unterminated placeholder.
+     */
+    bool compile(const std::string& text, std::string* error = nullptr);
+
+    /**
+     * @brief Reads and compiles a UTF-8 template file. The letter files are named after the
+     * template file's base name (see fileSuffix).
+     */
+    bool loadFile(const QString& path, std::string* error = nullptr);
+
+    /**
+     * @brief Renders one letter into out, replacing its contents. Reuse out across letters
+     * so its capacity is allocated once.
+     */
+    void render(const LetterRow& row, const LetterContext& context, std::string& out) const;
+
+    bool isEmpty() const { return segments.empty(); }
+    const std::string& fileSuffix() const { return suffix; } // E.g. "donation_letter".
+    bool lapsedDonorsOnly() const { return lapsedOnly; } // Meant only for donors with no gift after the letter year.
+
+    /**
+     * @brief Returns a compiled built-in template: "thank-you" (the default letter),
+     * "year-end-receipt" or "lapsed-donor".
+     * @return False if there is no built-in template of that name.
+     */
+    static bool builtIn(const std::string& name, LetterTemplate& result);
+    static std::vector<std::string> builtInNames();
+    static const LetterTemplate& thankYou(); // The default letter, compiled once.
+
+private:
+    struct Segment {
+        Field field;
+        std::size_t offset; // Literal text: position in literals.
+        std::size_t length;
+    };
+    std::vector<Segment> segments;
+    std::string literals; // All literal text, back to back.
+    std::string suffix = "letter";
+    std::size_t sizeHint = 0; // Literal bytes, to pre-size the output buffer.
+    bool lapsedOnly = false; // Set for the lapsed-donor letter; runs then select lapsed donors only.
+};
+
+#endif // LETTER_TEMPLATE_H
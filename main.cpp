@@ -19,10 +19,17 @@
 
 // main.cpp
 // This file contains the main application entry point and the implementation of the
-// DonationTracker, DonorDialog, DonationDialog, OrganizationDialog, and MainWindow classes.
+// DonorDialog, DonationDialog, OrganizationDialog, and MainWindow classes.
+// The DonationTracker backend lives in donation_tracker.cpp.
 
 // Required Qt and standard library includes for GUI, file operations, and data structures.
-#include "donation_tracker.h" // Custom header for DonationTracker classes.
+#include "main_window.h" // Dialogs and MainWindow (and, through it, DonationTracker).
+#include "donor_table_model.h" // Paged model behind the donor search table.
+#include "letter_generator.h" // Background letter generation.
+#include "database_worker.h" // Off-thread read queries for the GUI.
+#include "database_backup.h" // Background database snapshots.
+#include "reporting_snapshot.h" // Giving report, answered from memory.
+#include <QFutureWatcher> // Receives worker results on the GUI thread.
 #include <QApplication> // Core application class.
 #include <QVBoxLayout>  // Vertical layout manager.
 #include <QHBoxLayout>  // Horizontal layout manager.
@@ -32,523 +39,21 @@
 #include <QLabel>       // Widget for displaying text or images.
 #include <QMessageBox>  // For displaying message boxes (errors, warnings, info).
 #include <QRegularExpression> // For regular expression validation (e.g., email, phone).
-#include <QDir>         // For directory operations (e.g., creating "letters" folder).
-#include <QFile>        // For file I/O operations.
-#include <QTextStream>  // For reading and writing text.
-#include <algorithm>    // Standard algorithms (e.g., for std::find).
 #include <QGroupBox>    // For grouping related widgets.
 #include <QHeaderView>  // For customizing table headers.
 #include <QInputDialog> // For simple input dialogs.
 #include <QDate>        // For date manipulation.
+#include <QDateTime>    // Default backup file name.
 #include <QDateEdit>    // Widget for editing dates.
 #include <QIcon>        // Added for QIcon - to use icons on buttons.
 #include <QStyle>       // Added for QStyle - to get standard pixmaps.
 #include <QStyleFactory> // Added for QStyleFactory - to set application style.
 #include <QDebug>       // Added for qDebug() - for debugging output.
-
-// -----------------------------------------------------------------------------
-// DonationTracker Implementation
-// This section implements the core database logic defined in donation_tracker.h.
-// -----------------------------------------------------------------------------
-
-/**
- * @brief Constructor for DonationTracker.
- * Initializes the SQLite database connection. If the database file doesn't exist,
- * it will be created. Critical errors during opening will result in a message box.
- */
-DonationTracker::DonationTracker() : db(nullptr) {
-    // Attempt to open the SQLite database file "donations.db".
-    if (sqlite3_open("donations.db", &db) != SQLITE_OK) {
-        // If opening fails, display a critical error message.
-        QMessageBox::critical(nullptr, "Error", "Cannot open database: " + QString(sqlite3_errmsg(db)));
-    } else {
-        // If successful, create necessary tables.
-        createTables();
-    }
-}
-
-/**
- * @brief Destructor for DonationTracker.
- * Closes the SQLite database connection if it's open.
- */
-DonationTracker::~DonationTracker() {
-    if (db) {
-        sqlite3_close(db); // Close the database connection.
-    }
-}
-
-/**
- * @brief Creates the necessary tables in the SQLite database if they don't already exist.
- * This includes 'donors', 'donations', and 'organization' tables.
- * Errors during table creation are reported via a message box.
- */
-void DonationTracker::createTables() {
-    // SQL statement to create three tables: donors, donations, and organization.
-    // 'donors' table stores donor personal information.
-    // 'donations' table stores donation records, with a foreign key to 'donors' and CASCADE delete.
-    // 'organization' table stores details of the organization (single row).
-    const char* sql = "CREATE TABLE IF NOT EXISTS donors ("
-                      "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                      "first_name TEXT, last_name TEXT, street TEXT, city TEXT, "
-                      "state TEXT, zip TEXT, country TEXT, "
-                      "phone TEXT, email TEXT);"
-                      "CREATE TABLE IF NOT EXISTS donations ("
-                      "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                      "donor_id INTEGER, amount REAL, date TEXT, "
-                      "payment_method TEXT, "
-                      "FOREIGN KEY(donor_id) REFERENCES donors(id) ON DELETE CASCADE);" // Added ON DELETE CASCADE for referential integrity.
-                      "CREATE TABLE IF NOT EXISTS organization ("
-                      "id INTEGER PRIMARY KEY, "
-                      "name TEXT, address TEXT);";
-    char* errMsg = nullptr; // Pointer to store SQLite error messages.
-    // Execute the SQL statement.
-    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
-        // If execution fails, display a critical error message.
-        QMessageBox::critical(nullptr, "Database Error", QString("SQL error in createTables: %1").arg(errMsg));
-        sqlite3_free(errMsg); // Free the error message memory.
-    }
-}
-
-/**
- * @brief Adds a new donor record to the 'donors' table.
- * Uses a prepared statement to prevent SQL injection and efficiently bind parameters.
- * @return True on successful insertion, false otherwise.
- */
-bool DonationTracker::addDonor(const std::string& firstName, const std::string& lastName, const std::string& street, const std::string& city,
-                  const std::string& state, const std::string& zip, const std::string& country,
-                  const std::string& phone, const std::string& email) {
-    const char* sql = "INSERT INTO donors (first_name, last_name, street, city, state, zip, country, phone, email) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);";
-    sqlite3_stmt* stmt; // Prepared statement object.
-    // Prepare the SQL statement.
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        // Bind parameters to the prepared statement.
-        sqlite3_bind_text(stmt, 1, firstName.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 2, lastName.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 3, street.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 4, city.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 5, state.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 6, zip.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 7, country.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 8, phone.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 9, email.c_str(), -1, SQLITE_TRANSIENT);
-        // Execute the prepared statement.
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            sqlite3_finalize(stmt); // Finalize the statement to release resources.
-            return true;
-        } else {
-            // Report failure to add donor.
-            QMessageBox::warning(nullptr, "Database Error", QString("Failed to add donor: %1").arg(sqlite3_errmsg(db)));
-        }
-    }
-    sqlite3_finalize(stmt); // Ensure statement is finalized even if prepare fails.
-    return false;
-}
-
-/**
- * @brief Updates an existing donor record in the 'donors' table.
- * @param id The ID of the donor to update.
- * @return True on successful update, false otherwise.
- */
-bool DonationTracker::updateDonor(int id, const std::string& firstName, const std::string& lastName, const std::string& street, const std::string& city,
-                     const std::string& state, const std::string& zip, const std::string& country,
-                     const std::string& phone, const std::string& email) {
-    const char* sql = "UPDATE donors SET first_name=?, last_name=?, street=?, city=?, state=?, zip=?, country=?, phone=?, email=? WHERE id=?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, firstName.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 2, lastName.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 3, street.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 4, city.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 5, state.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 6, zip.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 7, country.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 8, phone.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 9, email.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(stmt, 10, id); // Bind the ID for the WHERE clause.
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            sqlite3_finalize(stmt);
-            return true;
-        } else {
-            QMessageBox::warning(nullptr, "Database Error", QString("Failed to update donor: %1").arg(sqlite3_errmsg(db)));
-        }
-    }
-    sqlite3_finalize(stmt);
-    return false;
-}
-
-/**
- * @brief Deletes a donor record from the 'donors' table based on ID.
- * Due to ON DELETE CASCADE, related donations in the 'donations' table will also be deleted.
- * @param id The ID of the donor to delete.
- * @return True on successful deletion, false otherwise.
- */
-bool DonationTracker::deleteDonor(int id) {
-    const char* sql = "DELETE FROM donors WHERE id=?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, id);
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            sqlite3_finalize(stmt);
-            return true;
-        } else {
-            QMessageBox::warning(nullptr, "Database Error", QString("Failed to delete donor: %1").arg(sqlite3_errmsg(db)));
-        }
-    }
-    sqlite3_finalize(stmt);
-    return false;
-}
-
-/**
- * @brief Adds a new donation record to the 'donations' table.
- * @return True on successful insertion, false otherwise.
- */
-bool DonationTracker::addDonation(int donorId, double amount, const std::string& date, const std::string& paymentMethod) {
-    const char* sql = "INSERT INTO donations (donor_id, amount, date, payment_method) VALUES (?, ?, ?, ?);";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, donorId);
-        sqlite3_bind_double(stmt, 2, amount);
-        sqlite3_bind_text(stmt, 3, date.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 4, paymentMethod.c_str(), -1, SQLITE_TRANSIENT);
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            sqlite3_finalize(stmt);
-            return true;
-        } else {
-            QMessageBox::warning(nullptr, "Database Error", QString("Failed to add donation: %1").arg(sqlite3_errmsg(db)));
-        }
-    }
-    sqlite3_finalize(stmt);
-    return false;
-}
-
-/**
- * @brief Updates an existing donation record in the 'donations' table.
- * @param id The ID of the donation to update.
- * @return True on successful update, false otherwise.
- */
-bool DonationTracker::updateDonation(int id, int donorId, double amount, const std::string& date, const std::string& paymentMethod) {
-    const char* sql = "UPDATE donations SET donor_id=?, amount=?, date=?, payment_method=? WHERE id=?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, donorId);
-        sqlite3_bind_double(stmt, 2, amount);
-        sqlite3_bind_text(stmt, 3, date.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 4, paymentMethod.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(stmt, 5, id);
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            sqlite3_finalize(stmt);
-            return true;
-        } else {
-            QMessageBox::warning(nullptr, "Database Error", QString("Failed to update donation: %1").arg(sqlite3_errmsg(db)));
-        }
-    }
-    sqlite3_finalize(stmt);
-    return false;
-}
-
-/**
- * @brief Deletes a donation record from the 'donations' table.
- * @param id The ID of the donation to delete.
- * @return True on successful deletion, false otherwise.
- */
-bool DonationTracker::deleteDonation(int id) {
-    const char* sql = "DELETE FROM donations WHERE id=?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, id);
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            sqlite3_finalize(stmt);
-            return true;
-        } else {
-            QMessageBox::warning(nullptr, "Database Error", QString("Failed to delete donation: %1").arg(sqlite3_errmsg(db)));
-        }
-    }
-    sqlite3_finalize(stmt);
-    return false;
-}
-
-/**
- * @brief Retrieves the organization's name and address from the 'organization' table.
- * Assumes there is only one organization record with id=1.
- * @param name Reference to a string to store the retrieved name.
- * @param address Reference to a string to store the retrieved address.
- * @return True if details are found, false otherwise.
- */
-bool DonationTracker::getOrganizationDetails(std::string& name, std::string& address) {
-    const char* sql = "SELECT name, address FROM organization WHERE id=1;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            // Retrieve data from the current row.
-            name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-            address = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-            sqlite3_finalize(stmt);
-            return true;
-        }
-    }
-    sqlite3_finalize(stmt);
-    return false;
-}
-
-/**
- * @brief Sets or updates the organization's details in the 'organization' table.
- * Uses INSERT OR REPLACE to either insert a new record or update an existing one (for id=1).
- * @param name The organization's name.
- * @param address The organization's address.
- * @return True on successful operation, false otherwise.
- */
-bool DonationTracker::setOrganizationDetails(const std::string& name, const std::string& address) {
-    const char* sql = "INSERT OR REPLACE INTO organization (id, name, address) VALUES (1, ?, ?);";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 2, address.c_str(), -1, SQLITE_TRANSIENT);
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            sqlite3_finalize(stmt);
-            return true;
-        } else {
-            QMessageBox::warning(nullptr, "Database Error", QString("Failed to set organization details: %1").arg(sqlite3_errmsg(db)));
-        }
-    }
-    sqlite3_finalize(stmt);
-    return false;
-}
-
-/**
- * @brief Generates donation letters for all donors who made donations in the specified year.
- * Creates a "letters" directory and saves each letter as a text file.
- * @param year The year for which to aggregate donations and generate letters.
- * @return True if all letters were successfully generated, false if any error occurred.
- */
-bool DonationTracker::generateDonationLetters(int year) {
-    QDir().mkdir("letters"); // Ensure the "letters" directory exists.
-
-    // SQL query to get donor details and sum of their donations for a specific year.
-    const char* sql = "SELECT d.first_name, d.last_name, d.street, d.city, d.state, d.zip, d.country, SUM(don.amount) "
-                      "FROM donors d JOIN donations don ON d.id = don.donor_id "
-                      "WHERE SUBSTR(don.date, 1, 4) = ? " // Filter by year from the date string.
-                      "GROUP BY d.id;"; // Group by donor to sum up donations.
-    sqlite3_stmt* stmt;
-    bool success = true; // Flag to track overall success.
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, std::to_string(year).c_str(), -1, SQLITE_TRANSIENT); // Bind the year.
-        std::string orgName, orgAddress;
-        getOrganizationDetails(orgName, orgAddress); // Get organization details for the letterhead.
-
-        // Iterate through each donor's summed donations.
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            // Retrieve donor and total donation amount.
-            std::string firstName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-            std::string lastName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-            std::string street = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-            std::string city = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-            std::string state = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-            std::string zip = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-            std::string country = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-            double totalAmount = sqlite3_column_double(stmt, 7);
-
-            // Construct the filename for the donation letter.
-            QString fileName = QString("letters/%1_%2_%3_donation_letter.txt")
-                                   .arg(QString::fromStdString(firstName))
-                                   .arg(QString::fromStdString(lastName))
-                                   .arg(year);
-            QFile file(fileName);
-            // Attempt to open the file for writing.
-            if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                QTextStream out(&file); // Use QTextStream for easy text writing.
-                // Write the letter content.
-                out << QString::fromStdString(orgName) << "\n";
-                out << QString::fromStdString(orgAddress) << "\n\n";
-                out << QDate::currentDate().toString("MMMM d, yyyy") << "\n\n"; // Current date.
-                out << QString::fromStdString(firstName) << " " << QString::fromStdString(lastName) << "\n";
-                out << QString::fromStdString(street) << "\n";
-                out << QString::fromStdString(city) << ", " << QString::fromStdString(state) << " " << QString::fromStdString(zip) << "\n";
-                out << QString::fromStdString(country) << "\n\n";
-                out << "Dear " << QString::fromStdString(firstName) << ",\n\n";
-                out << "Thank you for your generous total donation of $" << QString::number(totalAmount, 'f', 2) // Format amount to 2 decimal places.
-                    << " to " << QString::fromStdString(orgName) << " in " << year << ".\n";
-                out << "Your support makes a significant difference to our mission.\n\n";
-                out << "Sincerely,\n";
-                out << QString::fromStdString(orgName) << "\n";
-                file.close(); // Close the file.
-            } else {
-                // Report error if file could not be opened.
-                QMessageBox::warning(nullptr, "File Error", "Could not open file for writing: " + fileName);
-                success = false; // Mark overall process as failed.
-            }
-        }
-    } else {
-        // Report error if SQL statement preparation failed.
-        QMessageBox::warning(nullptr, "Database Error", QString("Failed to prepare statement for letter generation: %1").arg(sqlite3_errmsg(db)));
-        success = false;
-    }
-    sqlite3_finalize(stmt); // Finalize the statement.
-    return success;
-}
-
-/**
- * @brief Retrieves the full details of a specific donor by their ID.
- * @param id The ID of the donor to retrieve.
- * @param firstName Output parameter for donor's first name.
- * @param lastName Output parameter for donor's last name.
- * @param street Output parameter for donor's street address.
- * @param city Output parameter for donor's city.
- * @param state Output parameter for donor's state.
- * @param zip Output parameter for donor's ZIP code.
- * @param country Output parameter for donor's country.
- * @param phone Output parameter for donor's phone number.
- * @param email Output parameter for donor's email.
- * @return True if donor details were found, false otherwise.
- */
-bool DonationTracker::getDonorDetails(int id, std::string& firstName, std::string& lastName, std::string& street, std::string& city,
-                                     std::string& state, std::string& zip, std::string& country,
-                                     std::string& phone, std::string& email) {
-    const char* sql = "SELECT first_name, last_name, street, city, state, zip, country, phone, email FROM donors WHERE id=?;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, id); // Bind the donor ID.
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            // Retrieve all donor details from the current row.
-            firstName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-            lastName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-            street = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-            city = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-            state = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-            zip = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-            country = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-            phone = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 7));
-            email = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 8));
-            sqlite3_finalize(stmt);
-            return true;
-        }
-    }
-    sqlite3_finalize(stmt);
-    return false;
-}
-
-/**
- * @brief Retrieves all donor IDs from the database, ordered by ID.
- * This is used for sequential navigation through donor records.
- * @return A vector of integer donor IDs.
- */
-std::vector<int> DonationTracker::getAllDonorIds() {
-    std::vector<int> ids; // Vector to store donor IDs.
-    const char* sql = "SELECT id FROM donors ORDER BY id;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        // Iterate through all rows and add each ID to the vector.
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            ids.push_back(sqlite3_column_int(stmt, 0));
-        }
-    }
-    sqlite3_finalize(stmt);
-    return ids;
-}
-
-/**
- * @brief Searches for donors based on a given search term across multiple fields
- * (first name, last name, email, phone, city, state, zip, country).
- * Populates the provided QTableWidget with the search results.
- * If includeAll is true or searchTerm is empty, all donors are returned.
- * @param searchTerm The string to search for (case-insensitive, partial match).
- * @param table Pointer to the QTableWidget to display results.
- * @param includeAll If true, bypasses the search term and fetches all donors.
- */
-void DonationTracker::searchDonors(const std::string& searchTerm, QTableWidget* table, bool includeAll) {
-    sqlite3_stmt* stmt;
-    std::string sql;
-
-    if (includeAll || searchTerm.empty()) {
-        // SQL to retrieve all donors, ordered by first and last name.
-        sql = "SELECT id, first_name, last_name, street, city, state, zip, country, phone, email FROM donors ORDER BY first_name, last_name;";
-    } else {
-        // SQL to search for the searchTerm in multiple fields using LIKE operator.
-        sql = "SELECT id, first_name, last_name, street, city, state, zip, country, phone, email FROM donors WHERE "
-              "LOWER(first_name) LIKE ? OR "
-              "LOWER(last_name) LIKE ? OR "
-              "LOWER(email) LIKE ? OR "
-              "LOWER(phone) LIKE ? OR "
-              "LOWER(city) LIKE ? OR "
-              "LOWER(state) LIKE ? OR "
-              "LOWER(zip) LIKE ? OR "
-              "LOWER(country) LIKE ?;";
-    }
-
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        qDebug() << "Failed to prepare statement for search: " << sqlite3_errmsg(db);
-        return;
-    }
-
-    if (!(includeAll || searchTerm.empty())) {
-        // If searching, prepare the search term with wildcards and bind to all relevant parameters.
-        std::string lowerSearchTerm = "%" + QString::fromStdString(searchTerm).toLower().toStdString() + "%";
-        for (int i = 1; i <= 8; ++i) { // Bind to first_name, last_name, email, phone, city, state, zip, country.
-            sqlite3_bind_text(stmt, i, lowerSearchTerm.c_str(), -1, SQLITE_TRANSIENT);
-        }
-    }
-
-    table->setRowCount(0); // Clear existing rows in the table.
-    table->setColumnCount(10); // Set the number of columns if not already set.
-    // Set header labels for the table.
-    table->setHorizontalHeaderLabels({"ID", "First Name", "Last Name", "Street", "City", "State", "ZIP", "Country", "Phone", "Email"});
-    table->horizontalHeader()->setStretchLastSection(true); // Make the last section stretch to fill available space.
-    table->setSelectionBehavior(QAbstractItemView::SelectRows); // Select entire rows.
-    table->setEditTriggers(QAbstractItemView::NoEditTriggers); // Make table read-only.
-
-    int row = 0;
-    // Populate the table with fetched data.
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        table->insertRow(row);
-        table->setItem(row, 0, new QTableWidgetItem(QString::number(sqlite3_column_int(stmt, 0)))); // ID
-        table->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1))))); // First Name
-        table->setItem(row, 2, new QTableWidgetItem(QString::fromStdString(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2))))); // Last Name
-        table->setItem(row, 3, new QTableWidgetItem(QString::fromStdString(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3))))); // Street
-        table->setItem(row, 4, new QTableWidgetItem(QString::fromStdString(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4))))); // City
-        table->setItem(row, 5, new QTableWidgetItem(QString::fromStdString(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5))))); // State
-        table->setItem(row, 6, new QTableWidgetItem(QString::fromStdString(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6))))); // ZIP
-        table->setItem(row, 7, new QTableWidgetItem(QString::fromStdString(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 7))))); // Country
-        table->setItem(row, 8, new QTableWidgetItem(QString::fromStdString(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 8))))); // Phone
-        table->setItem(row, 9, new QTableWidgetItem(QString::fromStdString(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9))))); // Email
-        row++;
-    }
-    sqlite3_finalize(stmt);
-}
-
-/**
- * @brief Retrieves all donations for a given donor ID and populates a QTableWidget.
- * @param donorId The ID of the donor whose donations are to be retrieved.
- * @param table Pointer to the QTableWidget to display donation records.
- */
-void DonationTracker::getDonationsForDonor(int donorId, QTableWidget* table) {
-    const char* sql = "SELECT id, donor_id, amount, date, payment_method FROM donations WHERE donor_id=? ORDER BY date DESC;";
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, donorId); // Bind the donor ID.
-
-        table->clearContents(); // Clear existing content in the table.
-        table->setRowCount(0); // Reset row count.
-        table->setColumnCount(5); // Set the number of columns.
-        // Set header labels for the donations table.
-        table->setHorizontalHeaderLabels({"ID", "Donor ID", "Amount", "Date", "Payment Method"});
-        table->horizontalHeader()->setStretchLastSection(true);
-        table->setSelectionBehavior(QAbstractItemView::SelectRows);
-        table->setEditTriggers(QAbstractItemView::NoEditTriggers);
-
-        int row = 0;
-        // Populate the table with donation data.
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            table->insertRow(row);
-            table->setItem(row, 0, new QTableWidgetItem(QString::number(sqlite3_column_int(stmt, 0)))); // ID
-            table->setItem(row, 1, new QTableWidgetItem(QString::number(sqlite3_column_int(stmt, 1)))); // Donor ID
-            table->setItem(row, 2, new QTableWidgetItem(QString::number(sqlite3_column_double(stmt, 2), 'f', 2))); // Amount (formatted)
-            table->setItem(row, 3, new QTableWidgetItem(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)))); // Date
-            table->setItem(row, 4, new QTableWidgetItem(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)))); // Payment Method
-            row++;
-        }
-    }
-    sqlite3_finalize(stmt);
-}
+#include <QFileDialog>  // For choosing the CSV file to import.
+#include <QCommandLineParser> // For parsing command-line options (e.g., --profile).
+#include <QProgressDialog> // Progress and cancel for letter generation.
+#include <QThread>      // Routes backend errors from worker threads to the GUI thread.
+#include <QTimer>       // Debounces search-as-you-type.
 
 // -----------------------------------------------------------------------------
 // DonorDialog Implementation
@@ -712,6 +217,20 @@ bool DonationDialog::validateInputs() {
     return true;
 }
 
+/**
+ * @brief Returns the entered amount in cents.
+ * Plain "123.45" input is parsed exactly; anything else the validator accepted (such as
+ * a locale decimal comma) goes through QLocale and is rounded to the cent.
+ */
+Cents DonationDialog::amountCents() const {
+    QString text = amountEdit->text().trimmed();
+    Cents cents = 0;
+    if (!parseCents(text.toStdString(), cents)) {
+        cents = centsFromAmount(locale().toDouble(text));
+    }
+    return cents;
+}
+
 // -----------------------------------------------------------------------------
 // OrganizationDialog Implementation
 // This section implements the UI and logic for the Organization details dialog.
@@ -780,14 +299,44 @@ bool OrganizationDialog::validateInputs() {
 // This section implements the main application window's UI and event handling.
 // -----------------------------------------------------------------------------
 
+/**
+ * @brief Ends a startup phase.
+ */
+void StartupTiming::mark(const char* phase) {
+    qint64 now = timer.elapsed();
+    phases.emplace_back(phase, now - last);
+    last = now;
+}
+
+QString StartupTiming::summary() const {
+    QStringList parts;
+    for (const auto& phase : phases) {
+        parts << QString("%1 %2 ms").arg(phase.first).arg(phase.second);
+    }
+    parts << QString("total %1 ms").arg(last);
+    return parts.join(", ");
+}
+
 /**
  * @brief Constructor for MainWindow.
  * Sets up the main window's layout, widgets, and connects signals/slots.
- * Initializes the DonationTracker backend and loads initial data.
+ * Initializes the DonationTracker backend; the initial data is loaded by loadInitialData()
+ * once the window is on screen.
  * @param parent The parent widget (nullptr for top-level window).
+ * @param profile Connection profile for the backend database connection.
+ * @param dbPath Database file to open.
  */
-MainWindow::MainWindow(QWidget* parent)
-    : QMainWindow(parent), tracker(new DonationTracker()), currentDonorIndex(-1), currentDonorId(-1) {
+MainWindow::MainWindow(QWidget* parent, ConnectionProfile profile, const std::string& dbPath)
+    : QMainWindow(parent), logStartupTiming(false), tracker(new DonationTracker(profile, dbPath)), reportRefreshing(false),
+      reportChangedDuringRefresh(false), navigationDonorId(-1), currentDonorId(-1), donorLoadGeneration(0),
+      donationsLoadGeneration(0) {
+    startupTiming.mark("open database"); // Includes the schema check (or the migrations of an older file).
+    letterGenerator = new LetterGenerator(tracker->getDatabasePath(), this);
+    databaseBackup = new DatabaseBackup(tracker->getDatabasePath(), this);
+    reportingSnapshot = std::make_shared<ReportingSnapshot>(); // Empty until the first giving report.
+    // Created after tracker so the schema is already migrated when the worker connects.
+    dbWorker = new DatabaseWorker(tracker->getDatabasePath(), this);
+    startupTiming.mark("start workers");
     setWindowTitle("Donation Tracker");
     setMinimumSize(800, 600); // Set a reasonable minimum size.
 
@@ -802,7 +351,6 @@ MainWindow::MainWindow(QWidget* parent)
     orgDetailsLabel = new QLabel("Organization: Not set", this);
     orgDetailsLabel->setStyleSheet("font-weight: bold; color: navy;");
     mainLayout->addWidget(orgDetailsLabel, 0, Qt::AlignTop | Qt::AlignLeft);
-    updateOrganizationDisplay(); // Initial display of organization details.
 
     // Donor Details Section (QGroupBox for organization and styling)
     QGroupBox* donorDetailsGroup = new QGroupBox("Donor Details", this);
@@ -903,10 +451,11 @@ MainWindow::MainWindow(QWidget* parent)
     searchLayout->addWidget(searchButton);
     mainLayout->addLayout(searchLayout);
 
-    // Table for Search Results (Donors)
-    table = new QTableWidget(this);
-    table->setColumnCount(10); // ID, First, Last, Street, City, State, ZIP, Country, Phone, Email
-    table->setHorizontalHeaderLabels({"ID", "First Name", "Last Name", "Street", "City", "State", "ZIP", "Country", "Phone", "Email"});
+    // Table for Search Results (Donors). Rows are fetched from the database a page at a time
+    // as the view scrolls, so opening the window costs the same for 100 or 200k donors.
+    donorModel = new DonorTableModel(tracker, dbWorker, this);
+    table = new QTableView(this);
+    table->setModel(donorModel); // Columns: ID, First, Last, Street, City, State, ZIP, Country, Phone, Email
     table->horizontalHeader()->setStretchLastSection(true); // Last column fills remaining space.
     table->setSelectionBehavior(QAbstractItemView::SelectRows); // Entire row selected.
     table->setEditTriggers(QAbstractItemView::NoEditTriggers); // Make table read-only.
@@ -915,10 +464,16 @@ MainWindow::MainWindow(QWidget* parent)
     // Other Actions Buttons
     QHBoxLayout* miscButtonLayout = new QHBoxLayout();
     QPushButton* generateLettersButton = new QPushButton("Generate Donation Letters", this);
+    QPushButton* importDonationsButton = new QPushButton("Import Donations (CSV)", this);
+    QPushButton* backupButton = new QPushButton("Back Up Database", this);
+    QPushButton* reportButton = new QPushButton("Giving Report", this);
     QPushButton* setOrganizationButton = new QPushButton("Set Organization Details", this);
 
     miscButtonLayout->addStretch();
     miscButtonLayout->addWidget(generateLettersButton);
+    miscButtonLayout->addWidget(importDonationsButton);
+    miscButtonLayout->addWidget(backupButton);
+    miscButtonLayout->addWidget(reportButton);
     miscButtonLayout->addWidget(setOrganizationButton);
     miscButtonLayout->addStretch();
     mainLayout->addLayout(miscButtonLayout);
@@ -931,8 +486,19 @@ MainWindow::MainWindow(QWidget* parent)
     connect(editDonationButton, &QPushButton::clicked, this, &MainWindow::editDonation);
     connect(deleteDonationButton, &QPushButton::clicked, this, &MainWindow::deleteDonation);
     connect(generateLettersButton, &QPushButton::clicked, this, &MainWindow::generateLetters);
+    connect(importDonationsButton, &QPushButton::clicked, this, &MainWindow::importDonations);
+    connect(backupButton, &QPushButton::clicked, this, &MainWindow::backupDatabase);
+    connect(reportButton, &QPushButton::clicked, this, &MainWindow::showGivingReport);
     connect(setOrganizationButton, &QPushButton::clicked, this, &MainWindow::setOrganization);
     connect(searchButton, &QPushButton::clicked, this, &MainWindow::search);
+    // Search as you type: one listing per pause in typing rather than per keystroke. A listing
+    // still being read for an older term is canceled by the model when the new one starts.
+    searchDebounce = new QTimer(this);
+    searchDebounce->setSingleShot(true);
+    searchDebounce->setInterval(searchDebounceMs);
+    connect(searchDebounce, &QTimer::timeout, this, &MainWindow::search);
+    connect(searchField, &QLineEdit::textEdited, searchDebounce, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(searchField, &QLineEdit::returnPressed, this, &MainWindow::search);
 
     // Connect navigation buttons.
     connect(firstButton, &QPushButton::clicked, this, &MainWindow::loadFirstDonor);
@@ -941,16 +507,75 @@ MainWindow::MainWindow(QWidget* parent)
     connect(lastButton, &QPushButton::clicked, this, &MainWindow::loadLastDonor);
 
     // Connect table item clicks to slots to load details.
-    connect(table, &QTableWidget::itemClicked, this, &MainWindow::onDonorTableItemClicked);
+    connect(table, &QTableView::clicked, this, &MainWindow::onDonorTableClicked);
+
+    // The worker's donor cache cannot see writes on this connection; these go first so the
+    // invalidation is queued ahead of any lookup the other handlers trigger.
+    connect(tracker, &DonationTracker::donorUpdated, dbWorker, &DatabaseWorker::invalidateDonor);
+    connect(tracker, &DonationTracker::donorDeleted, dbWorker, &DatabaseWorker::invalidateDonor);
+    connect(tracker, &DonationTracker::donationAdded, dbWorker, [this](int, int donorId) { dbWorker->invalidateDonor(donorId); });
+    // An updated donation may have moved between donors, and a deleted one names no donor.
+    connect(tracker, &DonationTracker::donationUpdated, dbWorker, &DatabaseWorker::invalidateDonorCache);
+    connect(tracker, &DonationTracker::donationDeleted, dbWorker, &DatabaseWorker::invalidateDonorCache);
+    connect(tracker, &DonationTracker::donationsImported, dbWorker, &DatabaseWorker::invalidateDonorCache);
+
+    // Patch the views from backend change notifications instead of reloading them.
+    connect(tracker, &DonationTracker::donorAdded, donorModel, &DonorTableModel::insertDonor);
+    connect(tracker, &DonationTracker::donorUpdated, donorModel, &DonorTableModel::refreshDonor);
+    connect(tracker, &DonationTracker::donorDeleted, donorModel, &DonorTableModel::removeDonor);
+    // A new or deleted donor can change whether there is a previous or next one.
+    connect(tracker, &DonationTracker::donorAdded, this, [this]() { updateNavigationButtonStates(); });
+    connect(tracker, &DonationTracker::donorDeleted, this, [this]() { updateNavigationButtonStates(); });
     connect(donationsTable, &QTableWidget::itemClicked, this, &MainWindow::onDonationTableItemClicked);
 
-    populateDonorIds(); // Populate donor IDs for navigation.
+    // The giving report stays in memory: new donations are appended by the next refresh(),
+    // anything that edits or removes loaded rows makes it rebuild. Imports invalidate too,
+    // since an applied changeset is reported as one and may edit rows.
+    auto invalidateReport = [this]() { invalidateGivingReport(); };
+    connect(tracker, &DonationTracker::donationUpdated, this, invalidateReport);
+    connect(tracker, &DonationTracker::donationDeleted, this, invalidateReport);
+    connect(tracker, &DonationTracker::donorUpdated, this, invalidateReport);
+    connect(tracker, &DonationTracker::donorDeleted, this, invalidateReport);
+    connect(tracker, &DonationTracker::donationsImported, this, invalidateReport);
+    startupTiming.mark("build window");
+
+    // No query runs before the window is shown: the initial reads wait for the event loop.
+    firstPageConnection = connect(donorModel, &QAbstractItemModel::rowsInserted, this, [this]() { finishStartup(); });
+    QTimer::singleShot(0, this, &MainWindow::loadInitialData);
+}
+
+/**
+ * @brief Loads the data shown at startup. The donor listing and the first donor's details
+ * are read on the worker thread and fill in as they arrive.
+ */
+void MainWindow::loadInitialData() {
+    updateOrganizationDisplay(); // Initial display of organization details.
     loadFirstDonor();   // Load the first donor on application start.
     updateNavigationButtonStates(); // Update button states based on initial donor loaded.
 
-    // Perform an initial search to display all donors when the app starts
-    // This effectively populates the main donor table with all entries
-    tracker->searchDonors("", table, true);
+    // Perform an initial search to display all donors when the app starts.
+    // Only the first page is read now; the rest is fetched as the table is scrolled.
+    donorModel->setSearchTerm("");
+    startupTiming.mark("initial queries");
+    if (navigationDonorId == -1) {
+        finishStartup(); // No donors: no page will arrive.
+    }
+}
+
+/**
+ * @brief Runs once, when the first page of donors is in the table.
+ */
+void MainWindow::finishStartup() {
+    disconnect(firstPageConnection);
+    startupTiming.mark("first donor page");
+    if (logStartupTiming) {
+        qInfo().noquote() << "Startup:" << startupTiming.summary();
+    }
+    // Read the next page in the background while the first is on screen, so the first
+    // scroll does not wait for the database.
+    if (donorModel->canFetchMore(QModelIndex())) {
+        donorModel->fetchMore(QModelIndex());
+    }
 }
 
 /**
@@ -971,9 +596,8 @@ void MainWindow::addDonor() {
                               dialog.phoneEdit->text().toStdString(),
                               dialog.emailEdit->text().toStdString())) {
             QMessageBox::information(this, "Success", "Donor added successfully.");
-            populateDonorIds(); // Refresh donor IDs for navigation.
-            tracker->searchDonors("", table, true); // Refresh main donor table.
-            loadLastDonor(); // Load the newly added donor.
+            // The donor table was patched by the donorAdded signal.
+            loadLastDonor(); // Load the newly added donor (IDs only grow, so it is last).
         } else {
             QMessageBox::warning(this, "Error", "Failed to add donor.");
         }
@@ -993,18 +617,18 @@ void MainWindow::editDonor() {
 
     DonorDialog dialog(this);
     // Retrieve current donor details to pre-fill the dialog.
-    std::string firstName, lastName, street, city, state, zip, country, phone, email;
-    if (tracker->getDonorDetails(currentDonorId, firstName, lastName, street, city, state, zip, country, phone, email)) {
+    DonorRecord donor;
+    if (tracker->getDonorRecord(currentDonorId, donor)) {
         dialog.idEdit->setText(QString::number(currentDonorId));
-        dialog.firstNameEdit->setText(QString::fromStdString(firstName));
-        dialog.lastNameEdit->setText(QString::fromStdString(lastName));
-        dialog.streetEdit->setText(QString::fromStdString(street));
-        dialog.cityEdit->setText(QString::fromStdString(city));
-        dialog.stateEdit->setText(QString::fromStdString(state));
-        dialog.zipEdit->setText(QString::fromStdString(zip));
-        dialog.countryEdit->setText(QString::fromStdString(country));
-        dialog.phoneEdit->setText(QString::fromStdString(phone));
-        dialog.emailEdit->setText(QString::fromStdString(email));
+        dialog.firstNameEdit->setText(QString::fromStdString(donor.firstName));
+        dialog.lastNameEdit->setText(QString::fromStdString(donor.lastName));
+        dialog.streetEdit->setText(QString::fromStdString(donor.street));
+        dialog.cityEdit->setText(QString::fromStdString(donor.city));
+        dialog.stateEdit->setText(QString::fromStdString(donor.state));
+        dialog.zipEdit->setText(QString::fromStdString(donor.zip));
+        dialog.countryEdit->setText(QString::fromStdString(donor.country));
+        dialog.phoneEdit->setText(QString::fromStdString(donor.phone));
+        dialog.emailEdit->setText(QString::fromStdString(donor.email));
 
         if (dialog.exec() == QDialog::Accepted && dialog.validateInputs()) {
             if (tracker->updateDonor(currentDonorId,
@@ -1018,7 +642,7 @@ void MainWindow::editDonor() {
                                       dialog.phoneEdit->text().toStdString(),
                                       dialog.emailEdit->text().toStdString())) {
                 QMessageBox::information(this, "Success", "Donor updated successfully.");
-                tracker->searchDonors("", table, true); // Refresh main donor table.
+                // The donor table row was patched by the donorUpdated signal.
                 loadDonor(currentDonorId); // Reload details for the updated donor.
             } else {
                 QMessageBox::warning(this, "Error", "Failed to update donor.");
@@ -1045,8 +669,7 @@ void MainWindow::deleteDonor() {
                               QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
         if (tracker->deleteDonor(currentDonorId)) {
             QMessageBox::information(this, "Success", "Donor and associated donations deleted successfully.");
-            populateDonorIds(); // Re-populate donor IDs as one was removed.
-            tracker->searchDonors("", table, true); // Refresh main donor table.
+            // The donor table was patched by the donorDeleted signal.
             loadFirstDonor(); // Load the first donor or clear fields if no donors remain.
         } else {
             QMessageBox::warning(this, "Error", "Failed to delete donor.");
@@ -1071,11 +694,11 @@ void MainWindow::addDonation() {
         // Convert date to "YYYY-MM-DD" format.
         std::string dateStr = dialog.dateEdit->date().toString("yyyy-MM-dd").toStdString();
         if (tracker->addDonation(dialog.donorIdEdit->text().toInt(),
-                                  dialog.amountEdit->text().toDouble(),
+                                  dialog.amountCents(),
                                   dateStr,
                                   dialog.paymentMethodEdit->text().toStdString())) {
             QMessageBox::information(this, "Success", "Donation added successfully.");
-            tracker->getDonationsForDonor(currentDonorId, donationsTable); // Refresh donations table.
+            requestDonations(currentDonorId); // Refresh donations table.
         } else {
             QMessageBox::warning(this, "Error", "Failed to add donation.");
         }
@@ -1093,7 +716,7 @@ void MainWindow::editDonation() {
         int selectedRow = donationsTable->currentRow();
         int donationId = donationsTable->item(selectedRow, 0)->text().toInt(); // Get donation ID.
         int donorId = donationsTable->item(selectedRow, 1)->text().toInt(); // Get donor ID.
-        double amount = donationsTable->item(selectedRow, 2)->text().toDouble(); // Get amount.
+        QString amount = donationsTable->item(selectedRow, 2)->text(); // Get amount (already formatted to the cent).
         QDate date = QDate::fromString(donationsTable->item(selectedRow, 3)->text(), "yyyy-MM-dd"); // Get date.
         std::string paymentMethod = donationsTable->item(selectedRow, 4)->text().toStdString(); // Get payment method.
 
@@ -1101,7 +724,7 @@ void MainWindow::editDonation() {
         // Pre-fill the dialog with existing donation data.
         dialog.idEdit->setText(QString::number(donationId));
         dialog.donorIdEdit->setText(QString::number(donorId));
-        dialog.amountEdit->setText(QString::number(amount, 'f', 2));
+        dialog.amountEdit->setText(amount);
         dialog.dateEdit->setDate(date);
         dialog.paymentMethodEdit->setText(QString::fromStdString(paymentMethod));
 
@@ -1109,11 +732,11 @@ void MainWindow::editDonation() {
             std::string newDateStr = dialog.dateEdit->date().toString("yyyy-MM-dd").toStdString();
             if (tracker->updateDonation(donationId,
                                         dialog.donorIdEdit->text().toInt(),
-                                        dialog.amountEdit->text().toDouble(),
+                                        dialog.amountCents(),
                                         newDateStr,
                                         dialog.paymentMethodEdit->text().toStdString())) {
                 QMessageBox::information(this, "Success", "Donation updated successfully.");
-                tracker->getDonationsForDonor(currentDonorId, donationsTable); // Refresh donations table.
+                requestDonations(currentDonorId); // Refresh donations table.
             } else {
                 QMessageBox::warning(this, "Error", "Failed to update donation.");
             }
@@ -1139,7 +762,7 @@ void MainWindow::deleteDonation() {
                                   QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
             if (tracker->deleteDonation(donationId)) {
                 QMessageBox::information(this, "Success", "Donation deleted successfully.");
-                tracker->getDonationsForDonor(currentDonorId, donationsTable); // Refresh donations table.
+                requestDonations(currentDonorId); // Refresh donations table.
             } else {
                 QMessageBox::warning(this, "Error", "Failed to delete donation.");
             }
@@ -1151,23 +774,239 @@ void MainWindow::deleteDonation() {
 
 /**
  * @brief Slot to handle generating donation letters.
- * Prompts the user for a year and then calls DonationTracker to generate letters.
+ * Prompts the user for a year and starts a background LetterGenerator run. A progress
+ * dialog tracks the run and its Cancel button stops it; the window stays responsive.
  */
 void MainWindow::generateLetters() {
+    if (letterGenerator->isRunning()) {
+        QMessageBox::information(this, "Generate Donation Letters", "Letters are already being generated.");
+        return;
+    }
     bool ok;
     // Prompt user for the year. Default to current year.
     int year = QInputDialog::getInt(this, "Generate Donation Letters",
                                     "Enter year for donation letters:",
                                     QDate::currentDate().year(), 2000, QDate::currentDate().year() + 5, 1, &ok);
-    if (ok) {
-        if (tracker->generateDonationLetters(year)) {
-            QMessageBox::information(this, "Success", "Donation letters generated successfully in the 'letters' folder.");
+    if (!ok) {
+        return;
+    }
+    QStringList templateNames;
+    for (const std::string& name : LetterTemplate::builtInNames()) {
+        templateNames << QString::fromStdString(name);
+    }
+    QString templateName = QInputDialog::getItem(this, "Generate Donation Letters", "Letter:", templateNames, 0, false, &ok);
+    LetterTemplate letterTemplate;
+    if (!ok || !LetterTemplate::builtIn(templateName.toStdString(), letterTemplate)) {
+        return;
+    }
+    // Mail houses take one file; the per-donor directory stays the default.
+    const QStringList outputs = {"One text file per donor", "Single text file with index", "Tar archive", "PDF document"};
+    const LetterSinkKind outputKinds[] = {LetterSinkKind::Directory, LetterSinkKind::ConcatenatedFile,
+                                          LetterSinkKind::Tar, LetterSinkKind::Pdf};
+    QString output = QInputDialog::getItem(this, "Generate Donation Letters", "Output:", outputs, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    LetterSinkKind sinkKind = outputKinds[outputs.indexOf(output)];
+
+    // The dialog is owned by the run: it is deleted when finished() arrives.
+    QProgressDialog* progressDialog = new QProgressDialog("Generating donation letters...", "Cancel", 0, 0, this);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setMinimumDuration(500); // Small runs finish without flashing a dialog.
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+
+    // Connections use progressDialog as context, so they go away with it.
+    connect(letterGenerator, &LetterGenerator::started, progressDialog, [progressDialog](int total) {
+        progressDialog->setMaximum(total);
+    });
+    connect(letterGenerator, &LetterGenerator::progress, progressDialog, [progressDialog](int done, int) {
+        progressDialog->setValue(done);
+    });
+    connect(progressDialog, &QProgressDialog::canceled, letterGenerator, &LetterGenerator::cancel);
+    connect(letterGenerator, &LetterGenerator::finished, progressDialog,
+            [this, progressDialog](int written, int failed, bool canceled, const QStringList& errors) {
+        progressDialog->deleteLater();
+        QString summary = QString("%1 donation letter(s) written to the 'letters' folder.").arg(written);
+        if (canceled) {
+            summary = "Letter generation was canceled.\n" + summary;
+        }
+        if (failed > 0 || !errors.isEmpty()) {
+            summary += QString("\n%1 letter(s) could not be written.").arg(failed);
+            for (const QString& error : errors) {
+                summary += "\n" + error;
+            }
+            QMessageBox::warning(this, "Generate Donation Letters", summary);
         } else {
-            QMessageBox::warning(this, "Error", "Failed to generate donation letters. Check database or file permissions.");
+            QMessageBox::information(this, "Generate Donation Letters", summary);
+        }
+    });
+
+    letterGenerator->start(year, "letters", letterTemplate, sinkKind);
+}
+
+/**
+ * @brief Slot to handle backing up the database.
+ * Prompts for the destination and the kind of copy, then snapshots the live database on a
+ * background thread. The progress dialog is not modal, so staff can keep working meanwhile.
+ */
+void MainWindow::backupDatabase() {
+    if (databaseBackup->isRunning()) {
+        QMessageBox::information(this, "Back Up Database", "A backup is already in progress.");
+        return;
+    }
+    QString defaultName = QString("donations_%1.db").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmm"));
+    QString path = QFileDialog::getSaveFileName(this, "Back Up Database", defaultName, "Databases (*.db);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+    const QStringList kinds = {"Exact copy (fastest)", "Compacted copy (smaller file)"};
+    bool ok;
+    QString kind = QInputDialog::getItem(this, "Back Up Database", "Backup:", kinds, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    BackupOptions options;
+    options.compact = kinds.indexOf(kind) == 1;
+
+    // The dialog is owned by the snapshot: it is deleted when finished() arrives.
+    QProgressDialog* progressDialog = new QProgressDialog("Backing up the database...", "Cancel", 0, 0, this);
+    progressDialog->setMinimumDuration(500);
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+
+    connect(databaseBackup, &DatabaseBackup::progress, progressDialog, [progressDialog](int pagesCopied, int pageCount) {
+        progressDialog->setMaximum(pageCount); // 0 (busy indicator) while compacting.
+        progressDialog->setValue(pagesCopied);
+    });
+    connect(progressDialog, &QProgressDialog::canceled, databaseBackup, &DatabaseBackup::cancel);
+    connect(databaseBackup, &DatabaseBackup::finished, progressDialog,
+            [this, progressDialog, path](bool ok, bool canceled, const QString& error) {
+        progressDialog->deleteLater();
+        if (ok) {
+            QMessageBox::information(this, "Back Up Database", QString("Database backed up to %1.").arg(path));
+        } else if (!canceled) {
+            QMessageBox::warning(this, "Back Up Database", error);
         }
+    });
+
+    databaseBackup->start(path, options);
+}
+
+/**
+ * @brief Slot to handle importing donations from a CSV file.
+ * Prompts for the file, runs the bulk import and shows a single summary
+ * (with the first few rejected rows) instead of one message per failure.
+ */
+void MainWindow::importDonations() {
+    QString path = QFileDialog::getOpenFileName(this, "Import Donations", QString(), "CSV files (*.csv);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    ImportResult result = tracker->importDonationsCsv(path.toStdString());
+    QString summary = QString("Imported %1 donation(s) in %2 s (%3 rows/sec).\n%4 row(s) rejected.")
+                          .arg(result.rowsImported)
+                          .arg(result.elapsedSeconds, 0, 'f', 2)
+                          .arg(result.rowsPerSecond(), 0, 'f', 0)
+                          .arg(result.rowsFailed);
+    const std::size_t maxShown = 10; // Keep the message box a readable size.
+    for (std::size_t i = 0; i < result.errors.size() && i < maxShown; ++i) {
+        summary += QString("\nLine %1: %2").arg(result.errors[i].row).arg(QString::fromStdString(result.errors[i].message));
+    }
+    if (result.errors.size() > maxShown) {
+        summary += QString("\n... and %1 more.").arg(result.errors.size() - maxShown);
+    }
+
+    if (result.errors.empty()) {
+        QMessageBox::information(this, "Import Donations", summary);
+    } else {
+        QMessageBox::warning(this, "Import Donations", summary);
+    }
+    if (currentDonorId != -1) {
+        requestDonations(currentDonorId); // Show any new gifts for the current donor.
     }
 }
 
+/**
+ * @brief Slot for the giving report: donations counted and summed per year, month, payment
+ * method, state or country. The snapshot is refreshed on a pooled read-only connection, so a
+ * rebuild after an edit scans the donations without holding up the window or the worker's
+ * lookups; only donations added since the previous report are read otherwise.
+ */
+void MainWindow::showGivingReport() {
+    if (reportRefreshing) {
+        QMessageBox::information(this, "Giving Report", "The giving report is still being prepared.");
+        return;
+    }
+    const QStringList dimensions = {"year", "month", "payment-method", "state", "country"};
+    bool ok;
+    QString name = QInputDialog::getItem(this, "Giving Report", "Group donations by:", dimensions, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+
+    reportRefreshing = true;
+    std::shared_ptr<ReportingSnapshot> snapshot = reportingSnapshot;
+    auto* watcher = new QFutureWatcher<std::shared_ptr<ReportingSnapshot>>(this);
+    connect(watcher, &QFutureWatcher<std::shared_ptr<ReportingSnapshot>>::finished, this, [this, watcher, name]() {
+        watcher->deleteLater();
+        reportRefreshing = false;
+        bool canceled = watcher->isCanceled();
+        if (canceled || reportChangedDuringRefresh) {
+            reportingSnapshot->invalidate(); // It may have missed (or half-read) the change.
+            reportChangedDuringRefresh = false;
+        }
+        if (!canceled) {
+            presentGivingReport(name);
+        }
+    });
+    watcher->setFuture(dbWorker->submitParallel<std::shared_ptr<ReportingSnapshot>>(
+        [snapshot](DonationTracker& reader) {
+            snapshot->refresh(reader);
+            return snapshot;
+        }));
+}
+
+/**
+ * @brief Marks the giving report for a rebuild, or defers that while a refresh job owns it.
+ */
+void MainWindow::invalidateGivingReport() {
+    if (reportRefreshing) {
+        reportChangedDuringRefresh = true;
+    } else {
+        reportingSnapshot->invalidate();
+    }
+}
+
+void MainWindow::presentGivingReport(const QString& dimensionName) {
+    ReportDimension dimension;
+    if (!ReportingSnapshot::dimensionFromString(dimensionName.toStdString(), dimension)) {
+        return;
+    }
+    std::vector<ReportGroup> groups = reportingSnapshot->groupBy(dimension);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Giving Report");
+    QVBoxLayout* layout = new QVBoxLayout(&dialog);
+    QTableWidget* reportTable = new QTableWidget(static_cast<int>(groups.size()), 3, &dialog);
+    reportTable->setHorizontalHeaderLabels({dimensionName, "Donations", "Total"});
+    reportTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    reportTable->verticalHeader()->setVisible(false);
+    for (int i = 0; i < static_cast<int>(groups.size()); ++i) {
+        reportTable->setItem(i, 0, new QTableWidgetItem(QString::fromStdString(groups[i].label)));
+        reportTable->setItem(i, 1, new QTableWidgetItem(QString::number(groups[i].donations)));
+        reportTable->setItem(i, 2, new QTableWidgetItem(QString::fromStdString(formatCents(groups[i].totalCents))));
+    }
+    reportTable->resizeColumnsToContents();
+    layout->addWidget(reportTable);
+    QPushButton* closeButton = new QPushButton("Close", &dialog);
+    connect(closeButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+    layout->addWidget(closeButton, 0, Qt::AlignRight);
+    dialog.resize(420, 360);
+    dialog.exec();
+}
+
 /**
  * @brief Slot to handle setting organization details.
  * Opens an OrganizationDialog, retrieves input, and updates organization details via DonationTracker.
@@ -1219,11 +1058,13 @@ void MainWindow::setOrganization() {
 
 /**
  * @brief Slot for performing a donor search.
- * Calls DonationTracker's searchDonors method and updates the main donor table.
+ * Runs when typing pauses, on Enter, or from the Search button. Resets the donor model to the
+ * new search term; matching rows are paged in on demand.
  */
 void MainWindow::search() {
-    // Pass the search term from the QLineEdit to the tracker.
-    tracker->searchDonors(searchField->text().toStdString(), table);
+    searchDebounce->stop(); // Enter or the button while a keystroke is pending: search once, now.
+    // Pass the search term from the QLineEdit to the donor model; it pages in the matches.
+    donorModel->setSearchTerm(searchField->text().toStdString());
 }
 
 /**
@@ -1240,59 +1081,74 @@ void MainWindow::updateOrganizationDisplay() {
 }
 
 /**
- * @brief Populates the `donorIds` vector with all current donor IDs from the database.
- * Called to refresh the list of available donors for navigation.
+ * @brief Loads the details of a specific donor into the main window's input fields
+ * and their donations into the donations table.
+ * Both are fetched by the database worker; the fields are filled when the result arrives.
+ * If another donor is requested in the meantime, this result is discarded.
+ * @param id The ID of the donor to load. If -1, clears the fields.
  */
-void MainWindow::populateDonorIds() {
-    donorIds = tracker->getAllDonorIds(); // Get all donor IDs.
-    // If a donor was selected and then deleted, currentDonorIndex might become invalid.
-    // This part ensures `currentDonorIndex` is reset or adjusted.
-    if (currentDonorId != -1) {
-        auto it = std::find(donorIds.begin(), donorIds.end(), currentDonorId);
-        if (it != donorIds.end()) {
-            currentDonorIndex = std::distance(donorIds.begin(), it);
-        } else {
-            currentDonorIndex = -1; // Current donor not found (e.g., deleted).
-        }
+void MainWindow::loadDonor(int id) {
+    int generation = ++donorLoadGeneration;
+    navigationDonorId = id; // Navigation steps from here, even before the details arrive.
+    if (id == -1) {
+        clearDonorDetailsFields(); // Clear all fields if no donor selected (id is -1).
+        currentDonorId = -1;
+        ++donationsLoadGeneration; // Drop donations still on their way for the previous donor.
+        donationsTable->clearContents(); // Clear donations table.
+        donationsTable->setRowCount(0);
+        updateNavigationButtonStates(); // Update button states after loading a donor.
+        return;
     }
-    updateNavigationButtonStates(); // Update navigation button enabled states.
-}
 
-/**
- * @brief Loads the details of a specific donor into the UI fields and their donations into the table.
- * If id is -1, it clears the donor details fields.
- * @param id The ID of the donor to load.
- */
-void MainWindow::loadDonor(int id) {
-    if (id != -1) {
-        std::string firstName, lastName, street, city, state, zip, country, phone, email;
-        if (tracker->getDonorDetails(id, firstName, lastName, street, city, state, zip, country, phone, email)) {
+    auto* watcher = new QFutureWatcher<DonorRecord>(this);
+    connect(watcher, &QFutureWatcher<DonorRecord>::finished, this, [this, watcher, id, generation]() {
+        watcher->deleteLater();
+        if (generation != donorLoadGeneration || watcher->isCanceled()) {
+            return; // A newer selection superseded this one.
+        }
+        DonorRecord donor = watcher->result();
+        if (donor.id == id) {
             // Populate UI fields with donor details.
             donorIdEdit->setText(QString::number(id));
-            donorFirstNameEdit->setText(QString::fromStdString(firstName));
-            donorLastNameEdit->setText(QString::fromStdString(lastName));
-            donorStreetEdit->setText(QString::fromStdString(street));
-            donorCityEdit->setText(QString::fromStdString(city));
-            donorStateEdit->setText(QString::fromStdString(state));
-            donorZipEdit->setText(QString::fromStdString(zip));
-            donorCountryEdit->setText(QString::fromStdString(country));
-            donorPhoneEdit->setText(QString::fromStdString(phone));
-            donorEmailEdit->setText(QString::fromStdString(email));
+            donorFirstNameEdit->setText(QString::fromStdString(donor.firstName));
+            donorLastNameEdit->setText(QString::fromStdString(donor.lastName));
+            donorStreetEdit->setText(QString::fromStdString(donor.street));
+            donorCityEdit->setText(QString::fromStdString(donor.city));
+            donorStateEdit->setText(QString::fromStdString(donor.state));
+            donorZipEdit->setText(QString::fromStdString(donor.zip));
+            donorCountryEdit->setText(QString::fromStdString(donor.country));
+            donorPhoneEdit->setText(QString::fromStdString(donor.phone));
+            donorEmailEdit->setText(QString::fromStdString(donor.email));
             currentDonorId = id; // Set the currently loaded donor ID.
-            tracker->getDonationsForDonor(id, donationsTable); // Load donations for this donor.
         } else {
             // If donor details can't be fetched, clear fields and reset currentDonorId.
             clearDonorDetailsFields();
             QMessageBox::warning(this, "Error", "Failed to load donor details.");
             currentDonorId = -1;
         }
-    } else {
-        clearDonorDetailsFields(); // Clear all fields if no donor selected (id is -1).
-        currentDonorId = -1;
-        donationsTable->clearContents(); // Clear donations table.
-        donationsTable->setRowCount(0);
-    }
-    updateNavigationButtonStates(); // Update button states after loading a donor.
+        updateNavigationButtonStates(); // Update button states after loading a donor.
+    });
+    watcher->setFuture(dbWorker->getDonorDetails(id));
+    // Queued behind the details request, so both usually arrive in the same event loop pass.
+    requestDonations(id);
+}
+
+/**
+ * @brief Refreshes the donations table for a donor from the database worker.
+ * Results for a donor that is no longer the latest request are discarded.
+ * @param donorId The donor whose donations to show.
+ */
+void MainWindow::requestDonations(int donorId) {
+    int generation = ++donationsLoadGeneration;
+    auto* watcher = new QFutureWatcher<std::vector<DonationRecord>>(this);
+    connect(watcher, &QFutureWatcher<std::vector<DonationRecord>>::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != donationsLoadGeneration || watcher->isCanceled()) {
+            return;
+        }
+        DonationTracker::fillDonationsTable(watcher->result(), donationsTable);
+    });
+    watcher->setFuture(dbWorker->getDonationsForDonor(donorId));
 }
 
 /**
@@ -1312,22 +1168,15 @@ void MainWindow::clearDonorDetailsFields() {
 }
 
 /**
- * @brief Slot for when a donor item in the main search table is clicked.
+ * @brief Slot for when a donor row in the main search table is clicked.
  * Loads the details of the clicked donor into the dedicated donor details section.
- * @param item The QTableWidgetItem that was clicked.
+ * @param index The model index that was clicked.
  */
-void MainWindow::onDonorTableItemClicked(QTableWidgetItem* item) {
-    if (item) {
-        int donorId = table->item(item->row(), 0)->text().toInt(); // Get ID from the first column.
+void MainWindow::onDonorTableClicked(const QModelIndex& index) {
+    if (index.isValid()) {
+        int donorId = donorModel->donorIdAt(index.row()); // Get ID of the clicked row.
         qDebug() << "Donor table item clicked. Donor ID:" << donorId;
-        // Find the index of the clicked donor in the donorIds vector.
-        auto it = std::find(donorIds.begin(), donorIds.end(), donorId);
-        if (it != donorIds.end()) {
-            currentDonorIndex = std::distance(donorIds.begin(), it);
-            loadDonor(donorId); // Load the details for the clicked donor.
-        } else {
-            qDebug() << "Clicked donor ID not found in populated donorIds vector.";
-        }
+        loadDonor(donorId); // Load the details for the clicked donor.
     }
 }
 
@@ -1346,73 +1195,62 @@ void MainWindow::onDonationTableItemClicked(QTableWidgetItem* item) {
 }
 
 /**
- * @brief Slot to load the first donor in the list.
- * Updates `currentDonorIndex` and calls `loadDonor`.
+ * @brief Slot to load the first donor (smallest ID).
  */
 void MainWindow::loadFirstDonor() {
-    populateDonorIds(); // Ensure donorIds is up-to-date.
-    if (!donorIds.empty()) {
-        currentDonorIndex = 0;
-        loadDonor(donorIds[currentDonorIndex]);
-    } else {
-        loadDonor(-1); // No donors.
-    }
+    loadDonor(tracker->firstDonorId()); // -1 (clear the fields) if there are no donors.
 }
 
 /**
- * @brief Slot to load the previous donor in the list.
- * Decrements `currentDonorIndex` and calls `loadDonor`.
+ * @brief Slot to load the donor before the current one in ID order.
  */
 void MainWindow::loadPreviousDonor() {
-    if (currentDonorIndex > 0) {
-        currentDonorIndex--;
-        loadDonor(donorIds[currentDonorIndex]);
+    if (navigationDonorId != -1) {
+        int id = tracker->prevDonorId(navigationDonorId);
+        if (id != -1) {
+            loadDonor(id);
+        }
     }
 }
 
 /**
- * @brief Slot to load the next donor in the list.
- * Increments `currentDonorIndex` and calls `loadDonor`.
+ * @brief Slot to load the donor after the current one in ID order.
  */
 void MainWindow::loadNextDonor() {
-    if (static_cast<size_t>(currentDonorIndex) < donorIds.size() - 1) {
-        currentDonorIndex++;
-        loadDonor(donorIds[currentDonorIndex]);
+    if (navigationDonorId != -1) {
+        int id = tracker->nextDonorId(navigationDonorId);
+        if (id != -1) {
+            loadDonor(id);
+        }
     }
 }
 
 /**
- * @brief Slot to load the last donor in the list.
- * Updates `currentDonorIndex` to the last element and calls `loadDonor`.
+ * @brief Slot to load the last donor (largest ID).
  */
 void MainWindow::loadLastDonor() {
-    populateDonorIds(); // Ensure donorIds is up-to-date.
-    if (!donorIds.empty()) {
-        currentDonorIndex = donorIds.size() - 1;
-        loadDonor(donorIds[currentDonorIndex]);
-    } else {
-        loadDonor(-1); // No donors.
-    }
+    loadDonor(tracker->lastDonorId()); // -1 (clear the fields) if there are no donors.
 }
 
 /**
  * @brief Updates the enabled/disabled state of the navigation buttons.
  * Buttons are enabled only if there are valid previous/next donors to navigate to.
+ * Two primary-key lookups, so this is cheap enough to run after every change.
  */
 void MainWindow::updateNavigationButtonStates() {
-    if (donorIds.empty()) {
-        // If no donors, disable all navigation buttons.
-        firstButton->setEnabled(false);
-        previousButton->setEnabled(false);
-        nextButton->setEnabled(false);
-        lastButton->setEnabled(false);
+    bool hasPrevious = false;
+    bool hasNext = false;
+    if (navigationDonorId != -1) {
+        hasPrevious = tracker->prevDonorId(navigationDonorId) != -1;
+        hasNext = tracker->nextDonorId(navigationDonorId) != -1;
     } else {
-        // Enable/disable based on current index relative to list bounds.
-        firstButton->setEnabled(currentDonorIndex > 0);
-        previousButton->setEnabled(currentDonorIndex > 0);
-        nextButton->setEnabled(static_cast<size_t>(currentDonorIndex) < donorIds.size() - 1);
-        lastButton->setEnabled(static_cast<size_t>(currentDonorIndex) < donorIds.size() - 1);
+        // Nothing selected: First/Last are still useful if any donor exists.
+        hasPrevious = hasNext = tracker->firstDonorId() != -1;
     }
+    firstButton->setEnabled(hasPrevious);
+    previousButton->setEnabled(hasPrevious && navigationDonorId != -1);
+    nextButton->setEnabled(hasNext && navigationDonorId != -1);
+    lastButton->setEnabled(hasNext);
 }
 
 // -----------------------------------------------------------------------------
@@ -1421,7 +1259,61 @@ void MainWindow::updateNavigationButtonStates() {
 // -----------------------------------------------------------------------------
 int main(int argc, char* argv[]) {
     QApplication app(argc, argv); // Create the Qt application object.
-    MainWindow window; // Create an instance of the main window.
+    QApplication::setApplicationName("donation_tracker");
+    QApplication::setApplicationVersion(APP_VERSION);
+
+    // Command-line options, e.g. "--profile bulk-load" before a large import session.
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Donation Tracker");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption profileOption("profile", "Database connection profile: interactive, bulk-load or read-only.",
+                                     "name", "interactive");
+    parser.addOption(profileOption);
+    QCommandLineOption dbOption("db", "Database file, e.g. one chapter's database.", "path", "donations.db");
+    parser.addOption(dbOption);
+    QCommandLineOption queryStatsOption("query-stats", "Append per-statement timings to this file on exit (- for stderr).", "path");
+    QCommandLineOption slowQueryOption("slow-query-ms", "Log statements slower than this many milliseconds.", "ms");
+    parser.addOption(queryStatsOption);
+    parser.addOption(slowQueryOption);
+    QCommandLineOption startupTimingOption("startup-timing", "Log how long each startup phase took.");
+    parser.addOption(startupTimingOption);
+    parser.process(app);
+
+    ConnectionProfile profile = ConnectionProfile::Interactive;
+    if (!DonationTracker::connectionProfileFromString(parser.value(profileOption).toStdString(), profile)) {
+        qWarning() << "Unknown connection profile" << parser.value(profileOption) << "- using interactive.";
+    }
+
+    // Backend errors become message boxes. Trackers on worker threads report through the
+    // same sink, so those reports are queued to the GUI thread.
+    DonationTracker::setDefaultErrorSink([](ErrorSeverity severity, const std::string& title, const std::string& message) {
+        QString qTitle = QString::fromStdString(title);
+        QString qMessage = QString::fromStdString(message);
+        auto show = [severity, qTitle, qMessage]() {
+            if (severity == ErrorSeverity::Critical) {
+                QMessageBox::critical(nullptr, qTitle, qMessage);
+            } else {
+                QMessageBox::warning(nullptr, qTitle, qMessage);
+            }
+        };
+        if (QThread::currentThread() == QCoreApplication::instance()->thread()) {
+            show();
+        } else {
+            QMetaObject::invokeMethod(QCoreApplication::instance(), show, Qt::QueuedConnection);
+        }
+    });
+
+    // Applies to the window's tracker and the database worker's; slow queries go to qWarning.
+    QueryProfilingOptions profiling;
+    profiling.statsPath = parser.value(queryStatsOption).toStdString();
+    profiling.collectStats = !profiling.statsPath.empty();
+    profiling.slowQueryMs = parser.value(slowQueryOption).toDouble();
+    DonationTracker::setDefaultQueryProfiling(profiling);
+
+    MainWindow window(nullptr, profile, parser.value(dbOption).toStdString()); // Create an instance of the main window.
+    window.setStartupTimingLogged(parser.isSet(startupTimingOption));
     window.show(); // Display the main window.
+    window.getStartupTiming().mark("show window");
     return app.exec(); // Start the Qt event loop.
 }
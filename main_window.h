@@ -0,0 +1,274 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// main_window.h
+#ifndef MAIN_WINDOW_H
+#define MAIN_WINDOW_H
+
+// Qt widget includes for the dialogs and the main window.
+#include "donation_tracker.h" // Backend used by the main window.
+#include <QDialog>
+#include <QMainWindow>
+#include <QTableWidget>
+#include <QTableView>
+#include <QLineEdit>
+#include <QLabel>
+#include <QPushButton>
+#include <QDateEdit> // Include for QDateEdit
+#include <QDoubleValidator> // Include for QDoubleValidator (needed for DonationDialog)
+#include <QElapsedTimer> // Startup timing.
+#include <memory> // The giving report's snapshot.
+#include <utility> // Startup phases.
+#include <vector>
+
+class DonorTableModel; // Paged donor grid model (donor_table_model.h).
+class LetterGenerator; // Background letter writer (letter_generator.h).
+class DatabaseWorker; // Read-query thread for the GUI (database_worker.h).
+class DatabaseBackup; // Background snapshots of the database (database_backup.h).
+class ReportingSnapshot; // In-memory giving report data (reporting_snapshot.h).
+class QTimer;
+
+/**
+ * @brief The DonorDialog class provides a dialog for adding or editing donor information.
+ */
+class DonorDialog : public QDialog {
+    Q_OBJECT // Enables Qt's meta-object system.
+
+public:
+    /**
+     * @brief Constructor for DonorDialog.
+     * @param parent The parent widget.
+     */
+    DonorDialog(QWidget* parent = nullptr);
+
+    /**
+     * @brief Validates the input fields in the dialog.
+     * @return True if all inputs are valid, false otherwise.
+     */
+    bool validateInputs();
+
+    // Public QLineEdit pointers to allow access to input fields from MainWindow for data retrieval.
+    QLineEdit* idEdit;
+    QLineEdit* firstNameEdit;
+    QLineEdit* lastNameEdit;
+    QLineEdit* streetEdit;
+    QLineEdit* cityEdit;
+    QLineEdit* stateEdit;
+    QLineEdit* zipEdit;
+    QLineEdit* countryEdit;
+    QLineEdit* phoneEdit;
+    QLineEdit* emailEdit;
+
+signals:
+    // Signal emitted when a donor is successfully saved (added or updated).
+    void donorSaved(int id);
+};
+
+/**
+ * @brief The DonationDialog class provides a dialog for adding or editing donation information.
+ */
+class DonationDialog : public QDialog {
+    Q_OBJECT // Enables Qt's meta-object system.
+
+public:
+    /**
+     * @brief Constructor for DonationDialog.
+     * @param parent The parent widget.
+     */
+    DonationDialog(QWidget* parent = nullptr);
+
+    /**
+     * @brief Validates the input fields in the dialog.
+     * @return True if all inputs are valid, false otherwise.
+     */
+    bool validateInputs();
+
+    /**
+     * @brief Returns the entered amount in cents (call after validateInputs()).
+     */
+    Cents amountCents() const;
+
+    // Public QLineEdit and QDateEdit pointers for input fields.
+    QLineEdit* idEdit;
+    QLineEdit* donorIdEdit;
+    QLineEdit* amountEdit;
+    QDateEdit* dateEdit; // Using QDateEdit for date input.
+    QLineEdit* paymentMethodEdit;
+
+signals:
+    // Signal emitted when a donation is successfully saved (added or updated).
+    void donationSaved(int id);
+};
+
+/**
+ * @brief The OrganizationDialog class provides a dialog for setting or updating organization details.
+ */
+class OrganizationDialog : public QDialog {
+    Q_OBJECT // Enables Qt's meta-object system.
+
+public:
+    /**
+     * @brief Constructor for OrganizationDialog.
+     * @param parent The parent widget.
+     */
+    OrganizationDialog(QWidget* parent = nullptr);
+
+    /**
+     * @brief Validates the input fields in the dialog.
+     * @return True if all inputs are valid, false otherwise.
+     */
+    bool validateInputs();
+
+    // Public QLineEdit pointers for organization details.
+    QLineEdit* nameEdit;
+    QLineEdit* streetEdit;
+    QLineEdit* cityEdit;
+    QLineEdit* stateEdit;
+    QLineEdit* zipEdit;
+    QLineEdit* countryEdit;
+};
+
+/**
+ * @brief The StartupTiming class records how long each startup phase takes, from the
+ * window's construction until the first page of donors is on screen.
+ */
+class StartupTiming {
+public:
+    StartupTiming() : last(0) { timer.start(); }
+    void mark(const char* phase); // Ends a phase: records the time since the previous mark.
+    QString summary() const; // e.g. "open database 3 ms, build window 25 ms, ..., total 41 ms".
+
+private:
+    QElapsedTimer timer;
+    qint64 last; // Elapsed milliseconds at the previous mark.
+    std::vector<std::pair<const char*, qint64>> phases;
+};
+
+/**
+ * @brief The MainWindow class represents the main application window.
+ * It orchestrates the UI, handles user interactions, and communicates with the DonationTracker backend.
+ */
+class MainWindow : public QMainWindow {
+    Q_OBJECT // Enables Qt's meta-object system for signals and slots.
+
+public:
+    /**
+     * @brief Constructor for MainWindow.
+     * @param parent The parent widget.
+     * @param profile Connection profile for the backend database connection.
+     * @param dbPath Database file to open.
+     */
+    explicit MainWindow(QWidget* parent = nullptr, ConnectionProfile profile = ConnectionProfile::Interactive,
+                        const std::string& dbPath = "donations.db");
+
+    StartupTiming& getStartupTiming() { return startupTiming; }
+    void setStartupTimingLogged(bool logged) { logStartupTiming = logged; } // Log the phases once startup is done.
+
+private slots:
+    // Slots for handling button clicks and other UI events.
+    void addDonor();
+    void editDonor();
+    void deleteDonor();
+    void addDonation();
+    void editDonation();
+    void deleteDonation();
+    void generateLetters();
+    void importDonations(); // Slot for importing donations from a CSV file.
+    void backupDatabase(); // Slot for snapshotting the database while it stays in use.
+    void showGivingReport(); // Slot for the grouped giving report, answered from memory.
+    void setOrganization();
+    void search(); // Slot for initiating a donor search.
+
+    // Slots for navigating through donor records.
+    void loadFirstDonor();
+    void loadPreviousDonor();
+    void loadNextDonor();
+    void loadLastDonor();
+
+    // Slots for handling item clicks in the donor and donation tables.
+    void onDonorTableClicked(const QModelIndex& index);
+    void onDonationTableItemClicked(QTableWidgetItem* item);
+
+    void loadInitialData(); // The constructor's database reads, deferred until the window is shown.
+
+private:
+    StartupTiming startupTiming; // First member, so it starts before the database is opened.
+    bool logStartupTiming;
+    QMetaObject::Connection firstPageConnection; // Ends startup when the first donor rows arrive.
+    void finishStartup(); // Logs the timing and prefetches the next donor page.
+
+    DonationTracker* tracker; // Instance of the backend database tracker.
+    LetterGenerator* letterGenerator; // Writes letters off the GUI thread.
+    DatabaseWorker* dbWorker; // Runs the GUI's read queries off the GUI thread.
+    DatabaseBackup* databaseBackup; // Takes snapshots off the GUI thread.
+    // Kept between giving reports and refreshed on a pooled reader; the refresh job holds it
+    // while it runs, so the GUI thread leaves it alone until the job hands it back.
+    std::shared_ptr<ReportingSnapshot> reportingSnapshot;
+    bool reportRefreshing; // A refresh job is running.
+    bool reportChangedDuringRefresh; // An edit arrived meanwhile; invalidate once the job is done.
+    void invalidateGivingReport();
+    void presentGivingReport(const QString& dimensionName); // Shows the snapshot's groups in a dialog.
+    QLabel* orgDetailsLabel; // Label to display organization details.
+    void updateOrganizationDisplay(); // Helper to refresh the organization details display.
+
+    // Donor Details fields displayed in the main window.
+    QLineEdit* donorIdEdit;
+    QLineEdit* donorFirstNameEdit;
+    QLineEdit* donorLastNameEdit;
+    QLineEdit* donorStreetEdit;
+    QLineEdit* donorCityEdit;
+    QLineEdit* donorStateEdit;
+    QLineEdit* donorZipEdit;
+    QLineEdit* donorCountryEdit;
+    QLineEdit* donorPhoneEdit;
+    QLineEdit* donorEmailEdit;
+
+    // Table for displaying search results (donors), backed by a lazily-fetched model.
+    QTableView* table;
+    DonorTableModel* donorModel;
+
+    // Table for displaying donations of a selected donor.
+    QTableWidget* donationsTable;
+
+    // Search fields for filtering donor records.
+    QLineEdit* searchField;
+    QLineEdit* searchValue;
+    QTimer* searchDebounce; // Restarted on every keystroke; runs search() once typing pauses.
+    static const int searchDebounceMs = 150;
+
+    // Navigation buttons for Browse donor records.
+    QPushButton* firstButton;
+    QPushButton* previousButton;
+    QPushButton* nextButton;
+    QPushButton* lastButton;
+
+    // Donor navigation logic.
+    // First/previous/next/last step from navigationDonorId with keyset lookups on the backend.
+    int navigationDonorId; // The donor most recently requested by loadDonor (-1 if none).
+    int currentDonorId; // Store the ID of the currently loaded donor.
+
+    void loadDonor(int id); // Requests donor details and their donations; the UI fills in when they arrive.
+    void requestDonations(int donorId); // Refreshes donationsTable from the worker.
+    int donorLoadGeneration; // Bumped per loadDonor() so an older, slower result is dropped.
+    int donationsLoadGeneration; // Same, for requestDonations().
+    void updateNavigationButtonStates(); // Enables/disables navigation buttons based on current position.
+    void clearDonorDetailsFields(); // Clears all donor details fields.
+};
+
+#endif // MAIN_WINDOW_H
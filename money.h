@@ -0,0 +1,112 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// money.h
+#ifndef MONEY_H
+#define MONEY_H
+
+// Exact money handling. Amounts are stored and summed as whole cents in a signed 64-bit
+// integer, so totals never drift the way summed doubles do; doubles only appear at the
+// edges (display, QDoubleValidator input) and are converted with rounding to the cent.
+
+#include <cstdint> // std::int64_t.
+#include <cmath> // std::llround.
+#include <string> // Parsing and formatting.
+
+using Cents = std::int64_t; // An amount in cents (1 = $0.01).
+
+/**
+ * @brief Converts a decimal amount to cents, rounding to the nearest cent.
+ * @param amount The amount in dollars; must be finite.
+ */
+inline Cents centsFromAmount(double amount) {
+    return static_cast<Cents>(std::llround(amount * 100.0));
+}
+
+/**
+ * @brief Converts cents to a double for display or legacy REAL columns.
+ */
+inline double amountFromCents(Cents cents) {
+    return static_cast<double>(cents) / 100.0;
+}
+
+/**
+ * @brief Parses a decimal amount such as "123", "123.4" or "-0.05" into cents without
+ * going through a double. Further decimal places are rounded half away from zero on the
+ * decimal digits ("12.000" is 1200, "19.995" is 2000), as the old toDouble path accepted
+ * them; empty input or any other character is rejected.
+ * @param text The amount text (surrounding whitespace is not allowed).
+ * @param cents Receives the amount on success.
+ * @return True if text is a valid amount.
+ */
+inline bool parseCents(const std::string& text, Cents& cents) {
+    std::size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        ++i;
+    }
+    Cents whole = 0;
+    std::size_t digits = 0;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++digits) {
+        if (whole > (INT64_MAX / 100 - 9) / 10) {
+            return false; // Would overflow once scaled to cents.
+        }
+        whole = whole * 10 + (text[i] - '0');
+    }
+    Cents fraction = 0;
+    std::size_t fractionDigits = 0;
+    bool roundUp = false; // Set by the first digit past the cents.
+    if (i < text.size() && text[i] == '.') {
+        for (++i; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++fractionDigits) {
+            if (fractionDigits < 2) {
+                fraction = fraction * 10 + (text[i] - '0');
+            } else if (fractionDigits == 2) {
+                roundUp = text[i] >= '5';
+            }
+        }
+    }
+    if (i != text.size() || digits + fractionDigits == 0) {
+        return false;
+    }
+    if (fractionDigits == 1) {
+        fraction *= 10; // "1.5" is 150 cents.
+    }
+    cents = whole * 100 + fraction + (roundUp ? 1 : 0);
+    if (negative) {
+        cents = -cents;
+    }
+    return true;
+}
+
+/**
+ * @brief Formats cents as a plain decimal with two places, e.g. 123456 -> "1234.56".
+ */
+inline std::string formatCents(Cents cents) {
+    // Work on the magnitude as unsigned so INT64_MIN is handled too.
+    std::uint64_t magnitude = cents < 0 ? 0 - static_cast<std::uint64_t>(cents) : static_cast<std::uint64_t>(cents);
+    std::string text = std::to_string(magnitude / 100);
+    unsigned fraction = static_cast<unsigned>(magnitude % 100);
+    text += '.';
+    text += static_cast<char>('0' + fraction / 10);
+    text += static_cast<char>('0' + fraction % 10);
+    return cents < 0 ? "-" + text : text;
+}
+
+#endif // MONEY_H
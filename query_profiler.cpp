@@ -0,0 +1,203 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// query_profiler.cpp
+// Implementation of QueryProfiler, the per-statement timing behind DonationTracker's
+// query statistics and slow-query log.
+
+#include "query_profiler.h"
+#include <QDebug> // Default slow-query log.
+#include <QString> // Slow-query log text.
+#include <algorithm> // std::sort, std::min.
+#include <cmath> // std::log2, std::pow, std::ceil.
+#include <cstdio> // snprintf for the statistics table.
+
+QueryProfiler::~QueryProfiler() {
+    detach();
+}
+
+/**
+ * @brief Applies options to a connection. The trace callback is installed only when
+ * statistics or the slow-query log are enabled.
+ */
+void QueryProfiler::configure(sqlite3* connection, const QueryProfilingOptions& options) {
+    detach();
+    settings = options;
+    if (connection && (settings.collectStats || settings.slowQueryMs > 0.0)) {
+        db = connection;
+        sqlite3_trace_v2(db, SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, &QueryProfiler::traceCallback, this);
+    }
+}
+
+/**
+ * @brief Removes the trace callback from the connection, keeping the statistics.
+ */
+void QueryProfiler::detach() {
+    if (db) {
+        sqlite3_trace_v2(db, 0, nullptr, nullptr);
+        db = nullptr;
+    }
+    pendingRows.clear();
+    rowStmt = nullptr;
+    rowCount = nullptr;
+}
+
+/**
+ * @brief sqlite3_trace_v2 callback: P is the statement; for profile events X points to the
+ * elapsed time in nanoseconds.
+ */
+int QueryProfiler::traceCallback(unsigned type, void* context, void* p, void* x) {
+    QueryProfiler* profiler = static_cast<QueryProfiler*>(context);
+    sqlite3_stmt* stmt = static_cast<sqlite3_stmt*>(p);
+    if (type == SQLITE_TRACE_ROW) {
+        profiler->onRow(stmt);
+    } else if (type == SQLITE_TRACE_PROFILE) {
+        profiler->onProfile(stmt, static_cast<std::uint64_t>(*static_cast<sqlite3_int64*>(x)));
+    }
+    return 0;
+}
+
+/**
+ * @brief Counts one result row for the statement's current execution.
+ */
+void QueryProfiler::onRow(sqlite3_stmt* stmt) {
+    if (stmt != rowStmt) {
+        rowStmt = stmt;
+        rowCount = &pendingRows[stmt]; // References into the map survive rehashing.
+    }
+    ++*rowCount;
+}
+
+/**
+ * @brief Records one finished execution and logs it if it was slow.
+ */
+void QueryProfiler::onProfile(sqlite3_stmt* stmt, std::uint64_t nanoseconds) {
+    std::uint64_t rows = 0;
+    auto pending = pendingRows.find(stmt);
+    if (pending != pendingRows.end()) {
+        rows = pending->second;
+        pendingRows.erase(pending);
+        if (rowStmt == stmt) {
+            rowStmt = nullptr;
+            rowCount = nullptr;
+        }
+    }
+
+    const char* sql = sqlite3_sql(stmt);
+    if (!sql) {
+        return;
+    }
+    if (settings.collectStats) {
+        Entry& entry = entries[sql];
+        ++entry.calls;
+        entry.rows += rows;
+        entry.totalNs += nanoseconds;
+        entry.maxNs = std::max(entry.maxNs, nanoseconds);
+        ++entry.buckets[bucketFor(nanoseconds)];
+    }
+    double milliseconds = nanoseconds / 1e6;
+    if (settings.slowQueryMs > 0.0 && milliseconds >= settings.slowQueryMs) {
+        if (settings.slowQuerySink) {
+            settings.slowQuerySink(sql, milliseconds, rows);
+        } else {
+            qWarning().noquote() << QString("Slow query (%1 ms, %2 rows): %3").arg(milliseconds, 0, 'f', 1).arg(rows).arg(sql);
+        }
+    }
+}
+
+/**
+ * @brief Bucket 0 holds executions under 1 us; bucket b holds [2^((b-1)/4), 2^(b/4)) us.
+ */
+int QueryProfiler::bucketFor(std::uint64_t nanoseconds) {
+    double microseconds = nanoseconds / 1e3;
+    if (microseconds < 1.0) {
+        return 0;
+    }
+    int bucket = 1 + static_cast<int>(4.0 * std::log2(microseconds));
+    return std::min(bucket, bucketCount - 1);
+}
+
+double QueryProfiler::bucketUpperMs(int bucket) {
+    return std::pow(2.0, bucket / 4.0) / 1e3;
+}
+
+/**
+ * @brief Statistics collected so far, slowest total time first.
+ */
+std::vector<QueryStats> QueryProfiler::stats() const {
+    std::vector<QueryStats> result;
+    result.reserve(entries.size());
+    for (const auto& item : entries) {
+        const Entry& entry = item.second;
+        QueryStats stats;
+        stats.sql = item.first;
+        stats.calls = entry.calls;
+        stats.rows = entry.rows;
+        stats.totalMs = entry.totalNs / 1e6;
+        stats.maxMs = entry.maxNs / 1e6;
+
+        // Percentiles: the upper edge of the bucket holding the p-th execution, capped at the maximum.
+        const double percentiles[] = {0.50, 0.95, 0.99};
+        double* targets[] = {&stats.p50Ms, &stats.p95Ms, &stats.p99Ms};
+        int next = 0;
+        std::uint64_t seen = 0;
+        for (int bucket = 0; bucket < bucketCount && next < 3; ++bucket) {
+            seen += entry.buckets[bucket];
+            while (next < 3 && seen >= static_cast<std::uint64_t>(std::ceil(percentiles[next] * entry.calls))) {
+                *targets[next++] = std::min(bucketUpperMs(bucket), stats.maxMs);
+            }
+        }
+        result.push_back(std::move(stats));
+    }
+    std::sort(result.begin(), result.end(), [](const QueryStats& a, const QueryStats& b) { return a.totalMs > b.totalMs; });
+    return result;
+}
+
+void QueryProfiler::reset() {
+    entries.clear();
+}
+
+/**
+ * @brief Tab-separated table: calls, rows, total/mean/p50/p95/p99/max milliseconds, SQL.
+ * Whitespace runs in the SQL are collapsed so each statement stays on one line.
+ */
+std::string QueryProfiler::format(const std::vector<QueryStats>& stats) {
+    std::string out = "calls\trows\ttotal_ms\tmean_ms\tp50_ms\tp95_ms\tp99_ms\tmax_ms\tsql\n";
+    char numbers[256];
+    for (const QueryStats& s : stats) {
+        std::snprintf(numbers, sizeof(numbers), "%llu\t%llu\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t",
+                      static_cast<unsigned long long>(s.calls), static_cast<unsigned long long>(s.rows),
+                      s.totalMs, s.meanMs(), s.p50Ms, s.p95Ms, s.p99Ms, s.maxMs);
+        out += numbers;
+        bool space = false;
+        for (char c : s.sql) {
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                space = true;
+                continue;
+            }
+            if (space && out.back() != '\t') {
+                out += ' ';
+            }
+            space = false;
+            out += c;
+        }
+        out += '\n';
+    }
+    return out;
+}
@@ -0,0 +1,127 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// query_profiler.h
+#ifndef QUERY_PROFILER_H
+#define QUERY_PROFILER_H
+
+#include <sqlite3.h> // sqlite3_trace_v2.
+#include <cstddef> // std::size_t.
+#include <cstdint> // Counters and nanosecond totals.
+#include <functional> // Slow-query sink.
+#include <string> // SQL text.
+#include <unordered_map> // Statistics keyed by SQL text.
+#include <vector> // Snapshots.
+
+/**
+ * @brief Receives statements that ran longer than the slow-query threshold.
+ * sql is the statement text with its ? placeholders, never the bound values, so the log
+ * carries no donor data.
+ */
+using SlowQuerySink = std::function<void(const std::string& sql, double milliseconds, std::uint64_t rows)>;
+
+/**
+ * @brief What a DonationTracker records about its statements (see DonationTracker::setQueryProfiling).
+ */
+struct QueryProfilingOptions {
+    bool collectStats = false; // Keep per-statement counts and latencies.
+    double slowQueryMs = 0.0; // Report statements slower than this; 0 disables the slow-query log.
+    SlowQuerySink slowQuerySink; // Where slow queries go; empty logs through qWarning().
+    std::string statsPath; // Append the statistics here when the tracker closes ("-" for stderr, empty for never).
+};
+
+/**
+ * @brief Accumulated statistics for one SQL statement text.
+ * Latency percentiles come from a logarithmic histogram with four buckets per doubling, so
+ * they are accurate to within about 19% of the true value.
+ */
+struct QueryStats {
+    std::string sql;
+    std::uint64_t calls = 0; // Completed executions (each step-to-reset counts once).
+    std::uint64_t rows = 0; // Result rows returned over all executions.
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+
+    double meanMs() const { return calls ? totalMs / calls : 0.0; }
+};
+
+/**
+ * @brief The QueryProfiler class times every statement run on a connection.
+ * It installs a sqlite3_trace_v2 callback for profile events (one per completed execution,
+ * with SQLite's own elapsed time) and row events, and aggregates them per SQL text. The
+ * callbacks run on the connection's thread, so, like the connection, a profiler must only be
+ * used from one thread at a time. When neither statistics nor the slow-query log are enabled
+ * no callback is installed and statements run at full speed.
+ */
+class QueryProfiler {
+public:
+    QueryProfiler() = default;
+    ~QueryProfiler();
+    QueryProfiler(const QueryProfiler&) = delete;
+    QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+    /**
+     * @brief Applies options to a connection, installing or removing the trace callback.
+     * @param db The connection to profile; must outlive the profiler or be detached first.
+     */
+    void configure(sqlite3* db, const QueryProfilingOptions& options);
+    void detach(); // Removes the trace callback; collected statistics are kept.
+
+    const QueryProfilingOptions& options() const { return settings; }
+
+    /**
+     * @brief Statistics collected so far, slowest total time first.
+     */
+    std::vector<QueryStats> stats() const;
+    void reset(); // Drops all collected statistics.
+
+    /**
+     * @brief Formats statistics as a tab-separated table with a header line.
+     */
+    static std::string format(const std::vector<QueryStats>& stats);
+
+private:
+    static const int bucketCount = 128; // 2^(127/4) us covers over an hour.
+
+    struct Entry {
+        std::uint64_t calls = 0;
+        std::uint64_t rows = 0;
+        std::uint64_t totalNs = 0;
+        std::uint64_t maxNs = 0;
+        std::uint32_t buckets[bucketCount] = {}; // Executions per latency bucket.
+    };
+
+    static int traceCallback(unsigned type, void* context, void* p, void* x);
+    void onRow(sqlite3_stmt* stmt);
+    void onProfile(sqlite3_stmt* stmt, std::uint64_t nanoseconds);
+    static int bucketFor(std::uint64_t nanoseconds);
+    static double bucketUpperMs(int bucket);
+
+    sqlite3* db = nullptr; // Connection the callback is installed on (nullptr when detached).
+    QueryProfilingOptions settings;
+    std::unordered_map<std::string, Entry> entries; // Keyed by sqlite3_sql() text.
+    std::unordered_map<sqlite3_stmt*, std::uint64_t> pendingRows; // Rows of executions still running.
+    sqlite3_stmt* rowStmt = nullptr; // Statement of the last row event, and its counter,
+    std::uint64_t* rowCount = nullptr; // so consecutive rows skip the hash lookup.
+};
+
+#endif // QUERY_PROFILER_H
@@ -0,0 +1,147 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// receipt_planner.cpp
+// Implementation of ReceiptPlanner: one indexed pass that selects, orders and batches letters.
+
+#include "receipt_planner.h"
+#include "sqlite_row.h" // Boundary key of the next row.
+
+/**
+ * @brief The WHERE clause shared by the count and the selection. Lapsed donors are those
+ * without a donor_year_totals row after the year, one probe of its (donor_id, year) key.
+ */
+static std::string selectionCondition(const ReceiptSelection& selection) {
+    std::string condition = "WHERE t.year = ?1 AND t.total_cents >= ?2 "; // Range scan on idx_donor_year_totals_year_cents.
+    if (selection.lapsedOnly) {
+        condition += "AND NOT EXISTS (SELECT 1 FROM donor_year_totals l WHERE l.donor_id = t.donor_id AND l.year > ?1) ";
+    }
+    return condition;
+}
+
+std::string ReceiptPlanner::selectSql(const ReceiptSelection& selection) {
+    std::string sql = "SELECT d.first_name, d.last_name, d.street, d.city, d.state, d.zip, d.country, t.total_cents, "
+                      "COALESCE(d.country, '') || '|' || substr(trim(d.zip), 1, 5) "
+                      "FROM donor_year_totals t JOIN donors d ON d.id = t.donor_id ";
+    sql += selectionCondition(selection);
+    switch (selection.order) {
+    case ReceiptOrder::Presort:
+        // trim(zip) sorts each ZIP+4 right after its ZIP5; the donor ID makes the order total.
+        sql += "ORDER BY d.country, trim(d.zip), d.last_name, d.first_name, t.donor_id;";
+        break;
+    case ReceiptOrder::Name:
+        sql += "ORDER BY d.last_name, d.first_name, t.donor_id;";
+        break;
+    case ReceiptOrder::Amount:
+        // The index holds (year, total_cents, donor_id), so both keys descending read it backwards.
+        sql += "ORDER BY t.total_cents DESC, t.donor_id DESC;";
+        break;
+    }
+    return sql;
+}
+
+int ReceiptPlanner::countLetters(sqlite3* db, int year, const ReceiptSelection& selection, std::string* error) {
+    int count = -1;
+    sqlite3_stmt* stmt = nullptr;
+    std::string sql = "SELECT COUNT(*) FROM donor_year_totals t " + selectionCondition(selection) + ";";
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, year);
+        sqlite3_bind_int64(stmt, 2, selection.minimumCents);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            count = sqlite3_column_int(stmt, 0);
+        }
+    }
+    if (count < 0 && error) {
+        *error = std::string("Failed to count letters: ") + sqlite3_errmsg(db);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+/**
+ * @brief Cuts batches of batchSize letters; a presorted batch is extended until the ZIP code
+ * changes, so each ZIP code's letters stay together for its tray.
+ */
+bool ReceiptPlanner::plan(sqlite3* db, int year, const ReceiptSelection& selection,
+                          const std::function<bool(ReceiptBatch&)>& batchReady, std::string* error) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, selectSql(selection).c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        if (error) {
+            *error = std::string("Failed to prepare statement for letter generation: ") + sqlite3_errmsg(db);
+        }
+        sqlite3_finalize(stmt);
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, year);
+    sqlite3_bind_int64(stmt, 2, selection.minimumCents);
+
+    int batchSize = selection.batchSize > 0 ? selection.batchSize : 1;
+    bool keepZipsTogether = selection.order == ReceiptOrder::Presort;
+    ReceiptBatch batch;
+    SqliteRow columns(stmt);
+    bool stopped = false;
+    int rc = SQLITE_DONE;
+    while (!stopped && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (batch.size() >= batchSize) {
+            // Boundary key of the batch's last row against the next one's.
+            if (!keepZipsTogether || !batch.rows.text(batch.size() - 1, 8).equals(columns.text(8))) {
+                stopped = !batchReady(batch);
+                batch.sequence += 1;
+                batch.rows.clear(); // Keeps the arena, unless batchReady moved the rows away.
+                if (stopped) {
+                    break;
+                }
+            }
+        }
+        batch.rows.appendRow(stmt);
+    }
+    bool ok = stopped || rc == SQLITE_DONE;
+    if (!ok && error) {
+        *error = std::string("Failed to read letter data: ") + sqlite3_errmsg(db);
+    }
+    sqlite3_finalize(stmt);
+    if (ok && !stopped && !batch.rows.empty()) {
+        batchReady(batch);
+    }
+    return ok;
+}
+
+void ReceiptBatch::letter(int i, LetterRow& row) const {
+    rows.copyText(i, 0, row.firstName);
+    rows.copyText(i, 1, row.lastName);
+    rows.copyText(i, 2, row.street);
+    rows.copyText(i, 3, row.city);
+    rows.copyText(i, 4, row.state);
+    rows.copyText(i, 5, row.zip);
+    rows.copyText(i, 6, row.country);
+    row.totalCents = rows.integer(i, 7);
+}
+
+bool ReceiptPlanner::orderFromString(const std::string& name, ReceiptOrder& order) {
+    if (name == "presort") {
+        order = ReceiptOrder::Presort;
+    } else if (name == "name") {
+        order = ReceiptOrder::Name;
+    } else if (name == "amount") {
+        order = ReceiptOrder::Amount;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// receipt_planner.h
+#ifndef RECEIPT_PLANNER_H
+#define RECEIPT_PLANNER_H
+
+#include "letter_template.h" // LetterRow.
+#include "money.h" // Cents.
+#include "row_batch.h" // Batch rows.
+#include <sqlite3.h> // The planner reads through the caller's connection.
+#include <functional> // Batch callback.
+#include <string> // Errors and order names.
+
+// Order of the letters in a receipt run.
+enum class ReceiptOrder {
+    Presort, // Country, then ZIP code (ZIP+4 after its ZIP5), then name: the mail house's presort order.
+    Name, // Last name, then first name.
+    Amount // Largest total first; read in index order, with no sort step.
+};
+
+/**
+ * @brief Which donors of a year get a letter, and how the run is ordered and batched.
+ */
+struct ReceiptSelection {
+    Cents minimumCents = 0; // Only donors whose total for the year is at least this.
+    ReceiptOrder order = ReceiptOrder::Presort;
+    int batchSize = 64; // Letters per batch; a presorted batch runs on to the end of its ZIP code.
+    bool lapsedOnly = false; // Only donors with no gift in any later year (the lapsed-donor letter).
+};
+
+/**
+ * @brief Consecutive letters of a run, rendered together on one worker. The rows are the
+ * selection statement's columns (see ReceiptPlanner::selectSql), held in one arena.
+ */
+struct ReceiptBatch {
+    int sequence = 0; // Position of the batch in the run, from 0.
+    RowBatch rows;
+
+    int size() const { return rows.size(); }
+
+    /**
+     * @brief Copies letter i into row. Reuse row across letters: its fields keep their capacity.
+     */
+    void letter(int i, LetterRow& row) const;
+};
+
+/**
+ * @brief The ReceiptPlanner class selects, orders and batches the letters of a receipt run
+ * in one statement. The threshold is a range on donor_year_totals(year, total_cents), so
+ * donors below it are never read; the order is the statement's ORDER BY, so the rows
+ * arrive sorted and are cut into batches as they stream. Batches carry their sequence
+ * number: workers may render them in any order, and an ordered sink writes them back in
+ * sequence (see LetterGenerator).
+ */
+class ReceiptPlanner {
+public:
+    /**
+     * @brief The selection statement: ?1 is the year, ?2 the minimum total in cents.
+     * Columns are first_name, last_name, street, city, state, zip, country, total_cents and
+     * the batch boundary key (country and ZIP5).
+     */
+    static std::string selectSql(const ReceiptSelection& selection);
+
+    /**
+     * @brief Number of letters the selection writes, for progress ranges; -1 on error.
+     */
+    static int countLetters(sqlite3* db, int year, const ReceiptSelection& selection, std::string* error = nullptr);
+
+    /**
+     * @brief Streams the selected letters as batches, in the selection's order.
+     * @param batchReady Called once per batch; return false to stop the run early. The
+     * batch is refilled after the call, reusing its storage, unless batchReady moved it away.
+     * @return False if the statement failed (not when batchReady stopped it).
+     */
+    static bool plan(sqlite3* db, int year, const ReceiptSelection& selection,
+                     const std::function<bool(ReceiptBatch&)>& batchReady, std::string* error = nullptr);
+
+    static bool orderFromString(const std::string& name, ReceiptOrder& order); // "presort", "name" or "amount".
+};
+
+#endif // RECEIPT_PLANNER_H
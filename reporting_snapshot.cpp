@@ -0,0 +1,206 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// reporting_snapshot.cpp
+// Implementation of ReportingSnapshot and its dictionaries.
+
+#include "reporting_snapshot.h"
+#include "donation_tracker.h" // DonationTracker::visitReportRows and ReportRow.
+
+std::uint16_t ReportDictionary::encode(const std::string& value) {
+    auto it = codes.find(value);
+    if (it != codes.end()) {
+        return it->second;
+    }
+    if (values.size() >= overflowCode) {
+        return overflowCode;
+    }
+    std::uint16_t code = static_cast<std::uint16_t>(values.size());
+    values.push_back(value);
+    codes.emplace(value, code);
+    return code;
+}
+
+int ReportDictionary::find(const std::string& value) const {
+    auto it = codes.find(value);
+    return it != codes.end() ? it->second : -1;
+}
+
+std::string ReportDictionary::label(std::uint16_t code) const {
+    return code < values.size() ? values[code] : std::string("(other)");
+}
+
+void ReportDictionary::clear() {
+    values.clear();
+    codes.clear();
+}
+
+/**
+ * @brief Adds one donation to every column.
+ */
+void ReportingSnapshot::append(const ReportRow& row) {
+    columns.donorIds.push_back(row.donorId);
+    columns.amountCents.push_back(row.amountCents);
+    columns.years.push_back(static_cast<std::int16_t>(row.year));
+    columns.months.push_back(static_cast<std::int8_t>(row.month));
+    paymentMethods.push_back(paymentMethodDictionary.encode(row.paymentMethod));
+    states.push_back(stateDictionary.encode(row.state));
+    countries.push_back(countryDictionary.encode(row.country));
+    if (row.year > 0) {
+        minYear = (minYear == 0 || row.year < minYear) ? row.year : minYear;
+        maxYear = row.year > maxYear ? row.year : maxYear;
+    }
+    lastId = row.donationId;
+}
+
+/**
+ * @brief Appends new donations, or rebuilds everything after invalidate().
+ */
+std::size_t ReportingSnapshot::refresh(DonationTracker& tracker) {
+    if (stale) {
+        columns.clear();
+        std::vector<std::uint16_t>().swap(paymentMethods);
+        std::vector<std::uint16_t>().swap(states);
+        std::vector<std::uint16_t>().swap(countries);
+        paymentMethodDictionary.clear();
+        stateDictionary.clear();
+        countryDictionary.clear();
+        lastId = 0;
+        minYear = maxYear = 0;
+        stale = false;
+    }
+    return tracker.visitReportRows(lastId, [this](const ReportRow& row) {
+        append(row);
+        return true;
+    });
+}
+
+/**
+ * @brief Grouped count and sum over the rows that pass the filter.
+ * One pass: each row is tested with a chain of comparisons combined without branches, and
+ * then added to its group's slot in dense arrays, or to a spare slot past the last group
+ * when it fails the filter. Text filters are resolved to codes once, up front.
+ */
+std::vector<ReportGroup> ReportingSnapshot::groupBy(ReportDimension dimension, const ReportFilter& filter) const {
+    std::vector<ReportGroup> groups;
+
+    // Resolve text filters to codes; a value that never occurs matches nothing.
+    int paymentCode = filter.paymentMethod.empty() ? -1 : paymentMethodDictionary.find(filter.paymentMethod);
+    int stateCode = filter.state.empty() ? -1 : stateDictionary.find(filter.state);
+    int countryCode = filter.country.empty() ? -1 : countryDictionary.find(filter.country);
+    if ((!filter.paymentMethod.empty() && paymentCode < 0) || (!filter.state.empty() && stateCode < 0) ||
+        (!filter.country.empty() && countryCode < 0)) {
+        return groups;
+    }
+
+    const ReportDictionary* dictionary = nullptr;
+    const std::uint16_t* codes = nullptr;
+    std::size_t keyCount = 0;
+    switch (dimension) {
+    case ReportDimension::Year:
+        keyCount = maxYear > 0 ? static_cast<std::size_t>(maxYear - minYear + 1) : 0;
+        break;
+    case ReportDimension::Month:
+        keyCount = 12;
+        break;
+    case ReportDimension::PaymentMethod:
+        dictionary = &paymentMethodDictionary;
+        codes = paymentMethods.data();
+        break;
+    case ReportDimension::State:
+        dictionary = &stateDictionary;
+        codes = states.data();
+        break;
+    case ReportDimension::Country:
+        dictionary = &countryDictionary;
+        codes = countries.data();
+        break;
+    }
+    if (dictionary) {
+        keyCount = dictionary->size() + 1; // The extra key collects overflowCode.
+    }
+
+    std::vector<std::int64_t> counts(keyCount + 1, 0); // Slot keyCount: rows that fail the filter.
+    std::vector<Cents> totals(keyCount + 1, 0);
+    const Cents* amounts = columns.amountCents.data();
+    const std::int16_t* years = columns.years.data();
+    const std::int8_t* months = columns.months.data();
+    const std::uint16_t* payment = paymentMethods.data();
+    const std::uint16_t* state = states.data();
+    const std::uint16_t* country = countries.data();
+    const int yearFrom = filter.yearFrom;
+    const int yearTo = filter.yearTo > 0 ? filter.yearTo : INT16_MAX;
+    const std::size_t n = size();
+
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t key;
+        if (codes) {
+            key = codes[i] < keyCount - 1 ? codes[i] : keyCount - 1;
+        } else if (dimension == ReportDimension::Year) {
+            key = static_cast<std::size_t>(years[i] - minYear); // Wraps for year 0, which fails below.
+        } else {
+            key = static_cast<std::size_t>(months[i] - 1);
+        }
+        bool pass = (years[i] >= yearFrom) & (years[i] <= yearTo) &
+                    (months[i] >= filter.monthFrom) & (months[i] <= filter.monthTo) &
+                    (amounts[i] >= filter.minCents) & (amounts[i] <= filter.maxCents) &
+                    ((paymentCode < 0) | (payment[i] == paymentCode)) &
+                    ((stateCode < 0) | (state[i] == stateCode)) &
+                    ((countryCode < 0) | (country[i] == countryCode)) &
+                    (key < keyCount);
+        key = pass ? key : keyCount;
+        ++counts[key];
+        totals[key] += amounts[i];
+    }
+
+    for (std::size_t key = 0; key < keyCount; ++key) {
+        if (counts[key] == 0) {
+            continue;
+        }
+        ReportGroup group;
+        if (dictionary) {
+            group.label = dictionary->label(static_cast<std::uint16_t>(key)); // The last key reads "(other)".
+        } else if (dimension == ReportDimension::Year) {
+            group.label = std::to_string(minYear + static_cast<int>(key));
+        } else {
+            group.label = std::to_string(key + 1);
+        }
+        group.donations = counts[key];
+        group.totalCents = totals[key];
+        groups.push_back(std::move(group));
+    }
+    return groups;
+}
+
+bool ReportingSnapshot::dimensionFromString(const std::string& name, ReportDimension& dimension) {
+    if (name == "year") {
+        dimension = ReportDimension::Year;
+    } else if (name == "month") {
+        dimension = ReportDimension::Month;
+    } else if (name == "payment-method") {
+        dimension = ReportDimension::PaymentMethod;
+    } else if (name == "state") {
+        dimension = ReportDimension::State;
+    } else if (name == "country") {
+        dimension = ReportDimension::Country;
+    } else {
+        return false;
+    }
+    return true;
+}
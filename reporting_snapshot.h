@@ -0,0 +1,145 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// reporting_snapshot.h
+#ifndef REPORTING_SNAPSHOT_H
+#define REPORTING_SNAPSHOT_H
+
+#include "donation_columns.h" // Numeric columns and their kernels.
+#include "money.h" // Cents.
+#include <cstddef> // std::size_t.
+#include <cstdint> // Dictionary codes.
+#include <string> // Labels and filter values.
+#include <unordered_map> // Value-to-code lookup.
+#include <vector> // Code columns and results.
+
+class DonationTracker;
+struct ReportRow;
+
+/**
+ * @brief Maps the distinct values of a text column to small integer codes.
+ * Codes are assigned in first-seen order and never change while the snapshot lives.
+ */
+class ReportDictionary {
+public:
+    static const std::uint16_t overflowCode = 0xFFFF; // Shared by every value past the first 65535.
+
+    std::uint16_t encode(const std::string& value); // Returns the value's code, adding it if new.
+    int find(const std::string& value) const; // The value's code, or -1 if it never occurred.
+    std::string label(std::uint16_t code) const; // The value for a code ("(other)" for overflowCode).
+    std::size_t size() const { return values.size(); }
+    void clear();
+
+private:
+    std::vector<std::string> values; // Indexed by code.
+    std::unordered_map<std::string, std::uint16_t> codes;
+};
+
+/**
+ * @brief What a report groups by.
+ */
+enum class ReportDimension {
+    Year,
+    Month,
+    PaymentMethod,
+    State, // Donor's state.
+    Country // Donor's country.
+};
+
+/**
+ * @brief Restricts a report to matching donations. Default-constructed, it matches everything.
+ */
+struct ReportFilter {
+    int yearFrom = 0; // Inclusive; 0 for no lower bound.
+    int yearTo = 0; // Inclusive; 0 for no upper bound.
+    int monthFrom = 1; // Inclusive calendar month range.
+    int monthTo = 12;
+    Cents minCents = INT64_MIN; // Inclusive amount range.
+    Cents maxCents = INT64_MAX;
+    std::string paymentMethod; // Exact match; empty for any.
+    std::string state;
+    std::string country;
+};
+
+/**
+ * @brief One row of a grouped report.
+ */
+struct ReportGroup {
+    std::string label; // The group's value (year and month as numbers).
+    std::int64_t donations = 0;
+    Cents totalCents = 0;
+};
+
+/**
+ * @brief A struct-of-arrays copy of donations joined with donor attributes, for giving-trend
+ * reports answered in memory.
+ * payment_method, state and country are dictionary-encoded into 16-bit code columns next to
+ * the numeric columns of DonationColumns, so a grouped report is one pass over a few dense
+ * arrays with no string work until the labels of the (few) result groups are produced.
+ *
+ * refresh() appends only donations with an ID above the last one loaded. Donations never
+ * change ID, but they can be edited or deleted, and donors can move: a long-lived snapshot's
+ * owner calls invalidate() on DonationTracker's donationUpdated, donationDeleted,
+ * donorUpdated, donorDeleted and donationsImported signals, so the next refresh() rebuilds
+ * it. MainWindow does this for its giving report; the CLI builds one per report. Not
+ * thread-safe; build and query it from one thread (or guard it externally).
+ */
+class ReportingSnapshot {
+public:
+    ReportingSnapshot() = default;
+
+    /**
+     * @brief Brings the snapshot up to date with the database.
+     * @return The number of donations added (all of them after invalidate()).
+     */
+    std::size_t refresh(DonationTracker& tracker);
+
+    void invalidate() { stale = true; } // The next refresh() rebuilds from scratch.
+    std::size_t size() const { return columns.size(); }
+    int lastDonationId() const { return lastId; }
+
+    // The numeric columns, for the DonationColumns kernels (sums, histograms).
+    const DonationColumns& donationColumns() const { return columns; }
+
+    /**
+     * @brief Counts and sums the matching donations per value of a dimension.
+     * @return One group per value with at least one matching donation, in ascending code
+     *         order: years and months ascending, text values in first-seen order.
+     */
+    std::vector<ReportGroup> groupBy(ReportDimension dimension, const ReportFilter& filter = ReportFilter()) const;
+
+    static bool dimensionFromString(const std::string& name, ReportDimension& dimension); // "year", "month", "payment-method", "state", "country".
+
+private:
+    void append(const ReportRow& row);
+
+    DonationColumns columns;
+    std::vector<std::uint16_t> paymentMethods; // Codes into paymentMethodDictionary.
+    std::vector<std::uint16_t> states;
+    std::vector<std::uint16_t> countries;
+    ReportDictionary paymentMethodDictionary;
+    ReportDictionary stateDictionary;
+    ReportDictionary countryDictionary;
+    int lastId = 0; // Highest donation ID loaded.
+    int minYear = 0; // Year range seen, for dense year grouping (0/0 while empty).
+    int maxYear = 0;
+    bool stale = false;
+};
+
+#endif // REPORTING_SNAPSHOT_H
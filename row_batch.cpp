@@ -0,0 +1,65 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// row_batch.cpp
+// Copies statement rows into a RowBatch's arena.
+
+#include "row_batch.h"
+
+void RowBatch::clear() {
+    arena.clear();
+    cells.clear();
+    columns = 0;
+    rowCount = 0;
+}
+
+void RowBatch::appendRow(sqlite3_stmt* stmt) {
+    if (rowCount == 0) {
+        columns = sqlite3_column_count(stmt);
+    }
+    for (int i = 0; i < columns; ++i) {
+        Cell value;
+        value.type = sqlite3_column_type(stmt, i);
+        if (value.type == SQLITE_INTEGER) {
+            value.integer = sqlite3_column_int64(stmt, i);
+        } else if (value.type != SQLITE_NULL) {
+            // Text, blobs and reals as their text form; sqlite3_column_text first, as in SqliteRow.
+            const unsigned char* text = sqlite3_column_text(stmt, i);
+            value.offset = arena.size();
+            if (text) { // Null for a zero-length blob.
+                value.size = static_cast<std::size_t>(sqlite3_column_bytes(stmt, i));
+                arena.append(reinterpret_cast<const char*>(text), value.size);
+            }
+        }
+        cells.push_back(value);
+    }
+    ++rowCount;
+}
+
+int RowBatch::fill(sqlite3_stmt* stmt, int maxRows) {
+    clear();
+    while (rowCount < maxRows) {
+        int rc = sqlite3_step(stmt);
+        if (rc != SQLITE_ROW) {
+            return rc;
+        }
+        appendRow(stmt);
+    }
+    return SQLITE_ROW;
+}
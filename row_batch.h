@@ -0,0 +1,95 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// row_batch.h
+#ifndef ROW_BATCH_H
+#define ROW_BATCH_H
+
+#include "sqlite_row.h" // TextView.
+#include <sqlite3.h> // Statement column access.
+#include <cstddef> // std::size_t.
+#include <string> // The text arena.
+#include <vector> // Cells.
+
+/**
+ * @brief A block of result rows copied out of a statement into reusable storage.
+ * The text of every cell lives back to back in one arena string, located through the cell
+ * vector's offsets; integers are kept as values. clear() keeps both allocations, so a batch
+ * reused across fills stops allocating once it has grown to its largest block, instead of
+ * one heap string per column per row. Integer cells hold no text, and text views stay valid
+ * until the batch is next cleared or filled.
+ */
+class RowBatch {
+public:
+    void clear(); // Drops the rows, keeps the capacity.
+
+    /**
+     * @brief Copies the statement's current row to the end of the batch. The first row fixes
+     * the column count.
+     */
+    void appendRow(sqlite3_stmt* stmt);
+
+    /**
+     * @brief Clears the batch and steps the statement for up to maxRows rows.
+     * @return SQLITE_ROW if the batch filled up (more rows may follow; call again for them),
+     * SQLITE_DONE at the end of the result, otherwise the error code of the step.
+     */
+    int fill(sqlite3_stmt* stmt, int maxRows);
+
+    int size() const { return rowCount; }
+    bool empty() const { return rowCount == 0; }
+    int columnCount() const { return columns; }
+    std::size_t textBytes() const { return arena.size(); }
+
+    TextView text(int row, int column) const {
+        const Cell& value = cell(row, column);
+        TextView view;
+        if (value.type != SQLITE_NULL && value.type != SQLITE_INTEGER) {
+            view.data = arena.data() + value.offset;
+            view.size = value.size;
+            view.isNull = false;
+        }
+        return view;
+    }
+
+    void copyText(int row, int column, std::string& out) const {
+        TextView view = text(row, column);
+        out.assign(view.data, view.size);
+    }
+
+    sqlite3_int64 integer(int row, int column) const { return cell(row, column).integer; } // 0 for non-integer cells.
+    bool isNull(int row, int column) const { return cell(row, column).type == SQLITE_NULL; }
+
+private:
+    struct Cell {
+        std::size_t offset = 0; // Text: position in arena.
+        std::size_t size = 0;
+        sqlite3_int64 integer = 0;
+        int type = SQLITE_NULL;
+    };
+
+    const Cell& cell(int row, int column) const { return cells[static_cast<std::size_t>(row) * columns + column]; }
+
+    std::string arena; // All text of the batch.
+    std::vector<Cell> cells; // Row-major, columns per row.
+    int columns = 0;
+    int rowCount = 0;
+};
+
+#endif // ROW_BATCH_H
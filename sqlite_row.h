@@ -0,0 +1,85 @@
+/*
+ * Donation Tracker - A Qt-based application for managing donations
+ * Copyright (C) 2025 Russ Wright russ.wright@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// sqlite_row.h
+#ifndef SQLITE_ROW_H
+#define SQLITE_ROW_H
+
+#include <QString> // Direct UTF-8 decoding for the GUI.
+#include <sqlite3.h> // Statement column access.
+#include <cstddef> // std::size_t.
+#include <cstring> // std::strlen.
+#include <string> // Copies into records.
+
+/**
+ * @brief A borrowed UTF-8 column value: a pointer and a length, no allocation.
+ * Valid until the statement is stepped, reset or finalized. SQL NULL reads as an empty
+ * string with isNull set.
+ */
+struct TextView {
+    const char* data = ""; // Never null, so it can be handed to append/assign/fromUtf8 as is.
+    std::size_t size = 0;
+    bool isNull = true;
+
+    bool empty() const { return size == 0; }
+    bool equals(const char* text) const {
+        std::size_t length = std::strlen(text);
+        return length == size && std::memcmp(data, text, size) == 0;
+    }
+    bool equals(const TextView& other) const { return other.size == size && std::memcmp(data, other.data, size) == 0; }
+    std::string toStdString() const { return std::string(data, size); }
+    QString toQString() const { return QString::fromUtf8(data, static_cast<int>(size)); }
+};
+
+/**
+ * @brief Column accessors for the current row of a statement.
+ * Text columns are read with their byte length, so values containing NUL bytes survive and
+ * nothing is scanned twice; NULL never reaches a std::string constructor. Use copyText to
+ * fill a record that is reused across rows: std::string::assign keeps the capacity it has.
+ */
+class SqliteRow {
+public:
+    explicit SqliteRow(sqlite3_stmt* stmt) : stmt(stmt) {}
+
+    TextView text(int column) const {
+        TextView view;
+        // sqlite3_column_text first: it may convert the value, which changes the byte count.
+        const unsigned char* value = sqlite3_column_text(stmt, column);
+        if (value) {
+            view.data = reinterpret_cast<const char*>(value);
+            view.size = static_cast<std::size_t>(sqlite3_column_bytes(stmt, column));
+            view.isNull = false;
+        }
+        return view;
+    }
+
+    void copyText(int column, std::string& out) const {
+        TextView view = text(column);
+        out.assign(view.data, view.size);
+    }
+
+    std::string toStdString(int column) const { return text(column).toStdString(); }
+    QString toQString(int column) const { return text(column).toQString(); } // One decode, no std::string.
+    bool isNull(int column) const { return sqlite3_column_type(stmt, column) == SQLITE_NULL; }
+
+private:
+    sqlite3_stmt* stmt;
+};
+
+#endif // SQLITE_ROW_H